@@ -0,0 +1,218 @@
+// benchmarks/BenchmarkReport.cc
+#include "BenchmarkReport.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace Benchmark {
+
+namespace {
+    std::string Escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    std::string HostName() {
+#if defined(__unix__) || defined(__APPLE__)
+        char name[256] = {0};
+        if (gethostname(name, sizeof(name) - 1) == 0) return name;
+#endif
+        return "unknown";
+    }
+
+    // Position just after "key": in json, or npos
+    std::size_t FindKey(const std::string& json, const char* key) {
+        const std::string quoted = std::string("\"") + key + "\"";
+        std::size_t pos = json.find(quoted);
+        if (pos == std::string::npos) return pos;
+        pos = json.find(':', pos + quoted.size());
+        return pos == std::string::npos ? pos : pos + 1;
+    }
+
+    bool ReadString(const std::string& json, const char* key, std::string& value) {
+        std::size_t pos = FindKey(json, key);
+        if (pos == std::string::npos) return false;
+        pos = json.find('"', pos);
+        if (pos == std::string::npos) return false;
+        value.clear();
+        for (++pos; pos < json.size() && json[pos] != '"'; ++pos) {
+            if (json[pos] == '\\' && pos + 1 < json.size()) ++pos;
+            value += json[pos];
+        }
+        return pos < json.size();
+    }
+
+    bool ReadNumber(const std::string& json, const char* key, double& value) {
+        const std::size_t pos = FindKey(json, key);
+        if (pos == std::string::npos) return false;
+        const char* begin = json.c_str() + pos;
+        char* end = nullptr;
+        value = std::strtod(begin, &end);
+        return end != begin;
+    }
+
+    bool ReadBool(const std::string& json, const char* key, bool& value) {
+        std::size_t pos = FindKey(json, key);
+        if (pos == std::string::npos) return false;
+        pos = json.find_first_not_of(" \t\r\n", pos);
+        if (pos == std::string::npos) return false;
+        value = json.compare(pos, 4, "true") == 0;
+        return true;
+    }
+}
+
+double MeasureRate(const std::function<double(std::uint64_t)>& work,
+                   double minSeconds, int repetitions) {
+    typedef std::chrono::steady_clock Clock;
+    auto timed = [&work](std::uint64_t n, double& amount) {
+        const Clock::time_point start = Clock::now();
+        amount = work(n);
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    // Calibrate the iteration count (this also warms up caches and tables)
+    std::uint64_t n = 1;
+    double amount = 0.0;
+    double seconds = timed(n, amount);
+    while (seconds < minSeconds) {
+        const double factor = seconds > 0.0 ? std::min(10.0, 1.2*minSeconds/seconds) : 10.0;
+        n = static_cast<std::uint64_t>(std::ceil(n*std::max(2.0, factor)));
+        seconds = timed(n, amount);
+    }
+
+    double best = seconds > 0.0 ? amount/seconds : 0.0;
+    for (int i = 1; i < repetitions; ++i) {
+        seconds = timed(n, amount);
+        if (seconds > 0.0) best = std::max(best, amount/seconds);
+    }
+    return best;
+}
+
+std::string ToJson(const Result& result) {
+    std::ostringstream out;
+    out.precision(6);
+    out << "{ \"name\": \"" << Escape(result.name) << "\", \"unit\": \"" << Escape(result.unit)
+        << "\", \"value\": " << result.value
+        << ", \"higherIsBetter\": " << (result.higherIsBetter ? "true" : "false") << " }";
+    return out.str();
+}
+
+bool ParseResult(const std::string& json, Result& result) {
+    Result parsed;
+    if (!ReadString(json, "name", parsed.name) || !ReadNumber(json, "value", parsed.value)) {
+        return false;
+    }
+    ReadString(json, "unit", parsed.unit);
+    ReadBool(json, "higherIsBetter", parsed.higherIsBetter);
+    result = parsed;
+    return true;
+}
+
+void WriteReport(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot write " + path);
+
+    out << "{\n"
+        << "  \"schema\": 1,\n"
+        << "  \"host\": \"" << Escape(HostName()) << "\",\n"
+        << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n"
+        << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        out << "    " << ToJson(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    if (!out) throw std::runtime_error("error writing " + path);
+}
+
+std::vector<Result> ReadReport(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read " + path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string json = buffer.str();
+
+    std::size_t pos = FindKey(json, "results");
+    if (pos == std::string::npos) throw std::runtime_error(path + ": no \"results\" array");
+
+    // Result objects are flat, so each one is the text between { and }
+    std::vector<Result> results;
+    for (;;) {
+        const std::size_t open = json.find('{', pos);
+        if (open == std::string::npos) break;
+        const std::size_t close = json.find('}', open);
+        if (close == std::string::npos) break;
+        Result result;
+        if (ParseResult(json.substr(open, close - open + 1), result)) results.push_back(result);
+        pos = close + 1;
+    }
+    return results;
+}
+
+std::vector<Comparison> Compare(const std::vector<Result>& baseline,
+                                const std::vector<Result>& current, double tolerance) {
+    std::map<std::string, const Result*> previous;
+    for (const Result& result : baseline) previous[result.name] = &result;
+
+    std::vector<Comparison> comparisons;
+    for (const Result& result : current) {
+        Comparison comparison;
+        comparison.name = result.name;
+        comparison.unit = result.unit;
+        comparison.current = result.value;
+
+        const auto found = previous.find(result.name);
+        if (found == previous.end()) {
+            comparison.status = Comparison::Status::New;
+        } else {
+            comparison.baseline = found->second->value;
+            previous.erase(found);
+            if (comparison.baseline > 0.0) {
+                const double ratio = comparison.current/comparison.baseline;
+                comparison.change = result.higherIsBetter ? ratio - 1.0 : 1.0/ratio - 1.0;
+            }
+            if (comparison.change < -tolerance) comparison.status = Comparison::Status::Regressed;
+            else if (comparison.change > tolerance) comparison.status = Comparison::Status::Improved;
+        }
+        comparisons.push_back(comparison);
+    }
+
+    // Benchmarks that were not run this time (e.g. filtered out)
+    for (const Result& result : baseline) {
+        if (previous.count(result.name) == 0) continue;
+        Comparison comparison;
+        comparison.name = result.name;
+        comparison.unit = result.unit;
+        comparison.baseline = result.value;
+        comparison.status = Comparison::Status::Missing;
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+const char* StatusName(Comparison::Status status) {
+    switch (status) {
+        case Comparison::Status::Unchanged: return "ok";
+        case Comparison::Status::Improved:  return "IMPROVED";
+        case Comparison::Status::Regressed: return "REGRESSION";
+        case Comparison::Status::New:       return "new";
+        case Comparison::Status::Missing:   return "missing";
+    }
+    return "unknown";
+}
+
+} // namespace Benchmark
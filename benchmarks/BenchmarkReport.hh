@@ -0,0 +1,64 @@
+// benchmarks/BenchmarkReport.hh
+#ifndef BENCHMARKREPORT_HH
+#define BENCHMARKREPORT_HH
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Benchmark timing, JSON results and baseline comparison
+//
+// A result is one named rate (events/s, draws/s, MB/s). Reports are JSON:
+//
+//   { "schema": 1, "host": ..., "hardwareThreads": ..., "results": [
+//       { "name": "spectrum/C-14/bulk", "unit": "draws/s",
+//         "value": 1.2e8, "higherIsBetter": true }, ... ] }
+//
+// The Geant4 helper executable prints the same result objects one per line
+// on stdout, which is how the main benchmark program collects them.
+//==============================================================================
+
+namespace Benchmark {
+    struct Result {
+        std::string name;
+        std::string unit;
+        double value = 0.0;
+        bool higherIsBetter = true;
+    };
+
+    // work(n) performs n iterations and returns the amount of work done in
+    // the result's unit (e.g. events). n is doubled until one call takes at
+    // least minSeconds; the best rate of `repetitions` such calls is returned.
+    double MeasureRate(const std::function<double(std::uint64_t)>& work,
+                       double minSeconds, int repetitions = 3);
+
+    // One result as a single-line JSON object, and back. ParseResult()
+    // returns false if the text is not a result object.
+    std::string ToJson(const Result& result);
+    bool ParseResult(const std::string& json, Result& result);
+
+    // Whole report. ReadReport() throws std::runtime_error if the file
+    // cannot be read.
+    void WriteReport(const std::string& path, const std::vector<Result>& results);
+    std::vector<Result> ReadReport(const std::string& path);
+
+    struct Comparison {
+        enum class Status { Unchanged, Improved, Regressed, New, Missing };
+        std::string name;
+        std::string unit;
+        double baseline = 0.0;
+        double current = 0.0;
+        double change = 0.0;      // Relative, positive = better
+        Status status = Status::Unchanged;
+    };
+
+    // A result is regressed (improved) if it got worse (better) by more than
+    // tolerance, relative to the baseline
+    std::vector<Comparison> Compare(const std::vector<Result>& baseline,
+                                    const std::vector<Result>& current, double tolerance);
+    const char* StatusName(Comparison::Status status);
+}
+
+#endif // BENCHMARKREPORT_HH
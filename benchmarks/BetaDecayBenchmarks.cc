@@ -0,0 +1,396 @@
+// benchmarks/BetaDecayBenchmarks.cc - Micro and macro benchmark suite
+//
+//   BetaDecayBenchmarks [--output results.json] [--baseline baseline.json]
+//                       [--tolerance 0.10] [--filter text] [--min-time s]
+//                       [--threads 1,2,4,...] [--transport-events n] [--quick]
+//
+// Micro benchmarks (no Geant4): spectrum sampling per isotope (scalar and
+// bulk draws), isotropic directions, standalone decay generation per
+// isotope and against thread count, and event output MB/s through the
+// asynchronous writer used by RunAction (text and binary).
+//
+// Macro benchmarks (built with Geant4): GeneratePrimaries events/s and full
+// transport events/s in the DetectorConstruction geometry against thread
+// count. They run in the BetaDecayTransportBenchmark helper, one process per
+// thread count, because a process can only hold one Geant4 run manager and
+// the standalone engine cannot be linked with the Geant4 types.
+//
+// Results are written as JSON. With --baseline each result is compared with
+// the baseline and the exit status is 2 if any got worse by more than the
+// tolerance.
+#include "BenchmarkReport.hh"
+
+#include "AsyncEventWriter.hh"
+#include "BetaDecayConsole.h"
+#include "BetaSpectrumTable.hh"
+#include "CounterRandom.hh"
+#include "DecayEventBatch.hh"
+#include "NuclideTable.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Options {
+        std::string output = "benchmark_results.json";
+        std::string baseline;
+        std::string filter;
+        double tolerance = 0.10;
+        double minTime = 0.5;
+        std::vector<int> threads;
+        long long transportEvents = 2000;
+    };
+
+    constexpr NuclideTable::Transition ToTransition(BetaDecayType type) {
+        return type == BetaDecayType::BETA_PLUS ? NuclideTable::Transition::BetaPlus
+             : type == BetaDecayType::ELECTRON_CAPTURE ? NuclideTable::Transition::ElectronCapture
+             : type == BetaDecayType::DOUBLE_BETA_MINUS || type == BetaDecayType::DOUBLE_BETA_MINUS_0NU
+                 ? NuclideTable::Transition::DoubleBetaMinus
+             : type == BetaDecayType::DOUBLE_BETA_PLUS ? NuclideTable::Transition::DoubleBetaPlus
+             : NuclideTable::Transition::BetaMinus;
+    }
+
+    // The isotopes of BetaDecayUtils::FindIsotope with the same decay mode
+    // (the dominant one) and the same Q-values, from NuclideTable
+    struct Isotope {
+        const char* name;
+        int Z, A;
+        BetaDecayType type;
+        double qValue;      // MeV
+
+        constexpr Isotope(const char* isotopeName, int z, int a, BetaDecayType decayType)
+            : name(isotopeName), Z(z), A(a), type(decayType),
+              qValue(NuclideTable::QValue(z, a, ToTransition(decayType))) {}
+    };
+    constexpr Isotope ISOTOPES[] = {
+        {"C-14",   6,  14,  BetaDecayType::BETA_MINUS},
+        {"Na-22",  11, 22,  BetaDecayType::BETA_PLUS},
+        {"K-40",   19, 40,  BetaDecayType::BETA_MINUS},
+        {"Ge-76",  32, 76,  BetaDecayType::DOUBLE_BETA_MINUS},
+        {"Se-82",  34, 82,  BetaDecayType::DOUBLE_BETA_MINUS},
+        {"Xe-136", 54, 136, BetaDecayType::DOUBLE_BETA_MINUS},
+        {"Te-130", 52, 130, BetaDecayType::DOUBLE_BETA_MINUS},
+        {"Mo-100", 42, 100, BetaDecayType::DOUBLE_BETA_MINUS}
+    };
+
+    int DaughterZ(const Isotope& isotope) {
+        switch (isotope.type) {
+            case BetaDecayType::BETA_MINUS:            return isotope.Z + 1;
+            case BetaDecayType::BETA_PLUS:             return isotope.Z - 1;
+            case BetaDecayType::ELECTRON_CAPTURE:      return isotope.Z - 1;
+            case BetaDecayType::DOUBLE_BETA_MINUS:     return isotope.Z + 2;
+            case BetaDecayType::DOUBLE_BETA_PLUS:      return isotope.Z - 2;
+            case BetaDecayType::DOUBLE_BETA_MINUS_0NU: return isotope.Z + 2;
+        }
+        return isotope.Z;
+    }
+
+    // Keeps results alive so the optimizer cannot drop the measured loops
+    volatile double gSink = 0.0;
+
+    class Suite {
+    public:
+        explicit Suite(const Options& options) : fOptions(options) {}
+
+        bool Selected(const std::string& name) const {
+            return fOptions.filter.empty() || name.find(fOptions.filter) != std::string::npos;
+        }
+
+        void Add(const Benchmark::Result& result) {
+            std::cout << std::left << std::setw(44) << result.name << std::right
+                      << std::setw(14) << std::setprecision(4) << result.value
+                      << " " << result.unit << std::endl;
+            fResults.push_back(result);
+        }
+
+        void Run(const std::string& name, const std::string& unit,
+                 const std::function<double(std::uint64_t)>& work) {
+            if (!Selected(name)) return;
+            Benchmark::Result result;
+            result.name = name;
+            result.unit = unit;
+            result.value = Benchmark::MeasureRate(work, fOptions.minTime);
+            Add(result);
+        }
+
+        const std::vector<Benchmark::Result>& GetResults() const { return fResults; }
+
+    private:
+        const Options& fOptions;
+        std::vector<Benchmark::Result> fResults;
+    };
+
+    void SpectrumBenchmarks(Suite& suite) {
+        for (const Isotope& isotope : ISOTOPES) {
+            if (isotope.type != BetaDecayType::BETA_MINUS &&
+                isotope.type != BetaDecayType::BETA_PLUS) continue;
+            const std::string prefix = std::string("spectrum/") + isotope.name;
+            const std::shared_ptr<const BetaSpectrumTable> table = BetaSpectrumTable::Get(
+                DaughterZ(isotope), isotope.qValue,
+                isotope.type == BetaDecayType::BETA_PLUS ? BetaSpectrumTable::Lepton::Positron
+                                                         : BetaSpectrumTable::Lepton::Electron);
+
+            suite.Run(prefix + "/scalar", "draws/s", [&table](std::uint64_t n) {
+                CounterRandom random(1);
+                double sum = 0.0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    const double u1 = random.Uniform();
+                    const double u2 = random.Uniform();
+                    sum += table->Sample(u1, u2);
+                }
+                gSink = sum;
+                return static_cast<double>(n);
+            });
+
+            suite.Run(prefix + "/bulk", "draws/s", [&table](std::uint64_t n) {
+                const std::size_t chunk = 4096;
+                std::vector<double> u(2*chunk), energies(chunk);
+                CounterRandom random(1);
+                double sum = 0.0;
+                for (std::uint64_t done = 0; done < n; done += chunk) {
+                    const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(chunk, n - done));
+                    random.Fill(u.data(), 2*count);
+                    table->Sample(u.data(), energies.data(), count);
+                    sum += energies[count - 1];
+                }
+                gSink = sum;
+                return static_cast<double>(n);
+            });
+        }
+
+        suite.Run("random/directions/bulk", "directions/s", [](std::uint64_t n) {
+            const std::size_t chunk = 4096;
+            std::vector<double> x(chunk), y(chunk), z(chunk);
+            CounterRandom random(1);
+            double sum = 0.0;
+            for (std::uint64_t done = 0; done < n; done += chunk) {
+                const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(chunk, n - done));
+                random.FillDirections(x.data(), y.data(), z.data(), count);
+                sum += z[count - 1];
+            }
+            gSink = sum;
+            return static_cast<double>(n);
+        });
+    }
+
+    void EngineBenchmarks(Suite& suite, const Options& options) {
+        // One core, per isotope
+        for (const Isotope& isotope : ISOTOPES) {
+            suite.Run(std::string("engine/") + isotope.name, "events/s", [&isotope](std::uint64_t n) {
+                BetaDecaySimulator simulator(1);
+                const Nucleus parent(isotope.Z, isotope.A);
+                DecayEventBatch batch;
+                std::uint64_t generated = 0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    if (batch.GetNumberOfEvents() == 4096) batch.Clear();
+                    generated += simulator.generate(parent, isotope.type, isotope.qValue,
+                                                    static_cast<std::int64_t>(i), batch);
+                }
+                return static_cast<double>(generated);
+            });
+        }
+
+        // Scaling: C-14 on all workers
+        const Isotope& isotope = ISOTOPES[0];
+        for (int threads : options.threads) {
+            std::ostringstream name;
+            name << "engine/" << isotope.name << "/threads=" << threads;
+            suite.Run(name.str(), "events/s", [&isotope, threads](std::uint64_t n) {
+                BetaDecaySimulator simulator(1);
+                simulator.setNumberOfThreads(threads);
+                std::vector<std::uint64_t> counts(threads*8, 0);   // One cache line per worker
+                simulator.runDecays(Nucleus(isotope.Z, isotope.A), isotope.type, isotope.qValue,
+                                    static_cast<long long>(n)*4096,
+                                    [&counts](int worker, const DecayEventBatch& batch) {
+                                        counts[worker*8] += batch.GetNumberOfEvents();
+                                    });
+                std::uint64_t total = 0;
+                for (std::uint64_t count : counts) total += count;
+                return static_cast<double>(total);
+            });
+        }
+    }
+
+    // RunAction output: records from every thread through the async writer
+    void OutputBenchmarks(Suite& suite, const Options& options) {
+        const int producers = std::max(1, options.threads.empty() ? 1 : options.threads.back());
+        const std::string path = "BetaDecayBenchmarks.tmp";
+        const struct {
+            const char* name;
+            EventFile::AsyncEventWriter::Format format;
+        } formats[] = {
+            {"output/text", EventFile::AsyncEventWriter::Format::Text},
+            {"output/binary", EventFile::AsyncEventWriter::Format::Binary}
+        };
+
+        for (const auto& format : formats) {
+            std::ostringstream name;
+            name << format.name << "/threads=" << producers;
+            suite.Run(name.str(), "MB/s", [&](std::uint64_t n) {
+                const std::uint64_t recordsPerProducer = n*1024;
+                EventFile::AsyncEventWriter writer(path, format.format,
+                                                   EventFile::AsyncEventWriter::Settings());
+                std::vector<std::thread> threads;
+                for (int p = 0; p < producers; ++p) {
+                    threads.emplace_back([&writer, p, producers, recordsPerProducer]() {
+                        std::unique_ptr<EventFile::AsyncEventWriter::Producer> producer =
+                            writer.CreateProducer();
+                        EventFile::EventRecord record;
+                        record.particle = 11;
+                        record.decayType = 1;
+                        record.x = record.y = record.z = 0.0f;
+                        for (std::uint64_t i = 0; i < recordsPerProducer; ++i) {
+                            record.eventId = static_cast<std::int64_t>(i*producers + p);
+                            record.energy = 1.0e-6*static_cast<double>(i % 156000);
+                            producer->Append(record);
+                        }
+                        producer->Flush();
+                    });
+                }
+                for (std::thread& thread : threads) thread.join();
+                writer.Close();
+                const double megabytes = writer.GetStatistics().bytes*1.0e-6;
+                std::remove(path.c_str());
+                return megabytes;
+            });
+        }
+    }
+
+#ifdef BETADECAY_TRANSPORT_BENCHMARK
+    // Run the Geant4 helper and collect the result lines it prints
+    void RunHelper(Suite& suite, const std::string& arguments) {
+        const std::string command = std::string("\"") + BETADECAY_TRANSPORT_BENCHMARK + "\" " + arguments;
+        FILE* pipe = popen(command.c_str(), "r");
+        if (!pipe) {
+            std::cerr << "WARNING: cannot run " << command << std::endl;
+            return;
+        }
+        char line[4096];
+        while (std::fgets(line, sizeof(line), pipe)) {
+            Benchmark::Result result;
+            if (line[0] == '{' && Benchmark::ParseResult(line, result)) suite.Add(result);
+        }
+        if (pclose(pipe) != 0) std::cerr << "WARNING: " << command << " failed" << std::endl;
+    }
+
+    void Geant4Benchmarks(Suite& suite, const Options& options) {
+        std::ostringstream common;
+        common << "--min-time " << options.minTime;
+        if (!options.filter.empty()) common << " --filter \"" << options.filter << "\"";
+
+        RunHelper(suite, "--primaries " + common.str());
+        for (int threads : options.threads) {
+            std::ostringstream name;
+            name << "transport/threads=" << threads;
+            if (!suite.Selected(name.str())) continue;
+            std::ostringstream arguments;
+            arguments << "--transport " << options.transportEvents << " --threads " << threads
+                      << " " << common.str();
+            RunHelper(suite, arguments.str());
+        }
+    }
+#endif
+
+    std::vector<int> ParseThreads(const std::string& list) {
+        std::vector<int> threads;
+        std::stringstream in(list);
+        std::string item;
+        while (std::getline(in, item, ',')) {
+            const int n = std::atoi(item.c_str());
+            if (n > 0) threads.push_back(n);
+        }
+        return threads;
+    }
+
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program
+                  << " [--output results.json] [--baseline baseline.json] [--tolerance 0.10]"
+                  << " [--filter text] [--min-time s] [--threads 1,2,4,...]"
+                  << " [--transport-events n] [--quick]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--output" && hasValue) options.output = argv[++i];
+        else if (arg == "--baseline" && hasValue) options.baseline = argv[++i];
+        else if (arg == "--tolerance" && hasValue) options.tolerance = std::atof(argv[++i]);
+        else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--min-time" && hasValue) options.minTime = std::atof(argv[++i]);
+        else if (arg == "--threads" && hasValue) options.threads = ParseThreads(argv[++i]);
+        else if (arg == "--transport-events" && hasValue) options.transportEvents = std::atoll(argv[++i]);
+        else if (arg == "--quick") {
+            options.minTime = 0.1;
+            options.transportEvents = 500;
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Default thread counts: powers of two up to the hardware threads
+    if (options.threads.empty()) {
+        const int hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (int n = 1; n < hardware; n *= 2) options.threads.push_back(n);
+        options.threads.push_back(hardware);
+    }
+
+    Suite suite(options);
+    try {
+        SpectrumBenchmarks(suite);
+        EngineBenchmarks(suite, options);
+        OutputBenchmarks(suite, options);
+#ifdef BETADECAY_TRANSPORT_BENCHMARK
+        Geant4Benchmarks(suite, options);
+#endif
+        Benchmark::WriteReport(options.output, suite.GetResults());
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Results written to " << options.output << std::endl;
+
+    if (options.baseline.empty()) return 0;
+
+    std::vector<Benchmark::Result> baseline;
+    try {
+        baseline = Benchmark::ReadReport(options.baseline);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    int regressions = 0;
+    std::cout << "\nComparison with " << options.baseline << " (tolerance "
+              << options.tolerance*100.0 << "%)" << std::endl;
+    for (const Benchmark::Comparison& comparison :
+             Benchmark::Compare(baseline, suite.GetResults(), options.tolerance)) {
+        // Baseline entries left out by --filter are not reported
+        if (comparison.status == Benchmark::Comparison::Status::Missing &&
+            !suite.Selected(comparison.name)) continue;
+        std::cout << std::left << std::setw(44) << comparison.name << std::right
+                  << std::setw(12) << std::setprecision(4) << comparison.baseline
+                  << std::setw(12) << comparison.current << " " << std::setw(8)
+                  << std::showpos << std::fixed << std::setprecision(1)
+                  << comparison.change*100.0 << "%" << std::noshowpos << std::defaultfloat
+                  << "  " << Benchmark::StatusName(comparison.status) << std::endl;
+        if (comparison.status == Benchmark::Comparison::Status::Regressed) ++regressions;
+    }
+    if (regressions > 0) {
+        std::cout << regressions << " regression(s)" << std::endl;
+        return 2;
+    }
+    return 0;
+}
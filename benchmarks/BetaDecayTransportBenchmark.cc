@@ -0,0 +1,160 @@
+// benchmarks/BetaDecayTransportBenchmark.cc - Geant4 benchmarks
+//
+//   BetaDecayTransportBenchmark --primaries [--min-time s] [--filter text]
+//   BetaDecayTransportBenchmark --transport n --threads t
+//
+// Helper of BetaDecayBenchmarks, which runs it once per thread count: the
+// number of worker threads is fixed when the run manager is initialized and
+// a process can only create one run manager. Prints one JSON result per line
+// on stdout; all Geant4 output is discarded.
+//
+// --primaries: BetaDecayPrimaryGenerator::GeneratePrimaries events/s for
+//              each implemented decay mode
+// --transport: full-transport events/s (DetectorConstruction geometry,
+//              PhysicsList, all user actions, binary output) with t threads
+#include "BenchmarkReport.hh"
+
+#include "ActionInitialization.hh"
+#include "BetaDecay.hh"
+#include "DetectorConstruction.hh"
+#include "PhysicsList.hh"
+
+#include "G4Event.hh"
+#include "G4RunManager.hh"
+#include "G4RunManagerFactory.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UImanager.hh"
+#include "G4UIsession.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+    // Swallows G4cout/G4cerr so that stdout only carries results
+    class NullSession : public G4UIsession {
+    public:
+        G4UIsession* SessionStart() override { return nullptr; }
+        G4int ReceiveG4cout(const G4String&) override { return 0; }
+        G4int ReceiveG4cerr(const G4String&) override { return 0; }
+    };
+
+    void Print(const std::string& name, const std::string& unit, double value) {
+        Benchmark::Result result;
+        result.name = name;
+        result.unit = unit;
+        result.value = value;
+        std::cout << Benchmark::ToJson(result) << std::endl;
+    }
+
+    void PrimaryBenchmarks(G4RunManager* runManager, double minTime, const std::string& filter) {
+        const struct {
+            const char* name;
+            Nucleus parent;
+            BetaDecayType type;
+            G4double qValue;
+        } cases[] = {
+            {"C-14", BetaDecayIsotopes::C14, BetaDecayType::BETA_MINUS,
+             BetaDecayIsotopes::QValues::C14_BETA_MINUS*MeV},
+            {"Na-22", BetaDecayIsotopes::Na22, BetaDecayType::BETA_PLUS,
+             BetaDecayIsotopes::QValues::Na22_BETA_PLUS*MeV}
+        };
+
+        // The serial run manager's generator, built by ActionInitialization
+        // (a second instance would register its UI commands twice)
+        BetaDecayPrimaryGenerator& generator = *const_cast<BetaDecayPrimaryGenerator*>(
+            static_cast<const BetaDecayPrimaryGenerator*>(runManager->GetUserPrimaryGeneratorAction()));
+        for (const auto& decay : cases) {
+            const std::string name = std::string("primaries/") + decay.name;
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+            generator.SetDecayType(decay.type);
+            generator.SetParentNucleus(decay.parent.Z, decay.parent.A);
+            generator.SetQValue(decay.qValue);
+            const double rate = Benchmark::MeasureRate([&generator](std::uint64_t n) {
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    G4Event event(static_cast<G4int>(i));
+                    generator.GeneratePrimaries(&event);
+                }
+                return static_cast<double>(n);
+            }, minTime);
+            Print(name, "events/s", rate);
+        }
+    }
+
+    double TransportBenchmark(G4RunManager* runManager, long long nEvents, int threads) {
+        G4UImanager* ui = G4UImanager::GetUIpointer();
+        const std::string output = "BetaDecayTransportBenchmark.tmp";
+        ui->ApplyCommand("/betadecay/output/format binary");
+        ui->ApplyCommand("/betadecay/output/file " + output);
+
+        // Warm up: builds physics tables, spectrum tables and threads
+        runManager->BeamOn(std::max(100, 10*threads));
+
+        const auto start = std::chrono::steady_clock::now();
+        runManager->BeamOn(static_cast<G4int>(nEvents));
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::remove((output + ".bdevt").c_str());
+        return seconds > 0.0 ? nEvents/seconds : 0.0;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool primaries = false;
+    long long transportEvents = 0;
+    int threads = 1;
+    double minTime = 0.5;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--primaries") primaries = true;
+        else if (arg == "--transport" && hasValue) transportEvents = std::atoll(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--min-time" && hasValue) minTime = std::atof(argv[++i]);
+        else if (arg == "--filter" && hasValue) filter = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " --primaries [--min-time s] [--filter text] | "
+                      << "--transport n --threads t" << std::endl;
+            return 1;
+        }
+    }
+
+    NullSession session;
+    G4UImanager* ui = G4UImanager::GetUIpointer();
+    ui->SetCoutDestination(&session);
+
+    // Primaries run on the master thread, so they need the serial manager
+    G4RunManager* runManager = G4RunManagerFactory::CreateRunManager(
+        transportEvents > 0 ? G4RunManagerType::Default : G4RunManagerType::SerialOnly);
+    runManager->SetNumberOfThreads(threads);
+    runManager->SetUserInitialization(new DetectorConstruction());
+    runManager->SetUserInitialization(new PhysicsList());
+    runManager->SetUserInitialization(new ActionInitialization());
+    runManager->Initialize();
+
+    ui->ApplyCommand("/control/verbose 0");
+    ui->ApplyCommand("/run/verbose 0");
+    ui->ApplyCommand("/event/verbose 0");
+    ui->ApplyCommand("/tracking/verbose 0");
+    ui->ApplyCommand("/run/printProgress 0");
+    ui->ApplyCommand("/betadecay/telemetry/interval 0");
+
+    if (primaries) PrimaryBenchmarks(runManager, minTime, filter);
+    if (transportEvents > 0) {
+        std::ostringstream name;
+        name << "transport/threads=" << threads;
+        Print(name.str(), "events/s", TransportBenchmark(runManager, transportEvents, threads));
+    }
+
+    ui->SetCoutDestination(nullptr);
+    delete runManager;
+    return 0;
+}
@@ -0,0 +1,164 @@
+// include/AsyncEventWriter.hh
+#ifndef ASYNCEVENTWRITER_HH
+#define ASYNCEVENTWRITER_HH
+
+#include "EventFileFormat.hh"
+#include "EventFileWriter.hh"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+// Asynchronous event output
+//
+// Simulation threads append EventRecords to their own Producer, which owns a
+// small ring of pre-allocated buffers. A full buffer is handed to the writer
+// thread and the producer carries on with the next free one; the writer
+// encodes each buffer (text lines or one binary chunk) and writes it with a
+// single large write, then gives the buffer back to its producer.
+//
+// Backpressure: a producer only blocks when all of its buffers are queued or
+// being written, i.e. when the disk has fallen behind by more than
+// (buffersPerProducer - 1) buffers. Time spent blocked is counted in the
+// statistics. Records are never dropped.
+//
+// Flush guarantee: Producer::Flush() submits the partly filled buffer and
+// waits until all of the producer's buffers are back; Close() drains the
+// queue, joins the thread and finishes the file (text summary or binary
+// index and trailer). Write errors are reported by Close().
+//
+// Every buffer is flushed to the operating system once written, and
+// GetPosition() gives the end of the data written so far: a checkpoint
+// (Checkpoint.hh) records it, and a resumed job continues the file from
+// there in append mode.
+//==============================================================================
+
+namespace EventFile {
+
+class AsyncEventWriter {
+public:
+    enum class Format { Text, Binary };
+
+    struct Settings {
+        std::uint32_t bufferRecords = 16384;    // Per buffer; one binary chunk each
+        std::uint32_t buffersPerProducer = 2;   // Double buffering by default
+    };
+
+    struct Statistics {
+        std::uint64_t records = 0;
+        std::uint64_t buffers = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t stalls = 0;               // Producer waits for a free buffer
+        double stallSeconds = 0.0;
+        double writeSeconds = 0.0;              // Writer thread encode + write time
+    };
+
+    // End of the whole buffers written so far, and for binary output the
+    // index of their chunks
+    struct Position {
+        std::uint64_t offset = 0;
+        std::vector<IndexEntry> chunks;
+    };
+
+    class Producer;
+
+    // Opens the file and starts the writer thread. Throws std::runtime_error
+    // if the file cannot be created. With append, an existing file is
+    // continued instead: a complete binary file, or text output without
+    // its summary.
+    AsyncEventWriter(const std::string& path, Format format, const Settings& settings,
+                     bool append = false);
+    ~AsyncEventWriter();
+
+    AsyncEventWriter(const AsyncEventWriter&) = delete;
+    AsyncEventWriter& operator=(const AsyncEventWriter&) = delete;
+
+    // One producer per simulation thread. Producers must be flushed or
+    // destroyed before Close().
+    std::unique_ptr<Producer> CreateProducer();
+
+    // Drain, stop the writer thread and finish the file. The summary is
+    // appended to text output and ignored for binary output. Throws
+    // std::runtime_error if any write failed.
+    void Close(const TextSummary& summary = TextSummary());
+
+    Format GetFormat() const { return fFormat; }
+    const std::string& GetPath() const { return fPath; }
+    Statistics GetStatistics() const;
+    Position GetPosition() const;
+
+private:
+    struct Buffer {
+        std::vector<EventRecord> records;
+        Producer* owner;
+    };
+
+    void Submit(Buffer* buffer);
+    Buffer* Acquire(Producer* producer);
+    void Release(Producer* producer);
+    void WriterLoop();
+    void WriteBuffer(const Buffer& buffer);
+
+    const Format fFormat;
+    const std::string fPath;
+    const Settings fSettings;
+
+    std::unique_ptr<EventFileWriter> fBinaryFile;
+    std::ofstream fTextFile;
+    std::string fTextScratch;                   // Writer thread only
+
+    mutable std::mutex fMutex;
+    std::condition_variable fWork;              // Writer waits for buffers
+    std::condition_variable fReturned;          // Producers wait for buffers
+    std::deque<Buffer*> fQueue;
+    bool fStopping;
+    bool fClosed;
+    std::exception_ptr fError;
+    Statistics fStatistics;
+    Position fPosition;
+
+    std::thread fThread;
+
+    friend class Producer;
+};
+
+class AsyncEventWriter::Producer {
+public:
+    ~Producer();
+
+    Producer(const Producer&) = delete;
+    Producer& operator=(const Producer&) = delete;
+
+    void Append(const EventRecord& record) {
+        fCurrent->records.push_back(record);
+        if (fCurrent->records.size() >= fCapacity) Submit();
+    }
+
+    // Hand over the current buffer and wait until everything this producer
+    // submitted has been written
+    void Flush();
+
+private:
+    friend class AsyncEventWriter;
+
+    explicit Producer(AsyncEventWriter* writer);
+    void Submit();
+
+    AsyncEventWriter* fWriter;
+    std::size_t fCapacity;
+    std::vector<std::unique_ptr<Buffer>> fBuffers;
+    std::vector<Buffer*> fFree;                 // Guarded by the writer mutex
+    Buffer* fCurrent;
+};
+
+} // namespace EventFile
+
+#endif // ASYNCEVENTWRITER_HH
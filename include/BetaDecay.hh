@@ -8,12 +8,21 @@
 #include "G4IonTable.hh"
 #include "G4RandomDirection.hh"
 #include "globals.hh"
+#include "BetaSpectrumTable.hh"
+#include "DoubleBetaSpectrumTable.hh"
+#include "NuclideTable.hh"
+#include "SourceMixture.hh"
+#include "CounterRandom.hh"
+#include "Checkpoint.hh"
+#include <memory>
 #include <vector>
 #include <string>
 
 // Forward declarations
 class G4Event;
 class G4ParticleDefinition;
+class BetaDecayMessenger;
+class PrimaryReplayGenerator;
 
 //==============================================================================
 // Enumerations for decay types
@@ -28,6 +37,16 @@ enum class BetaDecayType {
     DOUBLE_BETA_0NU       // ββ⁻ (0ν): 2n → 2p + 2e⁻ (neutrinoless)
 };
 
+//==============================================================================
+// Emission direction biasing
+//==============================================================================
+
+enum class EmissionBiasing {
+    ISOTROPIC,            // 4π, weight 1
+    CONE,                 // Cone given by SetBiasCone
+    DETECTOR              // Smallest cone around the detector array, plus a margin
+};
+
 //==============================================================================
 // Structure to hold nucleus information
 //==============================================================================
@@ -89,10 +108,86 @@ public:
     virtual void GeneratePrimaries(G4Event* event) override;
     
     // Setters for decay configuration
-    void SetDecayType(BetaDecayType type) { fDecayType = type; }
+    void SetDecayType(BetaDecayType type) { fDecayType = type; UpdateDaughterNucleus(); }
     void SetParentNucleus(G4int Z, G4int A, G4double excitation = 0.0);
     void SetQValue(G4double qval) { fQValue = qval; }
-    void SetSourcePosition(G4ThreeVector pos) { fSourcePosition = pos; }
+    void SetSourcePosition(G4ThreeVector pos) { fSourcePosition = pos; fBiasGeometryVersion = -1; }
+    // Parent, decay mode and Q-value of a named isotope (see
+    // BetaDecayUtils::FindIsotope); false and unchanged if unknown
+    G4bool SetIsotope(const G4String& name);
+    
+    // Solid-angle biasing of the primary directions. A fraction of the
+    // primaries is emitted into the cone and the rest outside it; each
+    // vertex gets the weight (isotropic density)/(biased density), so
+    // weighted sums estimate the unbiased ones. With fraction 1 (default)
+    // nothing is emitted outside the cone, which is exact as long as
+    // particles outside it cannot scatter into the detector. Double beta
+    // pairs are biased through the first electron; the second follows at
+    // the correlated angle, so with fraction 1 pairs whose first electron
+    // misses the cone are not generated at all.
+    void SetBiasing(EmissionBiasing mode);
+    void SetBiasCone(const G4ThreeVector& axis, G4double halfAngle);
+    void SetBiasMargin(G4double angle);
+    void SetBiasFraction(G4double fraction);
+    EmissionBiasing GetBiasing() const { return fBiasing; }
+    G4ThreeVector GetBiasAxis() const { return fBiasAxis; }
+    G4double GetBiasAngle() const { return fBiasAngle; }
+    
+    // Validate each spectrum table against the analytic shape with
+    // nSamples draws the next time it is fetched (0 disables)
+    void SetSpectrumValidation(G4int nSamples);
+    
+    // Primaries are drawn from a counter-based stream keyed by (seed, run id,
+    // global event id), so an event's primaries do not depend on the thread
+    // count or on which worker processes it. The order of the records in
+    // the event file does: workers finish events in any order
+    // (BetaDecayMerge sorts a binary file by event id). Only the standalone
+    // engine's output is bit-identical for any thread count.
+    void SetSeed(G4long seed) { fSeed = seed; }
+    G4long GetSeed() const { return fSeed; }
+    // With false, every run uses the streams of the seed alone instead of
+    // a family per run id, so consecutive runs replay the same primaries
+    // (e.g. to compare physics settings, fastsim.mac). Default true.
+    void SetStreamPerRun(G4bool perRun) { fStreamPerRun = perRun; }
+    G4bool GetStreamPerRun() const { return fStreamPerRun; }
+    
+    // Global id of the run's event 0. The stream and the output records use
+    // firstEvent + event id, so a workload split into jobs over consecutive
+    // id ranges (BetaDecaySimulation --shards) draws the same primaries as
+    // one job running all of it.
+    void SetFirstEvent(G4long first);
+    G4long GetFirstEvent() const { return fFirstEvent; }
+    
+    // Run only these global ids, in order (a resumed run, see
+    // Checkpoint.hh): event n of the run is the n-th of them. Empty ranges
+    // return to firstEvent + n.
+    void SetEventRanges(const Checkpoint::EventRanges& ranges) { fEventRanges = ranges; }
+    G4long GetGlobalEventId(G4int eventID) const {
+        return fEventRanges.IsEmpty() ? fFirstEvent + eventID : fEventRanges.Select(eventID);
+    }
+    
+    // Also reseed the transport engine from the event's stream, so an event
+    // can be re-simulated on its own (e.g. with /run/beamOn after skipping)
+    void SetReseedTransport(G4bool reseed) { fReseedTransport = reseed; }
+    
+    // Replay a pre-generated primary file (PrimaryReplayGenerator) instead
+    // of sampling; event n takes record replayFirstEvent + n, n the global
+    // event id (see SetFirstEvent). An empty name
+    // returns to sampling. False and unchanged if the file cannot be used.
+    G4bool SetReplayFile(const G4String& fileName);
+    void SetReplayFirstEvent(G4long first);
+    G4bool IsReplaying() const { return fReplay != nullptr; }
+    
+    // Mixed source: once it has an isotope, every event picks an isotope
+    // and branch by activity x branching ratio (SourceMixture) in place of
+    // the single parent above. Isotopes come from the built-in decay data
+    // (BetaDecayUtils::AddSource) with their activity at age 0, chain
+    // daughters included; the age evolves the activities (Bateman).
+    G4bool AddSourceIsotope(const G4String& name, G4double activity);
+    void SetSourceAge(G4double age);
+    void ClearSource();
+    void PrintSource() const;
+    const SourceMixture& GetSource() const { return fSource; }
     
     // Getters
     BetaDecayType GetDecayType() const { return fDecayType; }
@@ -104,7 +199,10 @@ public:
     void GenerateBetaPlus(G4Event* event);
     void GenerateElectronCapture(G4Event* event);
     
-    // Double beta decay generators
+    // Double beta decay generators: (T1, T2) from the shared tabulated
+    // spectrum (DoubleBetaSpectrumTable), both leptons in one vertex. Q is
+    // the kinetic energy shared by the leptons (for 2nu2beta+ the Q-value
+    // less the four electron masses).
     void GenerateDoubleBetaMinus(G4Event* event);
     void GenerateDoubleBetaPlus(G4Event* event);
     void GenerateDoubleBeta0Nu(G4Event* event);
@@ -116,18 +214,66 @@ private:
     Nucleus fDaughterNucleus;
     G4double fQValue;              // Q-value in MeV
     G4ThreeVector fSourcePosition; // Source position
+    BetaDecayMessenger* fMessenger;
+    PrimaryReplayGenerator* fReplay;   // nullptr unless replaying
+    G4long fReplayFirstEvent;
+    
+    // Mixed source and the spectrum tables of each of its branches
+    struct SourceTables {
+        std::shared_ptr<const BetaSpectrumTable> spectrum;
+        std::shared_ptr<const DoubleBetaSpectrumTable> doubleBeta;
+    };
+    SourceMixture fSource;
+    std::vector<SourceTables> fSourceTables;
+    
+    // Tabulated spectra for the current (Z, Q, lepton), shared between threads
+    std::shared_ptr<const BetaSpectrumTable> fSpectrumTable;
+    std::shared_ptr<const DoubleBetaSpectrumTable> fDoubleBetaTable;
+    
+    // Per-event random stream
+    CounterRandom fRandom;
+    G4long fSeed;
+    G4bool fStreamPerRun;
+    G4long fFirstEvent;
+    Checkpoint::EventRanges fEventRanges;
+    G4bool fReseedTransport;
+    
+    // Emission biasing; the cone in use is (fConeAxis, fConeCos)
+    EmissionBiasing fBiasing;
+    G4ThreeVector fBiasAxis;        // CONE axis, unit vector
+    G4double fBiasAngle;            // CONE half-angle
+    G4double fBiasMargin;           // Added to the DETECTOR cone
+    G4double fBiasFraction;         // Of the primaries emitted into the cone
+    G4ThreeVector fConeAxis;
+    G4double fConeCos;
+    G4int fBiasGeometryVersion;     // Of the DETECTOR cone, -1 if outdated
+    G4double fDirectionWeight;      // Of the last SampleDirection
+    
+    // Decay of the current configuration, and of a branch of the source
+    void GenerateDecay(G4Event* event);
+    void GenerateSourceDecay(G4Event* event);
     
     // Helper functions for energy distributions
     G4double SampleBetaSpectrum(G4double qValue, G4int Z);
     G4double FermiFunction(G4double energy, G4int Z);
+    // Sets fDirectionWeight; SetVertexWeight hands it to the last vertex
+    G4ThreeVector SampleDirection();
+    G4ThreeVector IsotropicDirection();
+    void SetVertexWeight(G4Event* event) const;
+    void UpdateBiasCone();
+    void GenerateDoubleBeta(G4Event* event, G4ParticleDefinition* lepton,
+                            DoubleBetaSpectrumTable::Mode mode);
     void GenerateDecayParticles(std::vector<DecayParticle>& particles);
     void UpdateDaughterNucleus();
     
+    BetaSpectrumTable::Lepton GetSpectrumLepton() const;
+    
     // Particle definitions (cached for performance)
     G4ParticleDefinition* fElectron;
     G4ParticleDefinition* fPositron;
     G4ParticleDefinition* fNeutrino;
     G4ParticleDefinition* fAntiNeutrino;
+    G4ParticleDefinition* fGamma;
 };
 
 //==============================================================================
@@ -136,15 +282,18 @@ private:
 
 class BetaDecayPhysics {
 public:
-    // Q-value calculations
+    // Q-value from the atomic masses (NuclideTable: evaluated if parent and
+    // daughter are tabulated, else semi-empirical), less two electron
+    // masses per positron
     static G4double CalculateQValue(const Nucleus& parent, const Nucleus& daughter, 
                                      BetaDecayType type);
     
-    // Check if decay is energetically allowed
+    // Check if decay is energetically allowed: by the mass tables if parent
+    // and daughter are tabulated, else by the given qValue
     static G4bool IsDecayAllowed(const Nucleus& parent, BetaDecayType type, 
                                   G4double qValue);
     
-    // Get nuclear mass (simplified using semi-empirical mass formula)
+    // Nuclear mass: atomic mass (NuclideTable) less the electron masses
     static G4double GetNuclearMass(G4int Z, G4int A);
     
     // Beta spectrum shape function
@@ -153,7 +302,14 @@ public:
     // Fermi function for Coulomb corrections
     static G4double FermiFunction(G4double electronEnergy, G4int Z);
     
-    // Get element symbol from Z
+    // Batch versions over an energy grid (vectorized kernels):
+    // values[i] = f(energies[i]) for i < n
+    static void BetaSpectrumShape(const G4double* energies, G4double* values,
+                                  std::size_t n, G4double qValue, G4int Z);
+    static void FermiFunction(const G4double* electronEnergies, G4double* values,
+                              std::size_t n, G4int Z);
+    
+    // Element symbol from Z ("Z<n>" beyond the table)
     static G4String GetElementSymbol(G4int Z);
     
     // Constants
@@ -170,26 +326,40 @@ public:
 namespace BetaDecayIsotopes {
     // Single beta decay isotopes
     const Nucleus C14(6, 14, 0.0, "C-14");      // Q = 0.156 MeV
-    const Nucleus Na22(11, 22, 0.0, "Na-22");   // Q = 2.842 MeV
-    const Nucleus K40(19, 40, 0.0, "K-40");     // Q = 1.505 MeV
+    const Nucleus Na22(11, 22, 0.0, "Na-22");   // Q = 1.821 MeV (beta+)
+    const Nucleus K40(19, 40, 0.0, "K-40");     // Q = 1.311 MeV (beta-), 1.505 MeV (EC)
     
     // Double beta decay isotopes
     const Nucleus Ge76(32, 76, 0.0, "Ge-76");   // Q = 2.039 MeV
-    const Nucleus Se82(34, 82, 0.0, "Se-82");   // Q = 2.995 MeV
+    const Nucleus Se82(34, 82, 0.0, "Se-82");   // Q = 2.998 MeV
     const Nucleus Xe136(54, 136, 0.0, "Xe-136"); // Q = 2.458 MeV
     const Nucleus Te130(52, 130, 0.0, "Te-130"); // Q = 2.527 MeV
     const Nucleus Mo100(42, 100, 0.0, "Mo-100"); // Q = 3.034 MeV
     
-    // Q-values (in MeV)
+    // Q-values (in MeV), evaluated at compile time from NuclideTable
     namespace QValues {
-        constexpr G4double C14_BETA_MINUS = 0.156;
-        constexpr G4double Na22_BETA_PLUS = 2.842;
-        constexpr G4double K40_EC = 1.505;
-        constexpr G4double Ge76_DBD = 2.039;
-        constexpr G4double Se82_DBD = 2.995;
-        constexpr G4double Xe136_DBD = 2.458;
-        constexpr G4double Te130_DBD = 2.527;
-        constexpr G4double Mo100_DBD = 3.034;
+        using NuclideTable::QValue;
+        using NuclideTable::Transition;
+        constexpr G4double C14_BETA_MINUS = QValue(6, 14, Transition::BetaMinus);
+        constexpr G4double Na22_BETA_PLUS = QValue(11, 22, Transition::BetaPlus);
+        constexpr G4double K40_BETA_MINUS = QValue(19, 40, Transition::BetaMinus);
+        constexpr G4double K40_EC = QValue(19, 40, Transition::ElectronCapture);
+        constexpr G4double Ge76_DBD = QValue(32, 76, Transition::DoubleBetaMinus);
+        constexpr G4double Se82_DBD = QValue(34, 82, Transition::DoubleBetaMinus);
+        constexpr G4double Xe136_DBD = QValue(54, 136, Transition::DoubleBetaMinus);
+        constexpr G4double Te130_DBD = QValue(52, 130, Transition::DoubleBetaMinus);
+        constexpr G4double Mo100_DBD = QValue(42, 100, Transition::DoubleBetaMinus);
+    
+        // Double beta emitters cannot decay by single beta decay
+        static_assert(QValue(32, 76, Transition::BetaMinus) < 0. &&
+                      QValue(34, 82, Transition::BetaMinus) < 0. &&
+                      QValue(54, 136, Transition::BetaMinus) < 0. &&
+                      QValue(52, 130, Transition::BetaMinus) < 0. &&
+                      QValue(42, 100, Transition::BetaMinus) < 0.,
+                      "single beta decay of a double beta emitter");
+        static_assert(C14_BETA_MINUS > 0. && Na22_BETA_PLUS > 0. && K40_BETA_MINUS > 0. &&
+                      K40_EC > 0. && Ge76_DBD > 0. && Se82_DBD > 0. && Xe136_DBD > 0. &&
+                      Te130_DBD > 0. && Mo100_DBD > 0., "decay not allowed by the mass table");
     }
 }
 
@@ -206,6 +376,25 @@ namespace BetaDecayUtils {
     
     // Get daughter nucleus from parent and decay type
     Nucleus GetDaughterNucleus(const Nucleus& parent, BetaDecayType type);
+    
+    // Parent, decay mode and Q-value (MeV) of a BetaDecayIsotopes entry by
+    // name ("C-14", "Ge-76", ...); false if the name is unknown. An isotope
+    // with several modes gets its dominant one (K-40: beta-); the others
+    // come with /betadecay/source/add.
+    G4bool FindIsotope(const G4String& name, Nucleus& parent, BetaDecayType& type,
+                       G4double& qValue);
+    
+    // Names accepted by FindIsotope, separated by spaces
+    G4String IsotopeNames();
+    
+    // Add a source isotope by name with its activity (Bq) at age 0: its
+    // half-life, decay branches (with their prompt gammas) and chain
+    // daughters. Adding an isotope already in the source adds to its
+    // activity. False and unchanged if the name is unknown.
+    G4bool AddSource(SourceMixture& source, const G4String& name, G4double activity);
+    
+    // Names accepted by AddSource, separated by spaces
+    G4String SourceNames();
 }
 
 #endif // BETADECAY_H
@@ -5,6 +5,15 @@
 #include <vector>
 #include <random>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "CounterRandom.hh"
+#include "DecayEventBatch.hh"
+
+class BetaSpectrumTable;
+class DoubleBetaSpectrumTable;
 
 /**
  * Enum for beta decay types
@@ -62,27 +71,74 @@ struct DecayEvent {
 
 /**
  * Main Beta Decay Simulator class
+ *
+ * Generates decay kinematics without transport and without Geant4. Single
+ * beta energies come from the shared alias tables (BetaSpectrumTable), double
+ * beta energies from the shared (T1, T2) tables (DoubleBetaSpectrumTable).
+ * Lepton and neutrino directions are isotropic, except that the two double
+ * beta leptons follow the angular correlation 1 - beta1 beta2 cos(theta). The
+ * daughter recoil closes momentum and energy balance, so the kinetic energies of all
+ * products add up to the Q-value. Energies are kinetic, in MeV.
+ *
+ * A simulator is not thread-safe; runMultipleDecays() and runDecays() use
+ * one per worker thread internally.
  */
 class BetaDecaySimulator {
 private:
-    std::mt19937 generator;
-    std::uniform_real_distribution<double> uniform;
+    // Counter-based: event i draws from stream i of the seed, so events do
+    // not depend on the thread count or on the order they are generated in
+    CounterRandom random;
+    std::int64_t nextEventId;   // Id of the next event of simulate()/run*()
+    int numThreads;
+    
+    // Last tables used, so repeated decays skip the shared cache lookup
+    std::shared_ptr<const BetaSpectrumTable> spectrumTable;
+    std::shared_ptr<const DoubleBetaSpectrumTable> doubleBetaTable;
+    
+    // Reused by simulate(), so single events do not allocate columns
+    DecayEventBatch scratch;
     
     // Physics constants
-    static constexpr double ELECTRON_MASS = 0.511;  // MeV/c²
-    static constexpr double NEUTRON_MASS = 939.565; // MeV/c²
-    static constexpr double PROTON_MASS = 938.272;  // MeV/c²
+    static constexpr double ELECTRON_MASS = 0.51099895;     // MeV/c²
+    static constexpr double NEUTRON_MASS = 939.56542052;    // MeV/c²
+    static constexpr double PROTON_MASS = 938.27208816;     // MeV/c²
+    static constexpr double ATOMIC_MASS_UNIT = 931.49410242; // MeV/c²
     static constexpr double C = 299792458.0;        // m/s
     static constexpr double HBAR = 6.582119569e-22; // MeV·s
     
+    // Events per work unit of the parallel runs
+    static constexpr long long BLOCK_SIZE = 4096;
+    
     // Helper functions for energy distributions
     double fermiFunction(double electronEnergy, int Z);
     double betaSpectrum(double electronEnergy, double qValue, int Z);
     std::vector<double> generateMomentum(double energy, double mass);
-    void conserveMomentumEnergy(std::vector<DecayProduct>& products, double qValue);
+    void sampleMomentum(double energy, double mass, double p[3]);
+    // Add the recoiling daughter (momentum balance) to the last event of the
+    // batch and rescale the neutrino energies, or the lepton energies if
+    // there are no neutrinos, so that the total kinetic energy equals qValue
+    void conserveMomentumEnergy(DecayEventBatch& batch, double qValue,
+                                int daughterZ, int daughterA);
+    
+    // Helpers shared by the decay modes
+    double sampleSingleBeta(int daughterZ, double qValue, bool positron);
+    void sampleDoubleBeta(int daughterZ, double qValue, bool positron, bool neutrinoless,
+                          double& t1, double& t2);
+    void addLepton(DecayEventBatch& batch, DecayEventBatch::ParticleType type,
+                   double energy, double mass);
+    // The two leptons of a double beta decay, with their angular correlation
+    void addLeptonPair(DecayEventBatch& batch, DecayEventBatch::ParticleType type,
+                       double t1, double t2);
+    void addNeutrinos(DecayEventBatch& batch, DecayEventBatch::ParticleType type,
+                      int count, double energy);
+    // Run block(simulator, worker, blockIndex) for every BLOCK_SIZE slice of
+    // numEvents, with one simulator (same seed) per worker
+    void runBlocks(long long numEvents,
+                   const std::function<void(BetaDecaySimulator&, int, long long)>& block);
     
 public:
     BetaDecaySimulator(unsigned int seed = std::random_device{}());
+    ~BetaDecaySimulator();
     
     // Single beta decay simulations
     DecayEvent simulateBetaMinus(const Nucleus& parent, double qValue);
@@ -97,21 +153,55 @@ public:
     // General simulation function
     DecayEvent simulate(const Nucleus& parent, BetaDecayType type, double qValue);
     
+    // Append event eventId to batch without allocating (once the batch has
+    // grown). The event is a function of (seed, eventId) only, so any event
+    // of a run can be regenerated on its own. Returns false and appends
+    // nothing if the decay is not allowed for this Q value.
+    bool generate(const Nucleus& parent, BetaDecayType type, double qValue,
+                  std::int64_t eventId, DecayEventBatch& batch);
+    DecayEvent toDecayEvent(const DecayEventBatch::EventView& event, const Nucleus& parent) const;
+    
     // Utility functions
     double calculateHalfLife(double decayConstant) const;
     double generateDecayTime(double halfLife);
     bool canDecay(const Nucleus& parent, BetaDecayType type) const;
     
-    // Statistical analysis
+    // Statistical analysis. Events are generated in parallel on all cores
+    // (see setNumberOfThreads) and are reproducible for a given seed.
     std::vector<DecayEvent> runMultipleDecays(const Nucleus& parent, 
                                                BetaDecayType type, 
                                                double qValue, 
                                                int numEvents);
+    // Same events as columns
+    void runMultipleDecays(const Nucleus& parent, BetaDecayType type, double qValue,
+                           long long numEvents, DecayEventBatch& events);
     void analyzeEnergyDistribution(const std::vector<DecayEvent>& events) const;
+    
+    // Streaming variant for samples too large to store: every block of up
+    // to BLOCK_SIZE events is passed to sink(worker, batch) instead. The sink
+    // is called concurrently from numThreads workers with worker in
+    // [0, numThreads); the batch is reused for the worker's next block.
+    using BatchSink = std::function<void(int worker, const DecayEventBatch& batch)>;
+    void runDecays(const Nucleus& parent, BetaDecayType type, double qValue,
+                   long long numEvents, const BatchSink& sink);
+    
+    // Restart at event id 0 of a new seed. simulate() and the parallel runs
+    // take consecutive event ids, so a run of N events equals N calls of
+    // simulate() for any thread count.
+    void setSeed(std::uint64_t seed);
+    std::uint64_t getSeed() const { return random.GetSeed(); }
+    
+    // 0 (default) uses all hardware threads
+    void setNumberOfThreads(int n) { numThreads = n; }
+    int getNumberOfThreads() const;
 };
 
 /**
  * Helper class for nuclear data
+ *
+ * Masses, symbols and stability come from the compile-time NuclideTable:
+ * evaluated masses for the tabulated nuclides, the semi-empirical formula
+ * for the rest.
  */
 class NuclearData {
 public:
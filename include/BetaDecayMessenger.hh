@@ -0,0 +1,59 @@
+// include/BetaDecayMessenger.hh
+#ifndef BETADECAYMESSENGER_HH
+#define BETADECAYMESSENGER_HH
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class BetaDecayPrimaryGenerator;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithALongInt;
+class G4UIcmdWithABool;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWith3Vector;
+class G4UIcmdWith3VectorAndUnit;
+
+// UI commands for the primary generator under /betadecay/gun/ and
+// /betadecay/source/
+class BetaDecayMessenger : public G4UImessenger {
+public:
+    BetaDecayMessenger(BetaDecayPrimaryGenerator* generator);
+    virtual ~BetaDecayMessenger();
+    
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+    
+private:
+    BetaDecayPrimaryGenerator* fGenerator;
+    
+    G4UIdirectory* fDirectory;
+    G4UIcmdWithAnInteger* fValidateCmd;
+    G4UIcmdWithALongInt* fSeedCmd;
+    G4UIcmdWithABool* fStreamPerRunCmd;
+    G4UIcmdWithALongInt* fFirstEventCmd;
+    G4UIcmdWithABool* fReseedTransportCmd;
+    G4UIcmdWithAString* fIsotopeCmd;
+    G4UIcmdWithAString* fDecayModeCmd;
+    G4UIcmdWithADoubleAndUnit* fQValueCmd;
+    G4UIcmdWith3VectorAndUnit* fPositionCmd;
+    G4UIcmdWithAString* fTableCacheCmd;
+    G4UIcmdWithAString* fReplayCmd;
+    G4UIcmdWithALongInt* fReplayFirstCmd;
+    G4UIcmdWithAString* fBiasCmd;
+    G4UIcmdWith3Vector* fBiasAxisCmd;
+    G4UIcmdWithADoubleAndUnit* fBiasAngleCmd;
+    G4UIcmdWithADoubleAndUnit* fBiasMarginCmd;
+    G4UIcmdWithADouble* fBiasFractionCmd;
+    
+    G4UIdirectory* fSourceDirectory;
+    G4UIcommand* fSourceAddCmd;
+    G4UIcmdWithADoubleAndUnit* fSourceAgeCmd;
+    G4UIcmdWithoutParameter* fSourceClearCmd;
+    G4UIcmdWithoutParameter* fSourceListCmd;
+};
+
+#endif // BETADECAYMESSENGER_HH
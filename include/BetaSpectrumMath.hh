@@ -0,0 +1,48 @@
+// include/BetaSpectrumMath.hh
+#ifndef BETASPECTRUMMATH_HH
+#define BETASPECTRUMMATH_HH
+
+//==============================================================================
+// Allowed beta spectrum shape and Coulomb (Fermi) correction
+//
+// Plain functions of kinetic energy in MeV with no Geant4 dependency, so the
+// spectrum tables can be built and validated outside of a running kernel.
+// BetaDecayPhysics forwards to these.
+//==============================================================================
+
+#include <cstddef>
+
+namespace BetaSpectrumMath {
+    constexpr double ELECTRON_MASS = 0.510998928;   // MeV
+    constexpr double ALPHA = 1.0/137.035999;        // Fine structure constant
+    constexpr double COMPTON_WAVELENGTH = 386.159;  // hbar/(m_e c) in fm
+
+    // Relativistic Fermi function F(Z, T) including the finite nuclear
+    // radius term. Z is the charge of the daughter nucleus and is negative
+    // for positron emission. If A is 0 it is estimated from Z.
+    double FermiFunction(double kineticEnergy, int Z, int A = 0);
+
+    // Lepton factor F(Z, T) p W of the allowed spectra; finite at T = 0
+    double LeptonFactor(double kineticEnergy, int Z, int A = 0);
+
+    // Allowed spectrum shape dN/dT ~ F(Z, T) p W (Q - T)^2 (unnormalized)
+    double SpectrumShape(double kineticEnergy, double qValue, int Z, int A = 0);
+
+    // Batch versions over an energy grid: values[i] = f(kineticEnergy[i]).
+    // Per-Z constants are hoisted and the loop runs vectorized kernels
+    // (inline log/exp/atan and complex-gamma approximations). They agree with
+    // the scalar functions to ~1e-13 relative, degrading towards 1e-9 only in
+    // the first 1e-4 of the spectrum where pi*eta and ln|Gamma| cancel.
+    void FermiFunction(const double* kineticEnergy, double* values, std::size_t n,
+                       int Z, int A = 0);
+    void SpectrumShape(const double* kineticEnergy, double* values, std::size_t n,
+                       double qValue, int Z, int A = 0);
+
+    // ln|Gamma(x + iy)| for x > 0
+    double LogAbsGamma(double x, double y);
+
+    // Mass number on the valley of stability for a given Z
+    int EstimateMassNumber(int Z);
+}
+
+#endif // BETASPECTRUMMATH_HH
@@ -0,0 +1,107 @@
+// include/BetaSpectrumTable.hh
+#ifndef BETASPECTRUMTABLE_HH
+#define BETASPECTRUMTABLE_HH
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+// Tabulated beta spectrum with O(1) sampling
+//
+// The analytic shape is evaluated once on a uniform kinetic energy grid.
+// A Walker alias table picks a bin from the trapezoid bin weights and the
+// energy inside the bin is drawn from the linear interpolant of the shape,
+// so a draw costs two uniforms and no rejection loop.
+//
+// Tables are immutable after construction. Get() returns a process-wide
+// cached instance per (Z, Q, lepton) that worker threads share read-only.
+//==============================================================================
+
+class BetaSpectrumTable {
+public:
+    enum class Lepton { Electron, Positron };
+
+    struct ValidationResult {
+        std::size_t nSamples = 0;
+        int nBins = 0;
+        int ndf = 0;
+        double chi2 = 0.0;
+        double maxPull = 0.0;   // Largest |obs - exp|/sqrt(exp) over bins
+        double maxPullEnergy = 0.0;
+    };
+
+    static constexpr std::size_t DEFAULT_BINS = 2048;
+
+    // Z is the charge of the daughter nucleus, qValue the endpoint in MeV
+    BetaSpectrumTable(int Z, double qValue, Lepton lepton,
+                      std::size_t nBins = DEFAULT_BINS);
+
+    // Shared cached table. When validation is enabled, the first caller to
+    // fetch a table not yet validated runs the check and receives the result
+    // in validation; every other caller sees validation->nSamples == 0.
+    static std::shared_ptr<const BetaSpectrumTable>
+    Get(int Z, double qValue, Lepton lepton, ValidationResult* validation = nullptr);
+
+    // When nSamples > 0, every table handed out by Get() is validated once
+    static void SetValidationSamples(std::size_t nSamples);
+    static std::size_t GetValidationSamples();
+
+    // Kinetic energy in MeV from two independent uniforms in [0, 1)
+    double Sample(double u1, double u2) const {
+        const double x = u1*fNBins;
+        std::size_t bin = static_cast<std::size_t>(x);
+        if (bin >= fNBins) bin = fNBins - 1;
+        if (x - bin >= fProbability[bin]) bin = fAlias[bin];
+
+        const double f0 = fEdgeDensity[bin];
+        const double f1 = fEdgeDensity[bin + 1];
+        const double df = f1 - f0;
+        double t = u2;
+        if (std::abs(df) > 1.0e-9*(f0 + f1)) {
+            t = (std::sqrt(f0*f0 + (f1*f1 - f0*f0)*u2) - f0)/df;
+        }
+        return (bin + t)*fBinWidth;
+    }
+
+    // Bulk version: energies[i] = Sample(u[2i], u[2i+1]) for i < n, e.g. from
+    // CounterRandom::Fill(u, 2*n)
+    void Sample(const double* u, double* energies, std::size_t n) const;
+
+    // Histogram nSamples draws against the analytic shape integrated per bin
+    ValidationResult Validate(std::size_t nSamples, int nBins = 100,
+                              std::uint64_t seed = 12345) const;
+
+    // Normalized analytic density at kinetic energy T (MeV)
+    double Density(double kineticEnergy) const;
+
+    // Walker/Vose alias table for sampling an index with the given weights:
+    // index i, accepted if the fractional part of u*n is below
+    // probability[i], else alias[i]. Shared with DoubleBetaSpectrumTable.
+    static void BuildAliasTable(const std::vector<double>& weights,
+                                std::vector<double>& probability,
+                                std::vector<std::uint32_t>& alias);
+
+    int GetZ() const { return fZ; }
+    double GetQValue() const { return fQValue; }
+    Lepton GetLepton() const { return fLepton; }
+    std::size_t GetNumberOfBins() const { return fNBins; }
+
+private:
+    double Shape(double kineticEnergy) const;
+
+    int fZ;
+    double fQValue;
+    Lepton fLepton;
+    std::size_t fNBins;
+    double fBinWidth;
+    double fNormalization;
+
+    std::vector<double> fEdgeDensity;      // Shape at the nBins+1 bin edges
+    std::vector<double> fProbability;      // Alias acceptance per bin
+    std::vector<std::uint32_t> fAlias;     // Alias bin per bin
+};
+
+#endif // BETASPECTRUMTABLE_HH
@@ -0,0 +1,168 @@
+// include/Checkpoint.hh
+#ifndef CHECKPOINT_HH
+#define CHECKPOINT_HH
+
+#include "AsyncEventWriter.hh"
+#include "Counters.hh"
+#include "Histogram.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+// Checkpoints of long runs
+//
+// With the transport reseeded from the event's stream, an event depends
+// only on the seed and its global id. The state of a run is therefore the
+// set of finished event ids and what they added up: counters, histograms
+// and the records in the event file, up to a known offset. A checkpoint
+// saves these; a resumed job runs the missing ids only and continues the
+// event file.
+//
+// Taking a checkpoint does not stop the run. Every interval the
+// Coordinator's thread raises a request; each simulation thread answers at
+// the end of its current event with a copy of its own totals and finished
+// ids, after flushing its output records. The coordinator adds the
+// snapshots up and writes the files while the threads carry on, so a
+// thread only pays for one copy of its totals and one flush per interval.
+// Records of events finished after a thread's snapshot may already be in
+// the file before the recorded offset; a resume drops them
+// (PrepareEventFile).
+//==============================================================================
+
+namespace Checkpoint {
+    constexpr const char* HEADER = "# BetaDecay checkpoint";
+    constexpr unsigned VERSION = 1;
+    constexpr const char* EXTENSION = ".bdckpt";
+    
+    // Sorted, disjoint half-open ranges [first, last) of event ids
+    class EventRanges {
+    public:
+        typedef std::pair<std::int64_t, std::int64_t> Range;
+    
+        // Constant time when the ids come in increasing order, as they do
+        // on each thread
+        void Add(std::int64_t id);
+        void Add(const Range& range);
+        void Merge(const EventRanges& other);
+        void Clear() { fRanges.clear(); }
+    
+        bool Contains(std::int64_t id) const;
+        std::uint64_t Count() const;
+        // The ids of [first, last) that are not in these ranges
+        EventRanges Complement(std::int64_t first, std::int64_t last) const;
+        // The n-th id; past Count() the ids continue after the last range.
+        // A linear scan: the ranges left to run after a checkpoint are few
+        // (about two per thread).
+        std::int64_t Select(std::uint64_t n) const;
+    
+        bool IsEmpty() const { return fRanges.empty(); }
+        const std::vector<Range>& GetRanges() const { return fRanges; }
+    
+    private:
+        std::vector<Range> fRanges;
+    };
+    
+    struct State {
+        std::int32_t runId = 0;
+        std::int64_t events = 0;             // Events of the run, finished or not
+        EventRanges done;                    // Global ids of the finished events
+        std::string eventFile;               // Empty without event output
+        bool binaryEvents = false;
+        EventFile::AsyncEventWriter::Position eventPosition;
+        CounterSet counters;
+        HistogramSet histograms;
+        unsigned slot = 0;                   // Of the counter and histogram files
+        std::uint32_t resumes = 0;           // Times the event file was rebuilt
+    };
+    
+    // The counters and histograms go to <path>.<slot>.bdsum and .bdhist,
+    // then <path> is replaced atomically. Successive checkpoints alternate
+    // the slot, so an interruption leaves the previous checkpoint intact.
+    // Throw std::runtime_error on I/O failure or a malformed file.
+    void Write(const std::string& path, const State& state);
+    State Read(const std::string& path);
+    bool Exists(const std::string& path);
+    void Remove(const std::string& path);
+    
+    // Rebuilds the event file of a checkpoint for the resumed job: the
+    // records of finished events before the checkpoint offset, as a
+    // complete binary file or text without its summary, to be continued by
+    // an AsyncEventWriter in append mode. The checkpoint at path is then
+    // replaced by state, updated for the rebuilt file. The original is kept
+    // as <file>.resume<n> until then, so that an interrupted resume can be
+    // resumed again. Returns the records kept.
+    std::uint64_t PrepareEventFile(const std::string& path, State& state);
+    
+    class Coordinator {
+    public:
+        // One simulation thread's totals since the start of the run
+        struct Snapshot {
+            CounterSet counters;
+            HistogramSet histograms;
+            EventRanges done;
+        };
+    
+        Coordinator();
+        ~Coordinator();
+    
+        Coordinator(const Coordinator&) = delete;
+        Coordinator& operator=(const Coordinator&) = delete;
+    
+        // Starts the checkpoint thread of a run. base describes the run and
+        // holds what earlier jobs finished (a resumed run); writer is the
+        // run's event output or nullptr. A new run (no finished events)
+        // first removes a checkpoint left at path.
+        void Start(const std::string& path, const State& base, double interval,
+                   const EventFile::AsyncEventWriter* writer);
+        // Stops the thread after the checkpoint being written, if any
+        void Stop();
+        bool IsActive() const { return fActive.load(std::memory_order_relaxed); }
+    
+        // Simulation threads register before their first event. When
+        // GetRequest() changes they answer with their snapshot at the end of
+        // the event; the final snapshot, at the end of the thread's run,
+        // also answers every later request.
+        void Register(int thread);
+        std::uint32_t GetRequest() const { return fRequest.load(std::memory_order_relaxed); }
+        void Submit(int thread, std::uint32_t request, Snapshot snapshot, bool final);
+    
+        std::uint32_t GetNumberOfCheckpoints() const;
+        // Message of the last failed write, empty if none
+        std::string GetError() const;
+    
+    private:
+        struct Slot {
+            std::uint32_t answered = 0;
+            bool final = false;
+            Snapshot snapshot;
+        };
+    
+        void Loop();
+        bool Answered(std::uint32_t request) const;
+    
+        std::string fPath;
+        State fBase;
+        double fInterval;
+        const EventFile::AsyncEventWriter* fWriter;
+    
+        mutable std::mutex fMutex;
+        std::condition_variable fWake;
+        std::map<int, Slot> fSlots;
+        std::atomic<bool> fActive;
+        std::atomic<std::uint32_t> fRequest;
+        bool fStopping;
+        std::uint32_t fCheckpoints;
+        std::string fError;
+        std::thread fThread;
+    };
+}
+
+#endif // CHECKPOINT_HH
@@ -0,0 +1,94 @@
+// include/CounterRandom.hh
+#ifndef COUNTERRANDOM_HH
+#define COUNTERRANDOM_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+//==============================================================================
+// Counter-based random numbers (Philox4x32-10)
+//
+// Every draw is a pure function of (seed, stream, index): the 64-bit seed is
+// the Philox key, the stream (typically the event id) and the draw index form
+// the 128-bit counter. There is no state beyond the position in the stream,
+// so an event keyed by its id gives the same numbers whichever thread runs
+// it and in whatever order, and can be regenerated on its own.
+//
+// One Philox block yields four 32-bit words, i.e. two 53-bit doubles.
+// Uniform() serves them one at a time; Fill() generates whole blocks in a
+// loop the compiler can vectorize. Both walk the same sequence, so scalar
+// and bulk draws can be mixed freely.
+//
+// Also meets UniformRandomBitGenerator (64-bit output), so it can drive the
+// <random> distributions.
+//==============================================================================
+
+class CounterRandom {
+public:
+    using result_type = std::uint64_t;
+
+    explicit CounterRandom(std::uint64_t seed = 0, std::uint64_t stream = 0) {
+        SetStream(seed, stream);
+    }
+
+    // Restart at the first draw of (seed, stream)
+    void SetStream(std::uint64_t seed, std::uint64_t stream) {
+        fSeed = seed;
+        SetStream(stream);
+    }
+    void SetStream(std::uint64_t stream) {
+        fStream = stream;
+        fBlock = 0;
+        fBuffered = 0;
+    }
+
+    std::uint64_t GetSeed() const { return fSeed; }
+
+    // Seed of an independent family of streams of seed, e.g. one per run,
+    // so that the stream can stay the full 64-bit event id. Family 0 is
+    // the seed itself.
+    static std::uint64_t FamilySeed(std::uint64_t seed, std::uint64_t family);
+    std::uint64_t GetStream() const { return fStream; }
+
+    // Uniform double in [0, 1) with 53 random bits
+    double Uniform() {
+        return static_cast<double>(Next() >> 11)*(1.0/9007199254740992.0);   // 2^-53
+    }
+
+    // 64 random bits
+    std::uint64_t Next() {
+        if (fBuffered == 0) {
+            Block(fBlock++, fBuffer);
+            fBuffered = 2;
+        }
+        return fBuffer[2 - fBuffered--];
+    }
+
+    result_type operator()() { return Next(); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    // Bulk draws: n uniforms in [0, 1)
+    void Fill(double* u, std::size_t n);
+
+    // n isotropic unit vectors as separate columns, from 2n uniforms (n for
+    // cos(theta), then n for phi)
+    void FillDirections(double* x, double* y, double* z, std::size_t n);
+
+    // The Philox4x32-10 bijection on one 128-bit counter
+    static void Philox(const std::uint32_t key[2], const std::uint32_t counter[4],
+                       std::uint32_t result[4]);
+
+private:
+    // Two 64-bit outputs of block number `block` of the current stream
+    void Block(std::uint64_t block, std::uint64_t out[2]) const;
+
+    std::uint64_t fSeed;
+    std::uint64_t fStream;
+    std::uint64_t fBlock;        // Next block to generate
+    std::uint64_t fBuffer[2];
+    int fBuffered;               // Outputs of fBuffer not yet returned
+};
+
+#endif // COUNTERRANDOM_HH
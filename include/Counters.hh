@@ -0,0 +1,64 @@
+// include/Counters.hh
+#ifndef COUNTERS_HH
+#define COUNTERS_HH
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Named run counters
+//
+// The end-of-run totals (events, energy sums, deposits per volume and
+// species, hit counts, per-crystal sums, ...) as named arrays of doubles.
+// Every counter is a sum over events, so merging runs is an elementwise
+// add; integer counts stay exact up to 2^53.
+//
+// A CounterSet is saved as a small text file (.bdsum, see CounterFile)
+// next to the event and histogram files, so that separately run jobs can
+// be combined afterwards (BetaDecayMerge).
+//==============================================================================
+
+class CounterSet {
+public:
+    void Set(const std::string& name, double value) { fCounters[name].assign(1, value); }
+    void Set(const std::string& name, const std::vector<double>& values) { fCounters[name] = values; }
+    
+    // nullptr if there is no counter of that name
+    const std::vector<double>* Find(const std::string& name) const;
+    // Element index of a counter, 0 if absent
+    double Get(const std::string& name, std::size_t index = 0) const;
+    
+    // Adds other elementwise; counters missing here are added, shorter
+    // arrays are extended with zeros
+    void Merge(const CounterSet& other);
+    
+    bool IsEmpty() const { return fCounters.empty(); }
+    const std::map<std::string, std::vector<double>>& GetCounters() const { return fCounters; }
+
+private:
+    std::map<std::string, std::vector<double>> fCounters;
+};
+
+//==============================================================================
+// Counter file
+//
+//   # BetaDecay counters <version>
+//   <name> <n> <value 1> ... <value n>
+//
+// one line per counter, values with 17 significant digits so that they
+// read back exactly.
+//==============================================================================
+
+namespace CounterFile {
+    constexpr const char* HEADER = "# BetaDecay counters";
+    constexpr unsigned VERSION = 1;
+    constexpr const char* EXTENSION = ".bdsum";
+    
+    // Throw std::runtime_error on I/O failure or a malformed file
+    void Write(const std::string& path, const CounterSet& counters);
+    CounterSet Read(const std::string& path);
+}
+
+#endif // COUNTERS_HH
@@ -0,0 +1,185 @@
+// include/DecayEventBatch.hh
+#ifndef DECAYEVENTBATCH_HH
+#define DECAYEVENTBATCH_HH
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+//==============================================================================
+// Batch of decay events stored as structure-of-arrays
+//
+// Event columns (one entry per event) and particle columns (one entry per
+// decay product) live in flat vectors; fParticleOffset[i] .. [i+1] is the
+// particle range of event i. Particles are identified by a small enum
+// instead of a name string, and only the momentum is stored: the direction
+// is derived from it on demand.
+//
+// Clear() keeps the capacity, so a batch that is reused for every block of
+// events stops allocating once it has grown to the block size. EventView and
+// ParticleView give per-event read access for code written against the
+// DecayEvent structs.
+//
+// The decay type is stored as an opaque code (the caller's enum value), so
+// this header depends on neither BetaDecay.hh nor BetaDecayConsole.h.
+//==============================================================================
+
+class DecayEventBatch {
+public:
+    enum class ParticleType : std::uint8_t {
+        Electron, Positron, Neutrino, AntiNeutrino, Gamma, Recoil
+    };
+
+    // Geant4 particle name and PDG code (0 for the recoiling nucleus)
+    static const char* GetParticleName(ParticleType type);
+    static std::int32_t GetPDGCode(ParticleType type);
+
+    class ParticleView {
+    public:
+        ParticleView(const DecayEventBatch& batch, std::size_t index)
+            : fBatch(&batch), fIndex(index) {}
+
+        ParticleType GetType() const { return fBatch->fType[fIndex]; }
+        const char* GetName() const { return GetParticleName(GetType()); }
+        double GetEnergy() const { return fBatch->fEnergy[fIndex]; }
+        double GetPx() const { return fBatch->fPx[fIndex]; }
+        double GetPy() const { return fBatch->fPy[fIndex]; }
+        double GetPz() const { return fBatch->fPz[fIndex]; }
+        double GetMomentum() const {
+            return std::sqrt(GetPx()*GetPx() + GetPy()*GetPy() + GetPz()*GetPz());
+        }
+        // Unit vector along the momentum (zero for a particle at rest)
+        void GetDirection(double direction[3]) const;
+
+    private:
+        const DecayEventBatch* fBatch;
+        std::size_t fIndex;
+    };
+
+    class EventView {
+    public:
+        EventView(const DecayEventBatch& batch, std::size_t index)
+            : fBatch(&batch), fIndex(index) {}
+
+        std::int64_t GetEventId() const { return fBatch->fEventId[fIndex]; }
+        std::uint8_t GetDecayType() const { return fBatch->fDecayType[fIndex]; }
+        double GetQValue() const { return fBatch->fQValue[fIndex]; }
+        int GetDaughterZ() const { return fBatch->fDaughterZ[fIndex]; }
+        int GetDaughterA() const { return fBatch->fDaughterA[fIndex]; }
+
+        std::size_t GetNumberOfParticles() const {
+            return fBatch->fParticleOffset[fIndex + 1] - fBatch->fParticleOffset[fIndex];
+        }
+        ParticleView GetParticle(std::size_t i) const {
+            return ParticleView(*fBatch, fBatch->fParticleOffset[fIndex] + i);
+        }
+        // Index range into the particle columns
+        std::size_t GetFirstParticle() const { return fBatch->fParticleOffset[fIndex]; }
+        std::size_t GetLastParticle() const { return fBatch->fParticleOffset[fIndex + 1]; }
+
+        // Sum of the kinetic energies of all products
+        double GetTotalEnergy() const;
+        // Sum of the kinetic energies of electrons and positrons
+        double GetVisibleEnergy() const;
+
+    private:
+        const DecayEventBatch* fBatch;
+        std::size_t fIndex;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = EventView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = EventView;
+
+        Iterator(const DecayEventBatch& batch, std::size_t index) : fBatch(&batch), fIndex(index) {}
+        EventView operator*() const { return EventView(*fBatch, fIndex); }
+        Iterator& operator++() { ++fIndex; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++fIndex; return old; }
+        bool operator==(const Iterator& other) const { return fIndex == other.fIndex; }
+        bool operator!=(const Iterator& other) const { return fIndex != other.fIndex; }
+
+    private:
+        const DecayEventBatch* fBatch;
+        std::size_t fIndex;
+    };
+
+    DecayEventBatch() { fParticleOffset.push_back(0); }
+
+    // Drop all events, keep the capacity
+    void Clear();
+    void Reserve(std::size_t nEvents, std::size_t nParticles);
+
+    // Start a new event; particles added afterwards belong to it
+    void BeginEvent(std::int64_t eventId, std::uint8_t decayType, double qValue,
+                    int daughterZ, int daughterA) {
+        fEventId.push_back(eventId);
+        fDecayType.push_back(decayType);
+        fQValue.push_back(qValue);
+        fDaughterZ.push_back(daughterZ);
+        fDaughterA.push_back(daughterA);
+        fParticleOffset.push_back(fParticleOffset.back());
+    }
+
+    // Append a particle to the current event, returns its particle index
+    std::size_t AddParticle(ParticleType type, double energy, double px, double py, double pz) {
+        fType.push_back(type);
+        fEnergy.push_back(energy);
+        fPx.push_back(px);
+        fPy.push_back(py);
+        fPz.push_back(pz);
+        return fParticleOffset.back()++;
+    }
+
+    // Remove the current event and its particles (e.g. a rejected decay)
+    void DiscardEvent();
+
+    // Append all events of another batch
+    void Append(const DecayEventBatch& other);
+
+    std::size_t GetNumberOfEvents() const { return fEventId.size(); }
+    std::size_t GetNumberOfParticles() const { return fType.size(); }
+    bool IsEmpty() const { return fEventId.empty(); }
+
+    EventView operator[](std::size_t i) const { return EventView(*this, i); }
+    Iterator begin() const { return Iterator(*this, 0); }
+    Iterator end() const { return Iterator(*this, GetNumberOfEvents()); }
+
+    // Column access for vectorized consumers
+    const std::int64_t* GetEventIds() const { return fEventId.data(); }
+    const std::uint8_t* GetDecayTypes() const { return fDecayType.data(); }
+    const double* GetQValues() const { return fQValue.data(); }
+    const std::uint32_t* GetParticleOffsets() const { return fParticleOffset.data(); }
+    const ParticleType* GetParticleTypes() const { return fType.data(); }
+    const double* GetEnergies() const { return fEnergy.data(); }
+    const double* GetPx() const { return fPx.data(); }
+    const double* GetPy() const { return fPy.data(); }
+    const double* GetPz() const { return fPz.data(); }
+
+    // Mutable particle columns, for in-place kinematic corrections
+    double* GetEnergies() { return fEnergy.data(); }
+    double* GetPx() { return fPx.data(); }
+    double* GetPy() { return fPy.data(); }
+    double* GetPz() { return fPz.data(); }
+
+private:
+    // Event columns
+    std::vector<std::int64_t> fEventId;
+    std::vector<std::uint8_t> fDecayType;
+    std::vector<double> fQValue;
+    std::vector<std::int32_t> fDaughterZ;
+    std::vector<std::int32_t> fDaughterA;
+    std::vector<std::uint32_t> fParticleOffset;   // nEvents + 1 entries
+
+    // Particle columns
+    std::vector<ParticleType> fType;
+    std::vector<double> fEnergy;                  // Kinetic energy, MeV
+    std::vector<double> fPx, fPy, fPz;            // MeV/c
+};
+
+#endif // DECAYEVENTBATCH_HH
@@ -2,15 +2,113 @@
 #define DetectorConstruction_h
 
 #include <G4VUserDetectorConstruction.hh>
+#include "G4ThreeVector.hh"
+#include "G4VTouchable.hh"
+#include "globals.hh"
 
 class G4VPhysicalVolume;
+class G4LogicalVolume;
+class DetectorMessenger;
+class ElectronFastModel;
+
+//==============================================================================
+// Source and segmented detector array
+//
+// The detector is an nx x ny grid of identical crystals with a common pitch,
+// centred on the z axis at the given distance from the source (the default
+// is the single 10 cm NaI crystal). The grid is never built from individual
+// placements; memory and navigation cost do not grow with the crystal count:
+//
+//   REPLICA        envelope -> nx column replicas (x) -> ny cell replicas
+//                  (y) -> crystal; the navigator computes the cell index
+//   PARAMETERISED  envelope -> one G4PVParameterised crystal with nx*ny
+//                  copies, located through the envelope's smart voxels
+//
+// The source and the array envelope are the cut regions "Source" and
+// "Detector" (see PhysicsList). Crystals are numbered ix*ny + iy. All
+// crystals share one logical volume (GetDetectorVolume); GetCrystalIndex
+// recovers the number from the copy numbers of the step's touchable. The
+// settings are changed with /betadecay/detector/ and rebuild the geometry
+// before the next run.
+//
+// The Detector region carries the ElectronFastModel of every thread, off
+// unless enabled with /betadecay/fastsim/ (FastSimSettings; no rebuild).
+//==============================================================================
 
 class DetectorConstruction : public G4VUserDetectorConstruction {
 public:
+    enum class Layout { REPLICA, PARAMETERISED };
+    
+    struct ArraySettings {
+        G4int nx;
+        G4int ny;
+        G4double pitch;               // Centre-to-centre distance in x and y
+        G4ThreeVector crystalSize;    // Full lengths; x and y at most the pitch
+        G4String material;            // NIST material name
+        G4double distance;            // Array centre on the z axis
+        Layout layout;
+        G4double smartless;           // Smart voxels per daughter (Geant4 default 2)
+        G4bool optimise;              // Smart voxels for the array volumes
+    
+        ArraySettings();
+    };
+    
+    struct FastSimSettings {
+        G4bool enabled;
+        G4double threshold;           // e-/e+ below it are absorbed locally
+        G4bool leakage;               // Bremsstrahlung leaves as a photon
+        G4bool annihilation;          // e+ annihilate into two photons
+    
+        FastSimSettings();
+    };
+    
     DetectorConstruction();
     virtual ~DetectorConstruction();
-
+    
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField();
+    
+    // Scoring volumes, valid after Construct()
+    const G4LogicalVolume* GetSourceVolume() const { return fSourceVolume; }
+    const G4LogicalVolume* GetDetectorVolume() const { return fDetectorVolume; }
+    
+    // Incremented by every Construct(), so that cached volumes can be checked
+    G4int GetGeometryVersion() const { return fGeometryVersion; }
+    
+    // Array of the current geometry
+    const ArraySettings& GetArray() const { return fBuilt; }
+    G4int GetNumberOfCrystals() const { return fBuilt.nx*fBuilt.ny; }
+    
+    // Crystal number of a touchable inside the detector volume: depth 0 is
+    // the crystal, 1 the cell replica (iy) and 2 the column replica (ix)
+    G4int GetCrystalIndex(const G4VTouchable* touchable) const {
+        if (fBuilt.layout == Layout::PARAMETERISED) return touchable->GetCopyNumber(0);
+        return touchable->GetReplicaNumber(2)*fBuilt.ny + touchable->GetReplicaNumber(1);
+    }
+    
+    // Settings for the next Construct(); changing them after the geometry
+    // is built rebuilds it before the next run
+    const ArraySettings& GetArraySettings() const { return fSettings; }
+    void SetArraySettings(const ArraySettings& settings);
+    
+    // Read by the fast-simulation models of all threads; change it only
+    // between runs
+    const FastSimSettings& GetFastSimSettings() const { return fFastSim; }
+    void SetFastSimSettings(const FastSimSettings& settings) { fFastSim = settings; }
+
+private:
+    void BuildReplicaArray(G4LogicalVolume* envelope, G4LogicalVolume* crystal);
+    void BuildParameterisedArray(G4LogicalVolume* envelope, G4LogicalVolume* crystal);
+    
+    G4LogicalVolume* fSourceVolume;
+    G4LogicalVolume* fDetectorVolume;
+    G4int fGeometryVersion;
+    
+    ArraySettings fSettings;      // Requested
+    ArraySettings fBuilt;         // Of the current geometry
+    FastSimSettings fFastSim;
+    static G4ThreadLocal ElectronFastModel* fFastModel;
+    DetectorMessenger* fMessenger;
 };
 
 #endif
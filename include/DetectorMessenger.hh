@@ -0,0 +1,49 @@
+// include/DetectorMessenger.hh
+#ifndef DETECTORMESSENGER_HH
+#define DETECTORMESSENGER_HH
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class DetectorConstruction;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWith3VectorAndUnit;
+
+// UI commands for the detector array under /betadecay/detector/ and the
+// crystal fast simulation under /betadecay/fastsim/. The detector is shared
+// by all threads, so the commands run on the master only; an array change
+// rebuilds the geometry before the next run.
+class DetectorMessenger : public G4UImessenger {
+public:
+    DetectorMessenger(DetectorConstruction* detector);
+    virtual ~DetectorMessenger();
+    
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+    virtual G4String GetCurrentValue(G4UIcommand* command);
+
+private:
+    DetectorConstruction* fDetector;
+    
+    G4UIdirectory* fDirectory;
+    G4UIcommand* fArraySizeCmd;
+    G4UIcmdWithADoubleAndUnit* fPitchCmd;
+    G4UIcmdWith3VectorAndUnit* fCrystalSizeCmd;
+    G4UIcmdWithAString* fMaterialCmd;
+    G4UIcmdWithADoubleAndUnit* fDistanceCmd;
+    G4UIcmdWithAString* fLayoutCmd;
+    G4UIcmdWithADouble* fSmartlessCmd;
+    G4UIcmdWithABool* fOptimiseCmd;
+    
+    G4UIdirectory* fFastSimDirectory;
+    G4UIcmdWithABool* fFastSimEnableCmd;
+    G4UIcmdWithADoubleAndUnit* fThresholdCmd;
+    G4UIcmdWithABool* fLeakageCmd;
+    G4UIcmdWithABool* fAnnihilationCmd;
+};
+
+#endif // DETECTORMESSENGER_HH
@@ -0,0 +1,141 @@
+// include/DoubleBetaSpectrumTable.hh
+#ifndef DOUBLEBETASPECTRUMTABLE_HH
+#define DOUBLEBETASPECTRUMTABLE_HH
+
+#include "BetaSpectrumMath.hh"
+#include "BetaSpectrumTable.hh"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Tabulated double beta spectrum with O(1) sampling
+//
+// Primakoff-Rosen approximation with f = F(Z, T) p W:
+//
+//   2nu  dN/dT1 dT2 ~ f(T1) f(T2) (Q - T1 - T2)^5
+//   0nu  dN/dT1     ~ f(T1) f(Q - T1),  T2 = Q - T1
+//
+// The 2nu triangle T1 + T2 <= Q is cut into an nBins x nBins grid of cells
+// (the 0nu line into nBins cells). The cell integrals are computed once and
+// a Walker alias table picks a cell; the point is uniform inside it, with
+// the cells on the diagonal T1 + T2 = Q folded onto their allowed half. A
+// draw costs three uniforms and no rejection loop.
+//
+// The electrons are emitted with the angular correlation
+// 1 - beta1 beta2 cos(theta) of 0+ -> 0+ transitions; SampleCosTheta
+// inverts its distribution function.
+//
+// Tables are immutable. Get() returns a process-wide instance per (Z, Q,
+// mode, lepton). With a cache directory (none by default), a table is
+// written there when it is first built, and later runs and other processes
+// map the file read-only instead of rebuilding it. A mapped file is checked
+// in full (about 1 MB) before use.
+//==============================================================================
+
+class DoubleBetaSpectrumTable {
+public:
+    enum class Mode { TwoNeutrino, Neutrinoless };
+    using Lepton = BetaSpectrumTable::Lepton;
+
+    static constexpr std::size_t DEFAULT_BINS = 256;
+
+    // Z is the charge of the daughter nucleus, qValue the kinetic energy
+    // shared by the leptons in MeV
+    DoubleBetaSpectrumTable(int Z, double qValue, Mode mode, Lepton lepton,
+                            std::size_t nBins = DEFAULT_BINS);
+    // Maps a file written by Write(); throws std::runtime_error if it cannot
+    // be read or is not a table file
+    explicit DoubleBetaSpectrumTable(const std::string& path);
+    ~DoubleBetaSpectrumTable();
+
+    DoubleBetaSpectrumTable(const DoubleBetaSpectrumTable&) = delete;
+    DoubleBetaSpectrumTable& operator=(const DoubleBetaSpectrumTable&) = delete;
+
+    // Shared cached table, mapped from or written to the cache directory
+    // when there is one
+    static std::shared_ptr<const DoubleBetaSpectrumTable>
+    Get(int Z, double qValue, Mode mode, Lepton lepton);
+
+    // Directory of the table files; empty keeps the tables in memory only
+    static void SetCacheDirectory(const std::string& directory);
+    static std::string GetCacheDirectory();
+    // File name of a table inside the cache directory
+    static std::string CacheFileName(int Z, double qValue, Mode mode, Lepton lepton,
+                                     std::size_t nBins = DEFAULT_BINS);
+
+    // Throws std::runtime_error on I/O failure
+    void Write(const std::string& path) const;
+
+    // Kinetic energies in MeV from three independent uniforms in [0, 1)
+    // (the third is not used in the 0nu mode)
+    void Sample(double u1, double u2, double u3, double& t1, double& t2) const {
+        const double x = u1*fNCells;
+        std::size_t cell = static_cast<std::size_t>(x);
+        if (cell >= fNCells) cell = fNCells - 1;
+        if (x - cell >= fProbability[cell]) cell = fAlias[cell];
+
+        if (fMode == Mode::Neutrinoless) {
+            t1 = (cell + u2)*fBinWidth;
+            t2 = fQValue - t1;
+            return;
+        }
+        const std::size_t i = cell/fNBins;
+        const std::size_t j = cell%fNBins;
+        double a = u2;
+        double b = u3;
+        if (i + j + 1 == fNBins && a + b > 1.0) {
+            a = 1.0 - a;
+            b = 1.0 - b;
+        }
+        t1 = (i + a)*fBinWidth;
+        t2 = (j + b)*fBinWidth;
+    }
+
+    // Cosine of the opening angle of two leptons with kinetic energies t1
+    // and t2 (MeV) from a uniform in [0, 1)
+    static double SampleCosTheta(double t1, double t2, double u) {
+        const double a = Velocity(t1)*Velocity(t2);
+        if (a < 1.0e-6) return 2.0*u - 1.0;
+        return (1.0 - std::sqrt(1.0 + a*(2.0 + a - 4.0*u)))/a;
+    }
+
+    int GetZ() const { return fZ; }
+    double GetQValue() const { return fQValue; }
+    Mode GetMode() const { return fMode; }
+    Lepton GetLepton() const { return fLepton; }
+    std::size_t GetNumberOfBins() const { return fNBins; }
+    // True if the cells come from a mapped cache file
+    bool IsMapped() const { return fMapping != nullptr; }
+
+private:
+    // v/c of an electron of kinetic energy T (MeV)
+    static double Velocity(double kineticEnergy) {
+        const double mass = BetaSpectrumMath::ELECTRON_MASS;
+        return std::sqrt(kineticEnergy*(kineticEnergy + 2.0*mass))/(kineticEnergy + mass);
+    }
+
+    void BuildCells();
+
+    int fZ;
+    double fQValue;
+    Mode fMode;
+    Lepton fLepton;
+    std::size_t fNBins;
+    std::size_t fNCells;
+    double fBinWidth;
+
+    // Point either into the vectors or into the mapped file
+    const double* fProbability;
+    const std::uint32_t* fAlias;
+    std::vector<double> fOwnedProbability;
+    std::vector<std::uint32_t> fOwnedAlias;
+    void* fMapping;
+    std::size_t fMappingSize;
+};
+
+#endif // DOUBLEBETASPECTRUMTABLE_HH
@@ -0,0 +1,54 @@
+// include/ElectronFastModel.hh
+#ifndef ELECTRONFASTMODEL_HH
+#define ELECTRONFASTMODEL_HH
+
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+class DetectorConstruction;
+class G4Material;
+
+//==============================================================================
+// Local absorption of low-energy electrons and positrons in the crystals
+//
+// Attached to the Detector region (the array envelope). An e- or e+ below
+// the threshold inside a crystal is ended in a single step: its kinetic
+// energy is deposited at the current point and scored by SteppingAction like
+// any other step, instead of being tracked down to the production cut.
+// Optionally
+//
+//   leakage       the bremsstrahlung fraction Y(E) = aZE/(1 + aZE), with
+//                 a = 6e-4/MeV and Z the mean atomic number of the crystal,
+//                 leaves as one photon along the electron direction and is
+//                 tracked normally (it may still be absorbed)
+//   annihilation  a positron is replaced by two back-to-back 511 keV photons
+//                 from the stopping point; without it the annihilation
+//                 energy is lost
+//
+// The settings are DetectorConstruction::FastSimSettings, read at every
+// trigger, so /betadecay/fastsim/ changes apply from the next run. Models
+// are thread-local: every worker builds its own in ConstructSDandField.
+//==============================================================================
+
+class ElectronFastModel : public G4VFastSimulationModel {
+public:
+    ElectronFastModel(const G4String& name, G4Region* envelope, const DetectorConstruction* detector);
+    virtual ~ElectronFastModel();
+    
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+    
+    // Fraction of the kinetic energy of an electron stopping in a material
+    // of atomic number z that is radiated (Koch and Motz approximation)
+    static G4double RadiativeYield(G4double energy, G4double z);
+
+private:
+    G4double GetMeanZ(const G4Material* material);
+    
+    const DetectorConstruction* fDetector;
+    const G4Material* fMaterial;   // Material of fMeanZ
+    G4double fMeanZ;
+};
+
+#endif // ELECTRONFASTMODEL_HH
@@ -0,0 +1,58 @@
+// include/EnergyDeposit.hh
+#ifndef ENERGYDEPOSIT_HH
+#define ENERGYDEPOSIT_HH
+
+#include "globals.hh"
+
+//==============================================================================
+// Energy deposit bins
+//
+// Deposits are accumulated per scoring volume and per particle species into
+// a fixed-size table, so recording a step is an array add. Species map to
+// PDG codes 11, -11 and 22; everything else (ions, alphas, ...) is OTHER.
+//==============================================================================
+
+namespace EnergyDeposit {
+    enum Volume { SOURCE, DETECTOR, N_VOLUMES };
+    enum Species { ELECTRON, POSITRON, GAMMA, OTHER, N_SPECIES };
+    
+    inline const char* VolumeName(G4int volume) {
+        static const char* const names[N_VOLUMES] = {"Source", "Detector"};
+        return names[volume];
+    }
+    
+    inline const char* SpeciesName(G4int species) {
+        static const char* const names[N_SPECIES] = {"e-", "e+", "gamma", "other"};
+        return names[species];
+    }
+    
+    struct Table {
+        G4double value[N_VOLUMES][N_SPECIES];
+        
+        void Clear() {
+            for (auto& row : value) for (G4double& v : row) v = 0.0;
+        }
+        
+        G4double Total(G4int volume) const {
+            G4double sum = 0.0;
+            for (G4double v : value[volume]) sum += v;
+            return sum;
+        }
+        
+        Table& operator+=(const Table& other) {
+            for (G4int i = 0; i < N_VOLUMES; ++i) {
+                for (G4int j = 0; j < N_SPECIES; ++j) value[i][j] += other.value[i][j];
+            }
+            return *this;
+        }
+        
+        // Adds other scaled by a statistical weight
+        void Add(const Table& other, G4double weight) {
+            for (G4int i = 0; i < N_VOLUMES; ++i) {
+                for (G4int j = 0; j < N_SPECIES; ++j) value[i][j] += weight*other.value[i][j];
+            }
+        }
+    };
+}
+
+#endif // ENERGYDEPOSIT_HH
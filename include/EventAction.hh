@@ -4,30 +4,70 @@
 
 #include "G4UserEventAction.hh"
 #include "globals.hh"
+#include "EnergyDeposit.hh"
+#include <vector>
 
 class RunAction;
+class BetaDecayPrimaryGenerator;
+class G4ParticleDefinition;
 
 class EventAction : public G4UserEventAction {
 public:
-    EventAction(RunAction* runAction);
+    // Output records carry the generator's global event id (firstEvent +
+    // event id, or the n-th id left in a resumed run)
+    EventAction(RunAction* runAction, const BetaDecayPrimaryGenerator* generator);
     virtual ~EventAction();
     
     virtual void BeginOfEventAction(const G4Event*);
     virtual void EndOfEventAction(const G4Event*);
     
     // Methods to collect data during event
-    void AddTrack(G4double energy, G4String particleName, 
-                  G4double x, G4double y, G4double z,
+    void AddTrack(const G4ParticleDefinition* particle, G4double energy,
                   G4int decayType = 1);
     
+    // Called by SteppingAction for every step with a deposit in a scoring
+    // volume. The table is cleared, not reallocated, between events.
+    void AddDeposit(EnergyDeposit::Volume volume, const G4ParticleDefinition* particle,
+                    G4double edep) {
+        fDeposits.value[volume][GetSpecies(particle)] += edep;
+    }
+    
+    // Detector deposits per crystal. Only the crystals hit in this event
+    // are visited at its end, however large the array.
+    void AddCrystalDeposit(G4int crystal, G4double edep) {
+        if (crystal >= static_cast<G4int>(fCrystalEnergy.size())) fCrystalEnergy.resize(crystal + 1, 0.);
+        if (fCrystalEnergy[crystal] == 0.) fHitCrystals.push_back(crystal);
+        fCrystalEnergy[crystal] += edep;
+    }
+    
 private:
+    // Totals, deposits and output records of the finished event
+    void ProcessEvent(const G4Event* event);
+    
+    EnergyDeposit::Species GetSpecies(const G4ParticleDefinition* particle) const {
+        if (particle == fElectron) return EnergyDeposit::ELECTRON;
+        if (particle == fGamma) return EnergyDeposit::GAMMA;
+        if (particle == fPositron) return EnergyDeposit::POSITRON;
+        return EnergyDeposit::OTHER;
+    }
+    
     RunAction* fRunAction;
-    G4int fEventID;
+    const BetaDecayPrimaryGenerator* fGenerator;
+    G4long fEventID;
+    
+    // Particle definitions are singletons; compare pointers, not names
+    const G4ParticleDefinition* fElectron;
+    const G4ParticleDefinition* fPositron;
+    const G4ParticleDefinition* fGamma;
     
     // Event data
     G4double fTotalEnergy;
     G4int fNumElectrons;
     G4int fDecayType;
+    EnergyDeposit::Table fDeposits;
+    std::vector<G4double> fCrystalEnergy;   // By crystal index, zero if not hit
+    std::vector<G4int> fHitCrystals;
+    std::vector<G4double> fLeptonEnergies;  // Primary e-/e+ kinetic energies
 };
 
-#endif // EVENTACTION_HH
\ No newline at end of file
+#endif // EVENTACTION_HH
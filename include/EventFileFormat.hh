@@ -0,0 +1,124 @@
+// include/EventFileFormat.hh
+#ifndef EVENTFILEFORMAT_HH
+#define EVENTFILEFORMAT_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+//==============================================================================
+// Binary event output format (.bdevt)
+//
+//   FileHeader
+//   ColumnDescriptor[nColumns]
+//   Chunk*        ChunkHeader, then each column as nRows fixed-width values
+//   IndexEntry[nChunks]
+//   FileTrailer   (last 32 bytes of the file)
+//
+// Every section and every column block starts on an 8-byte boundary, so a
+// memory-mapped file can be read in place. Values are little-endian. The
+// column directory lets readers skip columns they do not know and find the
+// ones they need by id, so columns can be added without breaking old files.
+//
+// The text format written by RunAction is also defined here, so that files
+// converted from binary are identical to files written as text.
+//==============================================================================
+
+namespace EventFile {
+    constexpr char FILE_MAGIC[8] = {'B', 'D', 'E', 'V', 'T', 'F', 'M', 'T'};
+    constexpr char TRAILER_MAGIC[8] = {'B', 'D', 'E', 'V', 'T', 'E', 'N', 'D'};
+    constexpr char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint32_t DEFAULT_CHUNK_ROWS = 65536;
+    constexpr const char* EXTENSION = ".bdevt";
+
+    enum class ColumnType : std::uint8_t { Int64, Int32, UInt8, Float64, Float32 };
+
+    enum ColumnId : std::uint16_t {
+        COLUMN_EVENT_ID = 1,     // int64
+        COLUMN_DECAY_TYPE = 2,   // uint8, 1 = single beta, 2 = double beta
+        COLUMN_PARTICLE = 3,     // int32, PDG code
+        COLUMN_ENERGY = 4,       // float64, kinetic energy in MeV
+        COLUMN_X = 5,            // float32, mm
+        COLUMN_Y = 6,            // float32, mm
+        COLUMN_Z = 7,            // float32, mm
+        COLUMN_WEIGHT = 8        // float64, statistical weight of the vertex
+    };
+
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint16_t nColumns;
+        std::uint16_t headerSize;    // Including the column directory
+        std::uint32_t chunkRows;     // Maximum rows per chunk
+        std::uint32_t flags;
+    };
+
+    struct ColumnDescriptor {
+        std::uint16_t id;
+        std::uint8_t type;           // ColumnType
+        std::uint8_t width;          // Bytes per value
+        std::uint32_t reserved;
+        char name[8];
+    };
+
+    struct ChunkHeader {
+        char magic[4];
+        std::uint32_t nRows;
+        std::int64_t firstEventId;
+        std::int64_t lastEventId;
+    };
+
+    struct IndexEntry {
+        std::uint64_t offset;        // Of the ChunkHeader
+        std::uint32_t nRows;
+        std::uint32_t reserved;
+        std::int64_t firstEventId;
+        std::int64_t lastEventId;
+    };
+
+    struct FileTrailer {
+        std::uint64_t indexOffset;
+        std::uint64_t nChunks;
+        std::uint64_t nRows;
+        char magic[8];
+    };
+
+    static_assert(sizeof(FileHeader) == 24, "FileHeader layout");
+    static_assert(sizeof(ColumnDescriptor) == 16, "ColumnDescriptor layout");
+    static_assert(sizeof(ChunkHeader) == 24, "ChunkHeader layout");
+    static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout");
+    static_assert(sizeof(FileTrailer) == 32, "FileTrailer layout");
+
+    // One output row: a primary particle of a recorded event
+    struct EventRecord {
+        std::int64_t eventId;
+        std::int32_t particle;       // PDG code
+        std::uint8_t decayType;
+        double energy;               // MeV
+        float x, y, z;               // mm
+        double weight = 1.0;         // 1 unless the emission is biased
+    };
+
+    // Columns written by this version, in file order
+    constexpr std::size_t N_COLUMNS = 8;
+    extern const ColumnDescriptor COLUMNS[N_COLUMNS];
+
+    constexpr std::size_t Align8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+    // Geant4 particle name for a PDG code ("pdg:<code>" if unknown)
+    const char* ParticleName(std::int32_t pdgCode, char* scratch, std::size_t size);
+
+    // Text format: header, one line per record, summary
+    struct TextSummary {
+        std::int64_t totalEvents = 0;
+        std::int64_t singleBetaCount = 0;
+        std::int64_t doubleBetaCount = 0;
+        double totalEnergy = 0.0;    // MeV
+    };
+    void WriteTextHeader(std::ostream& out);
+    std::size_t FormatTextLine(const EventRecord& record, char* line, std::size_t size);
+    void WriteTextSummary(std::ostream& out, const TextSummary& summary);
+}
+
+#endif // EVENTFILEFORMAT_HH
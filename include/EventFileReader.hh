@@ -0,0 +1,79 @@
+// include/EventFileReader.hh
+#ifndef EVENTFILEREADER_HH
+#define EVENTFILEREADER_HH
+
+#include "EventFileFormat.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+//==============================================================================
+// Memory-mapped reader for the binary event format
+//
+// The file is mapped read-only and chunks are exposed as typed column
+// pointers into the mapping, so scanning a column touches only its pages
+// and copies nothing. Columns absent from the file come back as nullptr.
+//==============================================================================
+
+namespace EventFile {
+
+struct ChunkView {
+    std::uint32_t nRows = 0;
+    std::int64_t firstEventId = 0;
+    std::int64_t lastEventId = 0;
+    
+    const std::int64_t* eventId = nullptr;
+    const std::uint8_t* decayType = nullptr;
+    const std::int32_t* particle = nullptr;
+    const double* energy = nullptr;
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* z = nullptr;
+    const double* weight = nullptr;   // Absent before the weight column: 1
+    
+    EventRecord GetRecord(std::uint32_t row) const;
+};
+
+class EventFileReader {
+public:
+    // Throws std::runtime_error on open/map failure or a malformed file:
+    // the column directory and every chunk of the index are checked to lie
+    // within the file, so a truncated or corrupt file is never read out of
+    // bounds
+    explicit EventFileReader(const std::string& path);
+    ~EventFileReader();
+    
+    EventFileReader(const EventFileReader&) = delete;
+    EventFileReader& operator=(const EventFileReader&) = delete;
+    
+    std::uint32_t GetVersion() const { return fHeader->version; }
+    std::uint64_t GetNumberOfChunks() const { return fTrailer->nChunks; }
+    std::uint64_t GetNumberOfRows() const { return fTrailer->nRows; }
+    std::size_t GetFileSize() const { return fSize; }
+    const IndexEntry& GetIndexEntry(std::uint64_t chunk) const { return fIndex[chunk]; }
+    
+    ChunkView GetChunk(std::uint64_t chunk) const;
+    
+    // Rebuild the text output (header, lines, summary) from the records
+    void WriteText(std::ostream& out) const;
+    
+    // Summary counters as RunAction reports them: events are the distinct
+    // event ids, the energy is summed over all rows
+    TextSummary Summarize() const;
+    
+private:
+    void Validate(const std::string& path);
+    
+    const char* fData;
+    std::size_t fSize;
+    const FileHeader* fHeader;
+    const ColumnDescriptor* fColumns;
+    const IndexEntry* fIndex;
+    const FileTrailer* fTrailer;
+};
+
+} // namespace EventFile
+
+#endif // EVENTFILEREADER_HH
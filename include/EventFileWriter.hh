@@ -0,0 +1,74 @@
+// include/EventFileWriter.hh
+#ifndef EVENTFILEWRITER_HH
+#define EVENTFILEWRITER_HH
+
+#include "EventFileFormat.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Writing side of the binary event format
+//
+// EncodeChunk turns a block of rows into an encoded chunk (header + column
+// blocks) that can be written verbatim, so encoding can happen away from the
+// file. EventFileWriter owns the file, appends encoded chunks and writes the
+// index and trailer on Close().
+//==============================================================================
+
+namespace EventFile {
+
+struct EncodedChunk {
+    std::vector<char> bytes;        // ChunkHeader followed by the columns
+    std::uint32_t nRows = 0;
+    std::int64_t firstEventId = 0;
+    std::int64_t lastEventId = 0;
+};
+
+// Encode rows into one chunk, columns in COLUMNS order
+std::shared_ptr<const EncodedChunk> EncodeChunk(const EventRecord* rows, std::uint32_t nRows);
+
+class EventFileWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created. With append,
+    // a complete file is continued: new chunks replace its index and
+    // trailer, which Close() writes again for all chunks.
+    explicit EventFileWriter(const std::string& path,
+                             std::uint32_t chunkRows = DEFAULT_CHUNK_ROWS, bool append = false);
+    ~EventFileWriter();
+    
+    EventFileWriter(const EventFileWriter&) = delete;
+    EventFileWriter& operator=(const EventFileWriter&) = delete;
+    
+    void WriteChunk(const EncodedChunk& chunk);
+    void Append(const EventRecord& record);
+    // Hands the chunks written so far to the operating system
+    void Flush();
+    
+    // Flush pending rows and write index and trailer. Called by the
+    // destructor if needed.
+    void Close();
+    
+    std::uint64_t GetBytesWritten() const { return fOffset; }
+    std::uint64_t GetNumberOfRows() const { return fRows + fPending.size(); }
+    const std::vector<IndexEntry>& GetIndex() const { return fIndex; }
+    
+private:
+    void Write(const void* data, std::size_t size);
+    void FlushPending();
+    
+    std::FILE* fFile;
+    std::string fPath;
+    std::uint32_t fChunkRows;
+    std::uint64_t fOffset;
+    std::uint64_t fRows;
+    std::vector<IndexEntry> fIndex;
+    std::vector<EventRecord> fPending;
+};
+
+} // namespace EventFile
+
+#endif // EVENTFILEWRITER_HH
@@ -0,0 +1,165 @@
+// include/Histogram.hh
+#ifndef HISTOGRAM_HH
+#define HISTOGRAM_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Fixed-binning 1D and 2D histograms of weighted values
+//
+// Each axis has nBins equal bins on [low, high) plus an underflow and an
+// overflow bin; a 1D histogram is a 2D one without a y axis. Memory is
+// fixed when the histogram is booked, and filling is an index computation
+// and two adds (sum of weights and of squared weights, for the errors).
+// Histograms are not thread-safe: every thread fills its own and they are
+// merged at the end of the run by adding the bins.
+//
+// A HistogramSet is saved as a compact binary file (.bdhist, see
+// HistogramFile).
+//==============================================================================
+
+class Histogram {
+public:
+    struct Axis {
+        std::uint32_t nBins;
+        double low;
+        double high;
+    
+        // No bins: the y axis of a 1D histogram
+        Axis() : nBins(0), low(0.0), high(1.0) {}
+        Axis(std::uint32_t n, double lowEdge, double highEdge) : nBins(n), low(lowEdge), high(highEdge) {}
+    };
+    
+    Histogram(const std::string& name, const std::string& title, const Axis& x,
+              const Axis& y = Axis());
+    
+    void Fill(double x, double weight = 1.0) {
+        const std::size_t cell = Bin(fX, fInvWidthX, x);
+        fSumW[cell] += weight;
+        fSumW2[cell] += weight*weight;
+        ++fEntries;
+    }
+    
+    void Fill(double x, double y, double weight) {
+        const std::size_t cell = Bin(fX, fInvWidthX, x) + (fX.nBins + 2)*Bin(fY, fInvWidthY, y);
+        fSumW[cell] += weight;
+        fSumW2[cell] += weight*weight;
+        ++fEntries;
+    }
+    
+    // False (and nothing added) if the binning differs
+    bool Merge(const Histogram& other);
+    void Reset();
+    bool IsCompatible(const Histogram& other) const;
+    
+    const std::string& GetName() const { return fName; }
+    const std::string& GetTitle() const { return fTitle; }
+    bool Is2D() const { return fY.nBins > 0; }
+    const Axis& GetXAxis() const { return fX; }
+    const Axis& GetYAxis() const { return fY; }
+    std::uint64_t GetEntries() const { return fEntries; }
+    
+    // Cells including under- and overflow; bin ix of x is cell ix + 1
+    std::size_t GetNumberOfCells() const { return fSumW.size(); }
+    std::size_t GetCell(std::uint32_t ix, std::uint32_t iy = 0) const {
+        return ix + 1 + (Is2D() ? (fX.nBins + 2)*(iy + 1) : 0);
+    }
+    double GetSumW(std::size_t cell) const { return fSumW[cell]; }
+    double GetSumW2(std::size_t cell) const { return fSumW2[cell]; }
+    // Sum of weights in the bins, without under- and overflow
+    double GetIntegral() const;
+    
+    // Bin centres and contents as text columns: x [y] sumW error
+    void WriteText(std::ostream& out) const;
+    
+    // All cells at once, as stored in a file; false if the sizes differ
+    const std::vector<double>& GetSumW() const { return fSumW; }
+    const std::vector<double>& GetSumW2() const { return fSumW2; }
+    bool SetContents(std::uint64_t entries, const std::vector<double>& sumW,
+                     const std::vector<double>& sumW2);
+
+private:
+    static std::size_t Bin(const Axis& axis, double invWidth, double value) {
+        if (!(value >= axis.low)) return 0;   // Also NaN
+        if (value >= axis.high) return axis.nBins + 1;
+        const std::size_t bin = static_cast<std::size_t>((value - axis.low)*invWidth);
+        return (bin < axis.nBins ? bin : axis.nBins - 1) + 1;
+    }
+    
+    std::string fName;
+    std::string fTitle;
+    Axis fX;
+    Axis fY;
+    double fInvWidthX;
+    double fInvWidthY;
+    std::uint64_t fEntries;
+    std::vector<double> fSumW;
+    std::vector<double> fSumW2;
+};
+
+class HistogramSet {
+public:
+    // Returns the index of the new histogram
+    std::size_t Book(const std::string& name, const std::string& title, const Histogram::Axis& x,
+                     const Histogram::Axis& y = Histogram::Axis());
+    
+    Histogram& operator[](std::size_t index) { return fHistograms[index]; }
+    const Histogram& operator[](std::size_t index) const { return fHistograms[index]; }
+    std::size_t Size() const { return fHistograms.size(); }
+    // nullptr if there is none of that name
+    const Histogram* Find(const std::string& name) const;
+    
+    // Adds the histograms of other, matched by name; false if one is
+    // missing here or has a different binning (the others are still added)
+    bool Merge(const HistogramSet& other);
+    void Reset();
+
+private:
+    std::vector<Histogram> fHistograms;
+};
+
+//==============================================================================
+// Histogram file
+//
+//   FileHeader
+//   per histogram: HistogramHeader, sumW[nCells], sumW2[nCells]
+//
+// with nCells = (nx + 2)*(ny + 2) for 2D and nx + 2 for 1D, x varying
+// fastest. Values are little-endian and every section is 8-byte aligned.
+//==============================================================================
+
+namespace HistogramFile {
+    constexpr char FILE_MAGIC[8] = {'B', 'D', 'H', 'I', 'S', 'T', 'F', 'M'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr const char* EXTENSION = ".bdhist";
+    
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t nHistograms;
+    };
+    
+    struct HistogramHeader {
+        char name[32];
+        char title[64];
+        std::uint32_t nx;
+        std::uint32_t ny;            // 0 for 1D
+        double xLow, xHigh;
+        double yLow, yHigh;
+        std::uint64_t entries;
+    };
+    
+    static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+    static_assert(sizeof(HistogramHeader) == 144, "HistogramHeader layout");
+    
+    // Throw std::runtime_error on I/O failure or a malformed file. Names
+    // and titles longer than the header fields are truncated.
+    void Write(const std::string& path, const HistogramSet& histograms);
+    HistogramSet Read(const std::string& path);
+}
+
+#endif // HISTOGRAM_HH
@@ -0,0 +1,81 @@
+// include/LatencyHistogram.hh
+#ifndef LATENCYHISTOGRAM_HH
+#define LATENCYHISTOGRAM_HH
+
+#include <array>
+#include <cstdint>
+
+//==============================================================================
+// HDR-style latency histogram
+//
+// Counts nanosecond durations in log-linear buckets: values below 64 ns have
+// a bucket each, above that every power of two is split into 32 equal
+// buckets, so any recorded value is known to within 1/32 (about 3 %) over
+// the whole range up to 2^40 ns (18 minutes; longer values are clamped).
+// Recording is a count-leading-zeros, a shift and an increment; histograms
+// of different threads are merged by adding the bucket counts.
+//==============================================================================
+
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_BITS = 40;
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << MAX_BITS) - 1;
+    static constexpr int N_BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1)*SUB_BUCKETS;
+
+    LatencyHistogram() { Reset(); }
+
+    void Reset();
+
+    void Record(std::uint64_t nanoseconds) {
+        const std::uint64_t value = nanoseconds < MAX_VALUE ? nanoseconds : MAX_VALUE;
+        ++fCounts[BucketIndex(value)];
+        ++fCount;
+        fSum += value;
+        if (value < fMin) fMin = value;
+        if (value > fMax) fMax = value;
+    }
+
+    void Merge(const LatencyHistogram& other);
+
+    std::uint64_t GetCount() const { return fCount; }
+    std::uint64_t GetSum() const { return fSum; }
+    std::uint64_t GetMin() const { return fCount ? fMin : 0; }
+    std::uint64_t GetMax() const { return fMax; }
+    double GetMean() const { return fCount ? double(fSum)/fCount : 0.0; }
+    // Value below which the fraction `quantile` (0..1) of the samples lie,
+    // to bucket precision
+    std::uint64_t GetQuantile(double quantile) const;
+
+    // Bucket of value (< 2^MAX_BITS) and the smallest value of a bucket
+    static int BucketIndex(std::uint64_t value) {
+        if (value < 2*SUB_BUCKETS) return static_cast<int>(value);
+        const int shift = HighestBit(value) - SUB_BUCKET_BITS;
+        return shift*SUB_BUCKETS + static_cast<int>(value >> shift);
+    }
+    static std::uint64_t BucketLowest(int index) {
+        if (index < 2*SUB_BUCKETS) return static_cast<std::uint64_t>(index);
+        const int shift = index/SUB_BUCKETS - 1;
+        return static_cast<std::uint64_t>(index - shift*SUB_BUCKETS) << shift;
+    }
+
+private:
+    static int HighestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        int bit = 0;
+        while (value >>= 1) ++bit;
+        return bit;
+#endif
+    }
+
+    std::array<std::uint64_t, N_BUCKETS> fCounts;
+    std::uint64_t fCount;
+    std::uint64_t fSum;
+    std::uint64_t fMin;
+    std::uint64_t fMax;
+};
+
+#endif // LATENCYHISTOGRAM_HH
@@ -0,0 +1,210 @@
+// include/NuclideTable.hh
+#ifndef NUCLIDETABLE_HH
+#define NUCLIDETABLE_HH
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+//==============================================================================
+// Compile-time nuclear data: element symbols and evaluated masses
+//
+// The symbol table covers Z = 0 (the neutron, "n") to 118. The mass table
+// holds evaluated mass excesses (AME style, keV, rounded; good to a few keV)
+// of the nuclides the generators use: the isotopes of
+// BetaDecayUtils::FindIsotope, their single and double beta daughters, and
+// the intermediate nuclei that make single beta decay of the double beta
+// emitters forbidden. Everything is constexpr with no Geant4 dependency.
+// Lookups cost an index read and a scan of the few tabulated isotopes of one
+// element, with no parsing or allocation. Q-values of tabulated nuclides are
+// compile-time constants, for example
+//
+//   constexpr double q = NuclideTable::QValue(32, 76, NuclideTable::Transition::DoubleBetaMinus);
+//
+// Nuclides that are not tabulated fall back to the semi-empirical
+// (Bethe-Weizsaecker) mass formula at run time (AtomicMass).
+//==============================================================================
+
+namespace NuclideTable {
+    constexpr int MAX_Z = 118;
+    constexpr double ATOMIC_MASS_UNIT = 931.49410242;   // MeV
+    constexpr double ELECTRON_MASS = 0.51099895;        // MeV
+    constexpr double NEUTRON_MASS = 939.56542052;       // MeV
+    constexpr double HYDROGEN_MASS = 938.78307;         // Proton + electron - 13.6 eV, MeV
+
+    constexpr const char* ELEMENT_SYMBOLS[MAX_Z + 1] = {
+        "n", "H", "He", "Li", "Be", "B", "C", "N", "O", "F", "Ne",
+        "Na", "Mg", "Al", "Si", "P", "S", "Cl", "Ar", "K", "Ca",
+        "Sc", "Ti", "V", "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn",
+        "Ga", "Ge", "As", "Se", "Br", "Kr", "Rb", "Sr", "Y", "Zr",
+        "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd", "In", "Sn",
+        "Sb", "Te", "I", "Xe", "Cs", "Ba", "La", "Ce", "Pr", "Nd",
+        "Pm", "Sm", "Eu", "Gd", "Tb", "Dy", "Ho", "Er", "Tm", "Yb",
+        "Lu", "Hf", "Ta", "W", "Re", "Os", "Ir", "Pt", "Au", "Hg",
+        "Tl", "Pb", "Bi", "Po", "At", "Rn", "Fr", "Ra", "Ac", "Th",
+        "Pa", "U", "Np", "Pu", "Am", "Cm", "Bk", "Cf", "Es", "Fm",
+        "Md", "No", "Lr", "Rf", "Db", "Sg", "Bh", "Hs", "Mt", "Ds",
+        "Rg", "Cn", "Nh", "Fl", "Mc", "Lv", "Ts", "Og"
+    };
+
+    // nullptr outside 0 <= Z <= MAX_Z
+    constexpr const char* ElementSymbol(int Z) {
+        return Z >= 0 && Z <= MAX_Z ? ELEMENT_SYMBOLS[Z] : nullptr;
+    }
+
+    struct Nuclide {
+        int Z;
+        int A;
+        double massExcess;   // keV, neutral atom
+    };
+
+    // Sorted by Z, then A
+    constexpr Nuclide NUCLIDES[] = {
+        {0, 1, 8071.318},       // n
+        {1, 1, 7288.971},       // H-1
+        {6, 14, 3019.893},      // C-14
+        {7, 14, 2863.417},      // N-14
+        {10, 22, -8024.716},    // Ne-22
+        {11, 22, -5181.51},     // Na-22
+        {18, 40, -35039.894},   // Ar-40
+        {19, 40, -33535.49},    // K-40
+        {20, 40, -34846.384},   // Ca-40
+        {20, 48, -44224.8},     // Ca-48
+        {21, 48, -44503.0},     // Sc-48
+        {22, 48, -48492.7},     // Ti-48
+        {32, 76, -73212.89},    // Ge-76
+        {33, 76, -72291.4},     // As-76
+        {34, 76, -75251.95},    // Se-76
+        {34, 82, -77594.0},     // Se-82
+        {35, 82, -77498.6},     // Br-82
+        {36, 82, -80591.78},    // Kr-82
+        {38, 90, -85948.1},     // Sr-90
+        {39, 90, -86494.0},     // Y-90
+        {40, 90, -88772.5},     // Zr-90
+        {42, 100, -86184.4},    // Mo-100
+        {43, 100, -86016.3},    // Tc-100
+        {44, 100, -89219.0},    // Ru-100
+        {52, 130, -87352.9},    // Te-130
+        {53, 130, -86936.5},    // I-130
+        {54, 130, -89880.4},    // Xe-130
+        {54, 136, -86429.2},    // Xe-136
+        {55, 136, -86338.8},    // Cs-136
+        {56, 136, -88887.0}     // Ba-136
+    };
+    constexpr std::size_t N_NUCLIDES = sizeof(NUCLIDES)/sizeof(NUCLIDES[0]);
+
+    constexpr bool IsSorted() {
+        for (std::size_t i = 1; i < N_NUCLIDES; ++i) {
+            if (NUCLIDES[i].Z < NUCLIDES[i - 1].Z ||
+                (NUCLIDES[i].Z == NUCLIDES[i - 1].Z && NUCLIDES[i].A <= NUCLIDES[i - 1].A)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(IsSorted(), "NUCLIDES must be sorted by Z, then A");
+
+    // First NUCLIDES entry of every Z (and one past the last), generated at
+    // compile time
+    struct ElementIndex {
+        std::uint16_t first[MAX_Z + 2];
+    };
+
+    constexpr ElementIndex BuildElementIndex() {
+        ElementIndex index{};
+        std::size_t i = 0;
+        for (int Z = 0; Z <= MAX_Z + 1; ++Z) {
+            while (i < N_NUCLIDES && NUCLIDES[i].Z < Z) ++i;
+            index.first[Z] = static_cast<std::uint16_t>(i);
+        }
+        return index;
+    }
+    constexpr ElementIndex ELEMENT_INDEX = BuildElementIndex();
+
+    // nullptr if (Z, A) is not tabulated
+    constexpr const Nuclide* Find(int Z, int A) {
+        if (Z < 0 || Z > MAX_Z) return nullptr;
+        for (std::size_t i = ELEMENT_INDEX.first[Z]; i < ELEMENT_INDEX.first[Z + 1]; ++i) {
+            if (NUCLIDES[i].A == A) return &NUCLIDES[i];
+        }
+        return nullptr;
+    }
+
+    constexpr bool IsTabulated(int Z, int A) { return Find(Z, A) != nullptr; }
+
+    // Neutral atom mass in MeV; NaN if (Z, A) is not tabulated
+    constexpr double TabulatedAtomicMass(int Z, int A) {
+        return Find(Z, A) ? A*ATOMIC_MASS_UNIT + Find(Z, A)->massExcess*1.0e-3
+                          : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    enum class Transition { BetaMinus, BetaPlus, ElectronCapture, DoubleBetaMinus, DoubleBetaPlus };
+
+    constexpr int ChargeChange(Transition transition) {
+        return transition == Transition::BetaMinus ? 1
+             : transition == Transition::DoubleBetaMinus ? 2
+             : transition == Transition::DoubleBetaPlus ? -2 : -1;
+    }
+
+    // Kinetic energy released (MeV) from atomic masses: each emitted
+    // positron also costs two electron masses. NaN unless parent and
+    // daughter are tabulated; positive if the transition is allowed.
+    constexpr double QValue(int Z, int A, Transition transition) {
+        return TabulatedAtomicMass(Z, A) - TabulatedAtomicMass(Z + ChargeChange(transition), A)
+             - (transition == Transition::BetaPlus ? 2.0*ELECTRON_MASS
+                : transition == Transition::DoubleBetaPlus ? 4.0*ELECTRON_MASS : 0.0);
+    }
+
+    // Semi-empirical binding energy in MeV (0 for A <= 1)
+    inline double SemiEmpiricalBindingEnergy(int Z, int A) {
+        if (A <= 1) return 0.0;
+        const int N = A - Z;
+        const double a = A;
+        const double cbrtA = std::cbrt(a);
+        double binding = 15.75*a - 17.8*cbrtA*cbrtA - 0.711*Z*(Z - 1)/cbrtA
+                       - 23.7*(N - Z)*(N - Z)/a;
+        if (Z % 2 == 0 && N % 2 == 0) binding += 11.18/std::sqrt(a);
+        else if (Z % 2 == 1 && N % 2 == 1) binding -= 11.18/std::sqrt(a);
+        return binding;
+    }
+
+    inline double SemiEmpiricalAtomicMass(int Z, int A) {
+        if (A == 1 && Z == 0) return NEUTRON_MASS;
+        if (A == 1 && Z == 1) return HYDROGEN_MASS;
+        return Z*HYDROGEN_MASS + (A - Z)*NEUTRON_MASS - SemiEmpiricalBindingEnergy(Z, A);
+    }
+
+    // Neutral atom mass in MeV: tabulated, else semi-empirical
+    inline double AtomicMass(int Z, int A) {
+        if (const Nuclide* nuclide = Find(Z, A)) return A*ATOMIC_MASS_UNIT + nuclide->massExcess*1.0e-3;
+        return SemiEmpiricalAtomicMass(Z, A);
+    }
+
+    // M(Z1, A) - M(Z2, A) in MeV: tabulated if both are, else semi-empirical
+    // for both, since mixing them would leave the formula's error (MeV)
+    // in the difference
+    inline double AtomicMassDifference(int Z1, int Z2, int A) {
+        if (IsTabulated(Z1, A) && IsTabulated(Z2, A)) {
+            return TabulatedAtomicMass(Z1, A) - TabulatedAtomicMass(Z2, A);
+        }
+        return SemiEmpiricalAtomicMass(Z1, A) - SemiEmpiricalAtomicMass(Z2, A);
+    }
+
+    // As QValue, with the semi-empirical masses for untabulated nuclides
+    inline double AnyQValue(int Z, int A, Transition transition) {
+        const double q = AtomicMassDifference(Z, Z + ChargeChange(transition), A);
+        return q - (transition == Transition::BetaPlus ? 2.0*ELECTRON_MASS
+                    : transition == Transition::DoubleBetaPlus ? 4.0*ELECTRON_MASS : 0.0);
+    }
+
+    // Stable against single beta- decay and electron capture (the double
+    // beta emitters count as stable)
+    inline bool IsStable(int Z, int A) {
+        if (Z < 1 || Z >= A) return false;
+        return !(AnyQValue(Z, A, Transition::BetaMinus) > 0.0) &&
+               !(AnyQValue(Z, A, Transition::ElectronCapture) > 0.0);
+    }
+}
+
+#endif // NUCLIDETABLE_HH
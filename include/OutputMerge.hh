@@ -0,0 +1,59 @@
+// include/OutputMerge.hh
+#ifndef OUTPUTMERGE_HH
+#define OUTPUTMERGE_HH
+
+#include "Counters.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Combining the output of separate jobs
+//
+// Jobs that split one workload by event id (BetaDecaySimulation --shards,
+// or jobs run by hand with /betadecay/gun/firstEvent) each write an event
+// file, a histogram file and a counter file. Merging them gives the output
+// of the whole workload:
+//
+//   - event files: the records of all inputs, sorted by event id with the
+//     particles of an event in their original order. Since every event's
+//     primaries depend only on the seed and its id, the merged file does
+//     not depend on how the events were split. The id ranges of the inputs
+//     may overlap: the chunks of all inputs are merged k-way, and only the
+//     chunks whose ids overlap the merge position are held in memory.
+//   - histograms and counters: added bin by bin and counter by counter.
+//     Counts are exact; weighted sums agree with a single job up to the
+//     rounding of the additions, which also differs between threads of
+//     one job.
+//
+// Inputs and output are given as names without extension, as for
+// /betadecay/output/file.
+//==============================================================================
+
+namespace OutputMerge {
+    struct Result {
+        std::size_t inputs = 0;
+        std::uint64_t rows = 0;          // Event records written
+        bool events = false;             // Which kinds of files were merged
+        bool histograms = false;
+        bool counters = false;
+        CounterSet mergedCounters;
+    };
+    
+    // Each throws std::runtime_error on I/O failure, a malformed input or
+    // (histograms) a binning that differs between the inputs
+    std::uint64_t MergeEventFiles(const std::vector<std::string>& inputs, const std::string& output);
+    void MergeHistogramFiles(const std::vector<std::string>& inputs, const std::string& output);
+    CounterSet MergeCounterFiles(const std::vector<std::string>& inputs, const std::string& output);
+    
+    // Merges every kind of file that all inputs have. Event files are read
+    // in the binary format; textEvents writes the merged events as text
+    // (the RunAction text format) instead.
+    Result Merge(const std::vector<std::string>& inputs, const std::string& output, bool textEvents);
+    
+    // Removes the event, histogram and counter files of an output name
+    void Remove(const std::string& name);
+}
+
+#endif // OUTPUTMERGE_HH
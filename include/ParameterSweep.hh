@@ -0,0 +1,51 @@
+// include/ParameterSweep.hh
+#ifndef PARAMETERSWEEP_HH
+#define PARAMETERSWEEP_HH
+
+#include "globals.hh"
+
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Parameter sweeps in one process
+//
+// A sweep table lists configurations, one per row, that
+// BetaDecaySimulation --sweep runs back to back on the same run manager.
+// Only the generator and detector settings change between runs, as UI
+// commands: the kernel, the physics tables and (unless the detector
+// changes) the geometry are built once for the whole table.
+//
+// The first row names the columns; cells are separated by whitespace and
+// '#' starts a comment. Columns:
+//
+//   name       output suffix of the configuration (default config<row>)
+//   events     events to run (default --events)
+//   isotope    /betadecay/gun/isotope
+//   decayMode  /betadecay/gun/decayMode
+//   qValue     /betadecay/gun/qValue, in MeV
+//   position   /betadecay/gun/position x,y,z in cm
+//   distance   /betadecay/detector/distance, in cm
+//   seed       /betadecay/gun/seed
+//   /any/cmd   the command itself with the cell as its parameters, commas
+//              standing for spaces (e.g. /betadecay/gun/biasAngle 30,deg)
+//
+// The commands of a row are applied in column order, so isotope goes
+// before qValue, which overrides its tabulated value. Settings stay in
+// force for the following rows; "-" applies nothing.
+//==============================================================================
+
+namespace ParameterSweep {
+    struct Configuration {
+        std::string name;
+        G4long events = -1;
+        std::vector<G4String> commands;
+    };
+    
+    // Throws std::runtime_error if the file cannot be read, a column is
+    // unknown or a row has the wrong number of cells. A configuration
+    // without an events cell runs defaultEvents (-1 is an error).
+    std::vector<Configuration> ReadTable(const std::string& path, G4long defaultEvents);
+}
+
+#endif // PARAMETERSWEEP_HH
@@ -0,0 +1,96 @@
+// include/PhaseProfile.hh
+#ifndef PHASEPROFILE_HH
+#define PHASEPROFILE_HH
+
+#include "LatencyHistogram.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+//==============================================================================
+// Per-phase event timing (/betadecay/profile/)
+//
+// Each thread's Run owns a PhaseProfile; RunAction makes it the thread's
+// active profile for the run when profiling is on. The user actions time
+// their phase with a PhaseProfile::Scope, which does nothing when there is
+// no active profile (a thread-local pointer test), so profiling costs
+// nothing when it is off. Every phase gets one histogram sample per event:
+//
+//   GENERATION    BetaDecayPrimaryGenerator::GeneratePrimaries
+//   TRACKING      BeginOfEventAction to EndOfEventAction (includes STEPPING)
+//   STEPPING      SteppingAction::UserSteppingAction, summed over the event
+//   END_OF_EVENT  EventAction::EndOfEventAction (includes OUTPUT)
+//   OUTPUT        RunAction calls: counters, deposits and output records
+//   EVENT         start of GeneratePrimaries to end of EndOfEventAction
+//
+// Worker profiles are merged into the master Run with the other run data.
+//==============================================================================
+
+class PhaseProfile {
+public:
+    enum Phase { GENERATION, TRACKING, STEPPING, END_OF_EVENT, OUTPUT, EVENT, N_PHASES };
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Times the enclosing block into the active profile, if any
+    class Scope {
+    public:
+        explicit Scope(Phase phase) : fProfile(GetActive()), fPhase(phase) {
+            if (fProfile) fStart = Clock::now();
+        }
+        ~Scope() {
+            if (fProfile) fProfile->Add(fPhase, Clock::now() - fStart);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PhaseProfile* fProfile;
+        Phase fPhase;
+        Clock::time_point fStart;
+    };
+
+    PhaseProfile();
+
+    static PhaseProfile* GetActive() { return fActive; }
+    static void SetActive(PhaseProfile* profile) { fActive = profile; }
+    static const char* PhaseName(Phase phase);
+
+    // Event boundaries: BeginEvent when generation starts, BeginTracking
+    // after BeginOfEventAction, EndTracking when EndOfEventAction starts and
+    // EndEvent when it returns
+    void BeginEvent() { fEventStart = Clock::now(); }
+    void BeginTracking() { fTrackingStart = Clock::now(); }
+    void EndTracking() { Add(TRACKING, Clock::now() - fTrackingStart); }
+    void EndEvent();
+
+    // Phases timed several times per event (STEPPING) are summed until
+    // EndEvent; the others are one sample each
+    void Add(Phase phase, Clock::duration duration) {
+        const std::uint64_t ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        if (phase == STEPPING) fSteppingSum += ns;
+        else fHistograms[phase].Record(ns);
+    }
+
+    void Merge(const PhaseProfile& other);
+    void Reset();
+
+    const LatencyHistogram& GetHistogram(Phase phase) const { return fHistograms[phase]; }
+    std::uint64_t GetEventCount() const { return fHistograms[EVENT].GetCount(); }
+
+    // Table of count, mean, percentiles and max per phase, in microseconds,
+    // with each phase's share of the summed event time
+    void Report(std::ostream& out) const;
+
+private:
+    static thread_local PhaseProfile* fActive;
+
+    LatencyHistogram fHistograms[N_PHASES];
+    Clock::time_point fEventStart;
+    Clock::time_point fTrackingStart;
+    std::uint64_t fSteppingSum;
+};
+
+#endif // PHASEPROFILE_HH
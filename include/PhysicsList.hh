@@ -3,17 +3,50 @@
 #define PHYSICSLIST_HH
 
 #include "G4VModularPhysicsList.hh"
-#include "G4EmStandardPhysics.hh"
-#include "G4DecayPhysics.hh"
-#include "G4RadioactiveDecayPhysics.hh"
-#include "G4OpticalPhysics.hh"
+#include "globals.hh"
+
+//==============================================================================
+// Physics profiles
+//
+// A profile picks the electromagnetic constructor and the production cuts
+// of the three cut regions: the world (default region), Source and Detector
+// (G4Regions created by DetectorConstruction). Throughput profiles keep the
+// cuts in the world air coarse; precision profiles refine them only where
+// the energy is scored.
+//
+//   fast      standard EM (opt0), world 10 cm, source and detector 1 mm
+//   standard  standard EM (opt0), 0.7 mm everywhere (the Geant4 default)
+//   precise   standard EM option 4, world 1 mm, source and detector 10 um
+//   livermore Livermore EM, world 1 mm, source and detector 10 um
+//
+// The profile is fixed when the physics list is constructed (main's
+// --physics option). /run/particle/dumpCutValues prints the cut table.
+// Every profile also registers fast simulation for e- and e+, used only
+// where a region has a model (see ElectronFastModel).
+//==============================================================================
 
 class PhysicsList : public G4VModularPhysicsList {
 public:
-    PhysicsList();
+    explicit PhysicsList(const G4String& profile = "standard", G4int verbose = 0);
     virtual ~PhysicsList();
     
     virtual void SetCuts();
+    
+    // True if name is one of the profiles above
+    static G4bool IsProfile(const G4String& name);
+    // Profile names separated by spaces
+    static G4String ProfileNames();
+    // Hash (16 hex digits) of the production cuts of every region and the
+    // energy range of the cut table, as they are now: stored physics
+    // tables are only valid for the cuts they were built with
+    static G4String CutsKey();
+
+private:
+    G4String fProfileName;
+    G4double fWorldCut;
+    G4double fSourceCut;
+    G4double fDetectorCut;
+    G4double fLowestCutEnergy;   // Lower edge of the production threshold table
 };
 
-#endif // PHYSICSLIST_HH
\ No newline at end of file
+#endif // PHYSICSLIST_HH
@@ -0,0 +1,150 @@
+// include/PrimaryFile.hh
+#ifndef PRIMARYFILE_HH
+#define PRIMARYFILE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Pre-generated primary events (.bdprim)
+//
+//   FileHeader
+//   ParticleEntry[nParticles]
+//   EventEntry[nEvents]       sorted by event id
+//
+// Fixed-width little-endian records, 8-byte aligned, so a mapped file is
+// read in place: event i is events[i], its particles a contiguous range of
+// the particle table. Files are written once (BetaDecayGenerator
+// --primaries) and replayed through any number of geometry and physics
+// variants (/betadecay/gun/replay).
+//==============================================================================
+
+namespace PrimaryFile {
+    constexpr char FILE_MAGIC[8] = {'B', 'D', 'P', 'R', 'I', 'M', 'F', 'L'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr const char* EXTENSION = ".bdprim";
+    
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t flags;
+        std::uint64_t nEvents;
+        std::uint64_t nParticles;
+        std::uint64_t particlesOffset;
+        std::uint64_t eventsOffset;
+        std::uint64_t reserved[2];
+    };
+    
+    struct EventEntry {
+        std::int64_t eventId;          // In the generating run
+        std::uint64_t firstParticle;   // Index into the particle table
+        std::uint32_t nParticles;
+        std::uint8_t decayType;        // 1 = single beta, 2 = double beta
+        std::uint8_t reserved[3];
+        double x, y, z;                // Vertex, mm
+        double weight;                 // Statistical weight of the vertex
+    };
+    
+    struct ParticleEntry {
+        std::int32_t pdgCode;
+        std::uint32_t reserved;
+        double px, py, pz;             // MeV/c
+    };
+    
+    static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+    static_assert(sizeof(EventEntry) == 56, "EventEntry layout");
+    static_assert(sizeof(ParticleEntry) == 32, "ParticleEntry layout");
+}
+
+namespace PrimaryFile {
+
+//==============================================================================
+// Writer
+//
+// Particles are streamed to the file as they arrive; the event table (56
+// bytes per event) is kept in memory, sorted by event id and written on
+// Close(). The file is written under a temporary name and renamed when it
+// is complete, so a replaced file never changes under a reader's mapping.
+//==============================================================================
+
+class PrimaryFileWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    explicit PrimaryFileWriter(const std::string& path);
+    ~PrimaryFileWriter();
+    
+    PrimaryFileWriter(const PrimaryFileWriter&) = delete;
+    PrimaryFileWriter& operator=(const PrimaryFileWriter&) = delete;
+    
+    // Append events; their firstParticle indexes the given particles.
+    // Thread-safe, and events may arrive in any order.
+    void AddEvents(const EventEntry* events, std::size_t nEvents,
+                   const ParticleEntry* particles, std::size_t nParticles);
+    
+    // Write the event table and header and move the file into place.
+    // Throws std::runtime_error on I/O failure; the destructor closes the
+    // file if needed and drops it on failure.
+    void Close();
+    
+    std::uint64_t GetNumberOfEvents() const;
+    
+private:
+    mutable std::mutex fMutex;
+    std::FILE* fFile;
+    std::string fPath;
+    std::string fPartialPath;
+    std::uint64_t fNParticles;
+    std::vector<EventEntry> fEvents;
+    bool fOk;
+};
+
+//==============================================================================
+// Reader
+//
+// Maps the file read-only. Open() shares one mapping per path between all
+// callers (the worker threads of a run), so replay costs no copy and no
+// parsing per event.
+//==============================================================================
+
+class PrimaryFileReader {
+public:
+    // Throws std::runtime_error on open/map failure or a malformed file
+    explicit PrimaryFileReader(const std::string& path);
+    ~PrimaryFileReader();
+    
+    PrimaryFileReader(const PrimaryFileReader&) = delete;
+    PrimaryFileReader& operator=(const PrimaryFileReader&) = delete;
+    
+    // The reader of path, shared while anyone holds it; throws as the
+    // constructor
+    static std::shared_ptr<const PrimaryFileReader> Open(const std::string& path);
+    
+    const std::string& GetPath() const { return fPath; }
+    std::uint64_t GetNumberOfEvents() const { return fHeader->nEvents; }
+    std::uint64_t GetNumberOfParticles() const { return fHeader->nParticles; }
+    
+    const EventEntry& GetEvent(std::uint64_t i) const { return fEvents[i]; }
+    // Particles of an event, or nullptr if its range is outside the table
+    const ParticleEntry* GetParticles(const EventEntry& event) const {
+        return event.firstParticle <= fHeader->nParticles &&
+               event.nParticles <= fHeader->nParticles - event.firstParticle
+            ? fParticles + event.firstParticle : nullptr;
+    }
+    
+private:
+    std::string fPath;
+    const char* fData;
+    std::size_t fSize;
+    const FileHeader* fHeader;
+    const ParticleEntry* fParticles;
+    const EventEntry* fEvents;
+};
+
+} // namespace PrimaryFile
+
+#endif // PRIMARYFILE_HH
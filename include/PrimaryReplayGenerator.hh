@@ -0,0 +1,50 @@
+// include/PrimaryReplayGenerator.hh
+#ifndef PRIMARYREPLAYGENERATOR_HH
+#define PRIMARYREPLAYGENERATOR_HH
+
+#include "G4VPrimaryGenerator.hh"
+#include "globals.hh"
+#include "PrimaryFile.hh"
+
+#include <memory>
+#include <unordered_map>
+
+class G4Event;
+class G4ParticleDefinition;
+
+//==============================================================================
+// Replays a pre-generated primary file (PrimaryFile.hh)
+//
+// Event n of a run takes record firstEvent + n, so every worker takes its
+// events straight from the shared read-only mapping by event id: no
+// parsing, no copy, and no allocation beyond the G4Allocator-pooled
+// vertex and particles. Runs longer than the file wrap around to its
+// first record (with a warning).
+//==============================================================================
+
+class PrimaryReplayGenerator : public G4VPrimaryGenerator {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is empty
+    explicit PrimaryReplayGenerator(const G4String& fileName);
+    virtual ~PrimaryReplayGenerator();
+    
+    virtual void GeneratePrimaryVertex(G4Event* event) override;
+    // The primaries of a given record, for callers that number events
+    // themselves (BetaDecayPrimaryGenerator's global event ids)
+    void GenerateRecord(G4Event* event, G4long record);
+    
+    void SetFirstEvent(G4long first) { fFirstEvent = first > 0 ? first : 0; }
+    G4long GetFirstEvent() const { return fFirstEvent; }
+    G4String GetFileName() const { return fFile->GetPath(); }
+    G4long GetNumberOfEvents() const { return static_cast<G4long>(fFile->GetNumberOfEvents()); }
+    
+private:
+    // Particle table lookup, cached per PDG code; nullptr if unknown
+    G4ParticleDefinition* FindParticle(G4int pdgCode);
+    
+    std::shared_ptr<const PrimaryFile::PrimaryFileReader> fFile;
+    G4long fFirstEvent;
+    std::unordered_map<G4int, G4ParticleDefinition*> fParticles;
+};
+
+#endif // PRIMARYREPLAYGENERATOR_HH
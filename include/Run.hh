@@ -0,0 +1,154 @@
+// include/Run.hh
+#ifndef RUN_HH
+#define RUN_HH
+
+#include "G4Run.hh"
+#include "globals.hh"
+#include "AsyncEventWriter.hh"
+#include "Checkpoint.hh"
+#include "Counters.hh"
+#include "EnergyDeposit.hh"
+#include "Histogram.hh"
+#include "PhaseProfile.hh"
+#include "Telemetry.hh"
+#include <memory>
+#include <vector>
+
+//==============================================================================
+// Per-thread run data
+//
+// Every worker fills its own Run without locking: counters, energy sums and
+// the energy deposited per scoring volume and species, merged into the
+// master Run by the kernel at the end of the run. Deposits and hit
+// efficiencies are weighted by the event weight (1 unless the emission is
+// biased, see BetaDecayPrimaryGenerator::SetBiasing); hit counts are not.
+// The online spectra are a HistogramSet per thread with fixed binning, so
+// their memory does not grow with the number of events. Per-particle
+// output records go to this thread's producer of the asynchronous writer
+// (see AsyncEventWriter), so the event loop never waits for the disk unless
+// the writer falls behind. Finished events are counted on this thread's
+// telemetry counter, which the progress reporter reads (see Telemetry),
+// and, with /betadecay/profile/enable, timed into this Run's PhaseProfile.
+// The global ids of the finished events are kept as ranges for checkpoints
+// (Checkpoint.hh).
+//==============================================================================
+
+class Run : public G4Run {
+public:
+    // Spectra in HistogramSet order
+    enum HistogramId {
+        H_EDEP_DETECTOR,      // Detector deposit per event (hit events)
+        H_EDEP_SOURCE,        // Source deposit per event (hit events)
+        H_EDEP_SINGLE,        // Detector deposit of single beta events
+        H_EDEP_DOUBLE,        // Detector deposit of double beta events
+        H_PRIMARY_ENERGY,     // Kinetic energy of every primary e-/e+
+        H_BB_SUM,             // Summed e-/e+ energy of events with two or more
+        H_BB_T1_T2,           // 2D: first vs second e-/e+ energy
+        H_RESPONSE,           // 2D: summed e-/e+ energy vs detector deposit
+        N_HISTOGRAMS
+    };
+    
+    // Energy axes of the spectra; the 2D ones get a fifth of the bins per axis
+    struct HistogramSettings {
+        G4int bins;
+        G4double energyMax;     // MeV
+    
+        HistogramSettings() : bins(500), energyMax(5.0) {}
+    };
+    
+    explicit Run(const HistogramSettings& histograms = HistogramSettings());
+    virtual ~Run();
+    
+    virtual void RecordEvent(const G4Event* event) override;
+    virtual void Merge(const G4Run* run) override;
+    
+    // Called from EventAction through RunAction on the owning thread
+    void AddEventData(G4double energy, G4int decayType);
+    // One event's deposits and its statistical weight
+    void AddDeposits(const EnergyDeposit::Table& deposits, G4double weight);
+    // One event's spectra entries; leptonEnergies are the kinetic energies
+    // of its primary electrons and positrons
+    void FillHistograms(const EnergyDeposit::Table& deposits, G4int decayType,
+                        const std::vector<G4double>& leptonEnergies, G4double weight);
+    // One event's (weighted) deposit in a detector crystal (copy-number index)
+    void AddCrystalDeposit(G4int crystal, G4double edep);
+    // An e-/e+ absorbed by the ElectronFastModel, and the energy it deposited
+    void AddFastSimTrack(G4double edep) {
+        fFastSimTracks++;
+        fFastSimEnergy += edep;
+    }
+    void AddRecord(const EventFile::EventRecord& record) {
+        if (fProducer) fProducer->Append(record);
+    }
+    
+    // Called by RunAction at the start and end of the run on the owning
+    // thread; detaching flushes and waits for this thread's records
+    void AttachWriter(EventFile::AsyncEventWriter* writer);
+    void DetachWriter();
+    // Hands this thread's records to the writer and waits until they are
+    // written (before a checkpoint snapshot)
+    void FlushWriter() {
+        if (fProducer) fProducer->Flush();
+    }
+    void MarkDone(G4long eventID) { fDone.Add(eventID); }
+    void SetTelemetry(Telemetry::Counter* counter) { fTelemetry = counter; }
+    
+    G4int GetEventCount() const { return fEventCount; }
+    G4double GetTotalEnergy() const { return fTotalEnergy; }
+    G4int GetSingleBetaCount() const { return fSingleBetaCount; }
+    G4int GetDoubleBetaCount() const { return fDoubleBetaCount; }
+    const EnergyDeposit::Table& GetDeposits() const { return fDeposits; }
+    const HistogramSet& GetHistograms() const { return fHistograms; }
+    PhaseProfile& GetProfile() { return fProfile; }
+    const PhaseProfile& GetProfile() const { return fProfile; }
+    G4int GetHitEventCount(G4int volume) const { return fHitEvents[volume]; }
+    // Sums over events of the weight and of weight*deposit^2
+    G4double GetWeightSum() const { return fWeightSum; }
+    G4double GetHitWeight(G4int volume) const { return fHitWeight[volume]; }
+    G4double GetDepositSquares(G4int volume) const { return fDepositSquares[volume]; }
+    // Fraction of the (unbiased) events with a deposit in the volume, and
+    // its statistical error
+    G4double GetEfficiency(G4int volume) const;
+    G4double GetEfficiencyError(G4int volume) const;
+    G4long GetFastSimTracks() const { return fFastSimTracks; }
+    G4double GetFastSimEnergy() const { return fFastSimEnergy; }
+    // Per crystal; sized by the highest crystal hit, so it may be shorter
+    // than the array
+    const std::vector<G4double>& GetCrystalEnergy() const { return fCrystalEnergy; }
+    const std::vector<G4int>& GetCrystalHits() const { return fCrystalHits; }
+    
+    // All of the totals above as named counters, energies in MeV; saved as
+    // <output name>.bdsum so that separate jobs can be merged
+    CounterSet GetCounters() const;
+    const Checkpoint::EventRanges& GetDone() const { return fDone; }
+    
+    // Adds the totals of a checkpoint (counters as from GetCounters, and
+    // spectra) to this run. False if a spectrum is missing or binned
+    // differently; the others are still added.
+    G4bool Restore(const CounterSet& counters, const HistogramSet& histograms);
+    
+private:
+    G4int fEventCount;
+    G4double fTotalEnergy;
+    G4int fSingleBetaCount;
+    G4int fDoubleBetaCount;
+    EnergyDeposit::Table fDeposits;
+    G4int fHitEvents[EnergyDeposit::N_VOLUMES];   // Events with a deposit
+    G4int fDepositEvents;                         // Events recorded by AddDeposits
+    G4double fWeightSum;
+    G4double fHitWeight[EnergyDeposit::N_VOLUMES];
+    G4double fHitWeightSquares[EnergyDeposit::N_VOLUMES];
+    G4double fDepositSquares[EnergyDeposit::N_VOLUMES];
+    std::vector<G4double> fCrystalEnergy;
+    std::vector<G4int> fCrystalHits;             // Events with a deposit
+    HistogramSet fHistograms;
+    PhaseProfile fProfile;
+    G4long fFastSimTracks;
+    G4double fFastSimEnergy;
+    Checkpoint::EventRanges fDone;
+    
+    std::unique_ptr<EventFile::AsyncEventWriter::Producer> fProducer;
+    Telemetry::Counter* fTelemetry;
+};
+
+#endif // RUN_HH
@@ -3,30 +3,137 @@
 #define RUNACTION_HH
 
 #include "G4UserRunAction.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
-#include <fstream>
+#include "Run.hh"
+#include "Checkpoint.hh"
+#include "RunCheckpointing.hh"
+#include <memory>
 
 class G4Run;
+class RunActionMessenger;
+class BetaDecayPrimaryGenerator;
+
+enum class OutputFormat { TEXT, BINARY };
 
 class RunAction : public G4UserRunAction {
 public:
-    RunAction();
+    // The generator of this thread, nullptr for the master of a
+    // multithreaded run; a resumed run hands it the event ids left
+    explicit RunAction(BetaDecayPrimaryGenerator* generator = nullptr);
     virtual ~RunAction();
     
+    virtual G4Run* GenerateRun();
     virtual void BeginOfRunAction(const G4Run*);
     virtual void EndOfRunAction(const G4Run*);
     
     // Methods to collect data from EventAction
     void AddEventData(G4double energy, G4String particle, G4int decayType);
+    void AddParticleData(G4long eventID, G4int pdgCode, G4double energy,
+                         G4int decayType, const G4ThreeVector& position, G4double weight);
+    void AddDeposits(const EnergyDeposit::Table& deposits, G4double weight) {
+        fRun->AddDeposits(deposits, weight);
+    }
+    void AddCrystalDeposit(G4int crystal, G4double edep) { fRun->AddCrystalDeposit(crystal, edep); }
+    void FillHistograms(const EnergyDeposit::Table& deposits, G4int decayType,
+                        const std::vector<G4double>& leptonEnergies, G4double weight) {
+        if (fHistogramsEnabled) fRun->FillHistograms(deposits, decayType, leptonEnergies, weight);
+    }
+    // After the event's data, with its global id: marks it done and answers
+    // a pending checkpoint request
+    void EndOfEvent(G4long eventID);
+    
+    // Output configuration (/betadecay/output/). Only the master's values
+    // are used: it opens the file and starts the writer thread.
+    void SetOutputFormat(OutputFormat format) { fOutputFormat = format; }
+    void SetOutputFileName(const G4String& name) { fOutputFileName = name; }
+    void SetBufferRecords(G4int n) { fWriterSettings.bufferRecords = n > 0 ? n : 1; }
+    void SetBuffersPerThread(G4int n) { fWriterSettings.buffersPerProducer = n > 2 ? n : 2; }
+    OutputFormat GetOutputFormat() const { return fOutputFormat; }
+    G4String GetOutputFileName() const;
+    G4int GetBufferRecords() const { return fWriterSettings.bufferRecords; }
+    G4int GetBuffersPerThread() const { return fWriterSettings.buffersPerProducer; }
+    
+    // Seconds between progress lines (/betadecay/telemetry/interval, master
+    // only); 0 disables the reporter
+    void SetTelemetryInterval(G4double seconds) { fTelemetryInterval = seconds > 0. ? seconds : 0.; }
+    G4double GetTelemetryInterval() const { return fTelemetryInterval; }
+    
+    // Per-phase event timing (/betadecay/profile/). The report of the last
+    // profiled run is kept by the master; an empty file name prints it.
+    void SetProfiling(G4bool enable) { fProfiling = enable; }
+    G4bool GetProfiling() const { return fProfiling; }
+    void ReportProfile(const G4String& fileName) const;
+    
+    // Online spectra (/betadecay/histo/), broadcast so that every thread
+    // books the same binning; the master writes <output name>.bdhist
+    void SetHistogramsEnabled(G4bool enable) { fHistogramsEnabled = enable; }
+    void SetHistogramBins(G4int bins) { fHistogramSettings.bins = bins > 0 ? bins : 1; }
+    void SetHistogramEnergyMax(G4double energy);
+    G4bool GetHistogramsEnabled() const { return fHistogramsEnabled; }
+    G4int GetHistogramBins() const { return fHistogramSettings.bins; }
+    G4double GetHistogramEnergyMax() const;
+    
+    // Checkpoints (/betadecay/checkpoint/): every interval seconds the
+    // master saves the run to <output name>.bdckpt (Checkpoint.hh) without
+    // stopping it; 0 (default) disables them. Resume loads the checkpoint
+    // of the current output name on every thread, so that the next run
+    // completes the checkpointed one; GetResumeEvents() is then the number
+    // of events it has to run (0: the outputs were completed at once), -1
+    // if nothing was loaded.
+    void SetCheckpointInterval(G4double seconds) { fCheckpointInterval = seconds > 0. ? seconds : 0.; }
+    G4double GetCheckpointInterval() const { return fCheckpointInterval; }
+    G4String GetCheckpointFileName() const { return fOutputFileName + Checkpoint::EXTENSION; }
+    G4bool Resume();
+    G4long GetResumeEvents() const { return fResumeEvents; }
+    // The counters of the current output name are saved and no checkpoint
+    // is left: its last run completed
+    G4bool IsComplete() const;
     
 private:
-    std::ofstream outputFile;
-    G4int totalEvents;
-    G4double totalEnergy;
+    // Detector response of a finished run, kept to compare fast and full
+    // simulation runs (master only)
+    struct RunDigest {
+        G4int runID = -1;
+        G4double rate = 0.;          // Events per second
+        G4double hitFraction = 0.;   // Events with a detector deposit
+        G4double mean = 0.;          // Detector deposit per hit event
+        G4double rms = 0.;
+        // Statistical uncertainties (normal approximation for the rms)
+        G4double hitFractionError = 0.;
+        G4double meanError = 0.;
+        G4double rmsError = 0.;
+    };
+    
+    void OpenOutput();
+    void CloseOutput(const Run* run);
+    void ReportFastSim(const Run* run, const RunDigest& digest);
+    void WriteHistograms(const Run* run) const;
+    void WriteCounters(const Run* run) const;
+    // Outputs of a resumed run with no events left
+    void FinishResume();
+    
+    // This thread's run; counters and output live there so that worker
+    // threads never share state
+    Run* fRun;
+    
+    OutputFormat fOutputFormat;
+    G4String fOutputFileName;   // Without extension
+    EventFile::AsyncEventWriter::Settings fWriterSettings;
+    G4double fTelemetryInterval;
+    G4bool fProfiling;
+    std::unique_ptr<PhaseProfile> fLastProfile;
+    G4bool fHistogramsEnabled;
+    Run::HistogramSettings fHistogramSettings;
+    RunDigest fLastRun[2];        // Without and with fast simulation
     
-    // Counters for different decay types
-    G4int singleBetaCount;
-    G4int doubleBetaCount;
+    BetaDecayPrimaryGenerator* fGenerator;
+    G4double fCheckpointInterval;
+    std::unique_ptr<Checkpoint::State> fResume;   // Loaded by Resume() until the run ends
+    G4long fResumeEvents;
+    std::unique_ptr<RunCheckpointing> fCheckpointing;   // Master only
+    RunCheckpointing::Client fCheckpointClient;
+    RunActionMessenger* fMessenger;
 };
 
-#endif // RUNACTION_HH
\ No newline at end of file
+#endif // RUNACTION_HH
@@ -0,0 +1,55 @@
+// include/RunActionMessenger.hh
+#ifndef RUNACTIONMESSENGER_HH
+#define RUNACTIONMESSENGER_HH
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class RunAction;
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithoutParameter;
+
+// UI commands for the run output under /betadecay/output/, the progress
+// telemetry under /betadecay/telemetry/, the event phase timing under
+// /betadecay/profile/, the online spectra under /betadecay/histo/ and the
+// checkpoints under /betadecay/checkpoint/
+class RunActionMessenger : public G4UImessenger {
+public:
+    RunActionMessenger(RunAction* runAction);
+    virtual ~RunActionMessenger();
+    
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+    virtual G4String GetCurrentValue(G4UIcommand* command);
+    
+private:
+    RunAction* fRunAction;
+    
+    G4UIdirectory* fDirectory;
+    G4UIcmdWithAString* fFormatCmd;
+    G4UIcmdWithAString* fFileCmd;
+    G4UIcmdWithAnInteger* fBufferSizeCmd;
+    G4UIcmdWithAnInteger* fBuffersCmd;
+    
+    G4UIdirectory* fTelemetryDirectory;
+    G4UIcmdWithADouble* fIntervalCmd;
+    
+    G4UIdirectory* fProfileDirectory;
+    G4UIcmdWithABool* fProfileEnableCmd;
+    G4UIcmdWithAString* fProfileReportCmd;
+    
+    G4UIdirectory* fHistoDirectory;
+    G4UIcmdWithABool* fHistoEnableCmd;
+    G4UIcmdWithAnInteger* fHistoBinsCmd;
+    G4UIcmdWithADoubleAndUnit* fHistoEnergyCmd;
+    
+    G4UIdirectory* fCheckpointDirectory;
+    G4UIcmdWithADouble* fCheckpointIntervalCmd;
+    G4UIcmdWithoutParameter* fResumeCmd;
+};
+
+#endif // RUNACTIONMESSENGER_HH
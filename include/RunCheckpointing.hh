@@ -0,0 +1,74 @@
+// include/RunCheckpointing.hh
+#ifndef RUNCHECKPOINTING_HH
+#define RUNCHECKPOINTING_HH
+
+#include "globals.hh"
+#include "AsyncEventWriter.hh"
+#include "Checkpoint.hh"
+#include <cstdint>
+#include <memory>
+
+class G4Run;
+class Run;
+
+//==============================================================================
+// Checkpoints of a run, as seen from the run actions
+//
+// The master RunAction owns one RunCheckpointing, the way it owns the
+// run's AsyncEventWriter: Start() runs the Checkpoint::Coordinator for a
+// run with checkpoints and Stop() ends it before the outputs are written.
+// The RunAction of every thread that processes events (the master too in
+// a sequential run) keeps a Client, which attaches to the started
+// checkpointing in BeginOfRunAction (the kernel calls the workers' after
+// the master's), answers requests at the end of its events and hands in
+// its final totals at the end of its run.
+//==============================================================================
+
+class RunCheckpointing {
+public:
+    class Client {
+    public:
+        // Without started checkpointing, or for a thread that processes no
+        // events, the client stays idle for the run
+        void Begin(G4bool processesEvents);
+        // A relaxed load per event; run's snapshot only once per request,
+        // after flushing its output records
+        void EndOfEvent(Run* run) {
+            if (fCheckpointing && fCheckpointing->fCoordinator.GetRequest() != fRequest) Answer(run);
+        }
+        void End(Run* run);
+    
+    private:
+        void Answer(Run* run);
+    
+        RunCheckpointing* fCheckpointing = nullptr;
+        std::uint32_t fRequest = 0;     // Last request answered
+    };
+    
+    RunCheckpointing() = default;
+    ~RunCheckpointing();
+    
+    RunCheckpointing(const RunCheckpointing&) = delete;
+    RunCheckpointing& operator=(const RunCheckpointing&) = delete;
+    
+    // Loads the checkpoint at path to resume the run writing eventFile;
+    // nullptr, after printing why, if it cannot be resumed
+    static std::unique_ptr<Checkpoint::State> Load(const G4String& path, const G4String& eventFile);
+    
+    // Checkpoints of run to path every interval seconds. resume holds what
+    // earlier jobs finished (nullptr for a new run); writer is the run's
+    // event output or nullptr.
+    void Start(const G4Run* run, const G4String& path, G4double interval, const Checkpoint::State* resume,
+               const EventFile::AsyncEventWriter* writer, G4bool binaryEvents);
+    // Waits for the checkpoint being written, if any, and reports a failed
+    // write. Returns whether the run was checkpointed.
+    G4bool Stop();
+    std::uint32_t GetNumberOfCheckpoints() const { return fCoordinator.GetNumberOfCheckpoints(); }
+
+private:
+    static Checkpoint::Coordinator::Snapshot GetSnapshot(const Run* run);
+    
+    Checkpoint::Coordinator fCoordinator;
+};
+
+#endif // RUNCHECKPOINTING_HH
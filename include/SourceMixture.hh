@@ -0,0 +1,103 @@
+// include/SourceMixture.hh
+#ifndef SOURCEMIXTURE_HH
+#define SOURCEMIXTURE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Source of several isotopes and decay branches, sampled per event
+//
+// Isotopes are given with their half-life and activity at age 0; chain
+// daughters are fed by their parents. SetAge() evolves the activities with
+// the Bateman solution
+//
+//   A_i(t) = sum_j a_ij exp(-lambda_j t),
+//   a_ij = lambda_i sum_p b_pi a_pj / (lambda_i - lambda_j)   (j != i)
+//   a_ii = A_i(0) - sum_{j != i} a_ij
+//
+// (b_pi the fraction of parent p decays feeding i), and each branch gets
+// the weight A_i(t) x branching ratio. A Walker alias table over the
+// weights picks the branch of an event from one uniform.
+//
+// Decay modes are opaque codes (the caller's enum value), so this class
+// depends on neither Geant4 nor the generators.
+//==============================================================================
+
+class SourceMixture {
+public:
+    struct Branch {
+        int decayType = 0;           // Caller's decay mode code
+        int daughterZ = 0;
+        int daughterA = 0;
+        double qValue = 0.0;         // Kinetic energy of the leptons, MeV
+        double ratio = 1.0;          // Branching ratio
+        std::vector<double> gammas;  // Emitted with the decay, MeV
+        std::size_t isotope = 0;     // Set by AddBranch
+    };
+
+    struct Isotope {
+        std::string name;
+        double halfLife;             // s; 0 or infinite for a constant activity
+        double initialActivity;      // Bq at age 0
+        double activity;             // Bq at the current age
+    };
+
+    // Returns the isotope index
+    std::size_t AddIsotope(const std::string& name, double halfLife, double initialActivity);
+    // Every decay of parent feeds daughter with this fraction. Daughters
+    // come after their parents; half-lives within a chain must differ.
+    // Throws std::invalid_argument otherwise.
+    void AddFeeding(std::size_t parent, std::size_t daughter, double fraction);
+    void AddBranch(std::size_t isotope, const Branch& branch);
+    void Clear();
+
+    // Age in seconds since the initial activities
+    void SetAge(double age);
+    double GetAge() const { return fAge; }
+
+    bool IsEmpty() const { return fBranches.empty(); }
+    std::size_t GetNumberOfIsotopes() const { return fIsotopes.size(); }
+    std::size_t GetNumberOfBranches() const { return fBranches.size(); }
+    const Isotope& GetIsotope(std::size_t i) const { return fIsotopes[i]; }
+    const Branch& GetBranch(std::size_t i) const { return fBranches[i]; }
+    // Index of an isotope by name, GetNumberOfIsotopes() if absent
+    std::size_t FindIsotope(const std::string& name) const;
+
+    // Bq at the current age, summed over the isotopes
+    double GetTotalActivity() const;
+    // Probability of branch i per event
+    double GetBranchProbability(std::size_t i) const;
+
+    // Branch index from a uniform in [0, 1); the source must not be empty
+    std::size_t Select(double u) const {
+        const double x = u*fBranches.size();
+        std::size_t i = static_cast<std::size_t>(x);
+        if (i >= fBranches.size()) i = fBranches.size() - 1;
+        return x - i < fProbability[i] ? i : fAlias[i];
+    }
+
+private:
+    struct Feeding {
+        std::size_t parent;
+        std::size_t daughter;
+        double fraction;
+    };
+
+    // Activities at fAge and the alias table
+    void Update();
+    double DecayConstant(std::size_t isotope) const;
+
+    std::vector<Isotope> fIsotopes;
+    std::vector<Feeding> fFeedings;
+    std::vector<Branch> fBranches;
+    double fAge = 0.0;
+
+    std::vector<double> fWeight;     // Per branch, Bq
+    std::vector<double> fProbability;
+    std::vector<std::uint32_t> fAlias;
+};
+
+#endif // SOURCEMIXTURE_HH
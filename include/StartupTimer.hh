@@ -0,0 +1,52 @@
+// include/StartupTimer.hh
+#ifndef STARTUPTIMER_HH
+#define STARTUPTIMER_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+// Job startup timing
+//
+// main() starts the clock and marks the end of each startup step (run
+// manager, kernel initialization, ...) on the master thread. The primary
+// generator calls FirstEvent() for every event; only the first call of the
+// job records the time, later calls are a relaxed atomic load. The report
+// gives the steps and the time to first event, which dominates short jobs.
+//==============================================================================
+
+class StartupTimer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static void Start();
+    // End of a startup step, measured from the previous mark
+    static void Mark(const std::string& step);
+
+    static void FirstEvent() {
+        if (fFirstEventNs.load(std::memory_order_relaxed) < 0) RecordFirstEvent();
+    }
+
+    // Seconds from Start() to the first event, or -1 before it
+    static double GetTimeToFirstEvent();
+
+    static void Report(std::ostream& out);
+
+private:
+    static void RecordFirstEvent();
+    static double Seconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    }
+
+    static Clock::time_point fStart;
+    static std::vector<std::pair<std::string, double> > fSteps;   // Name, seconds
+    static Clock::time_point fLastMark;
+    static std::atomic<std::int64_t> fFirstEventNs;
+};
+
+#endif // STARTUPTIMER_HH
@@ -0,0 +1,32 @@
+// include/SteppingAction.hh
+#ifndef STEPPINGACTION_HH
+#define STEPPINGACTION_HH
+
+#include "G4UserSteppingAction.hh"
+#include "globals.hh"
+
+class EventAction;
+class DetectorConstruction;
+class G4LogicalVolume;
+
+// Records energy deposits in the Source and Detector volumes into the
+// per-event table of EventAction, and detector deposits also per crystal
+// (copy-number index, see DetectorConstruction). The logical volumes are
+// looked up again only when the geometry has been rebuilt; a step costs two
+// pointer compares for the volume and up to three for the particle species.
+class SteppingAction : public G4UserSteppingAction {
+public:
+    SteppingAction(EventAction* eventAction);
+    virtual ~SteppingAction();
+    
+    virtual void UserSteppingAction(const G4Step* step);
+    
+private:
+    EventAction* fEventAction;
+    const DetectorConstruction* fDetector;
+    G4int fGeometryVersion;
+    const G4LogicalVolume* fSourceVolume;
+    const G4LogicalVolume* fDetectorVolume;
+};
+
+#endif // STEPPINGACTION_HH
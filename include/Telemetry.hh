@@ -0,0 +1,86 @@
+// include/Telemetry.hh
+#ifndef TELEMETRY_HH
+#define TELEMETRY_HH
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+//==============================================================================
+// Run progress and throughput telemetry
+//
+// Every event-processing thread owns one Counter (its own cache line) and
+// bumps it with a relaxed atomic add at the end of each event; nothing else
+// happens on the event path. A single reporter thread wakes up at a fixed
+// wall-clock interval, sums the counters and prints one progress line: done
+// and expected events, the rate over the last interval, the ETA and how
+// evenly the events are spread over the threads.
+//
+// Start() and Stop() are called by the master around the run. Counters stay
+// valid until the next Start().
+//==============================================================================
+
+class Telemetry {
+public:
+    struct alignas(64) Counter {
+        std::atomic<std::uint64_t> events{0};
+
+        void AddEvent() { events.fetch_add(1, std::memory_order_relaxed); }
+    };
+
+    struct Snapshot {
+        std::uint64_t events = 0;
+        std::uint64_t expectedEvents = 0;
+        double seconds = 0.0;               // Since Start()
+        std::uint64_t minThreadEvents = 0;
+        std::uint64_t maxThreadEvents = 0;
+        int threads = 0;
+
+        double GetRate() const { return seconds > 0.0 ? events/seconds : 0.0; }
+        // Least over most loaded thread (1 = perfectly balanced)
+        double GetBalance() const {
+            return maxThreadEvents > 0 ? double(minThreadEvents)/maxThreadEvents : 1.0;
+        }
+    };
+
+    Telemetry();
+    ~Telemetry();
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Reset the counters of nThreads threads and, if interval > 0 s, start
+    // the reporter writing to out
+    void Start(std::uint64_t expectedEvents, int nThreads, double interval, std::ostream& out);
+    // Stop the reporter; the counters keep their values
+    void Stop();
+
+    // Counter of thread `thread` (0 .. nThreads-1; other ids wrap around)
+    Counter* GetCounter(int thread) {
+        return &fCounters[static_cast<unsigned>(thread) % static_cast<unsigned>(fNThreads)];
+    }
+
+    Snapshot GetSnapshot() const;
+
+private:
+    void Report();
+
+    std::unique_ptr<Counter[]> fCounters;
+    int fNThreads;
+    std::uint64_t fExpectedEvents;
+    std::chrono::steady_clock::time_point fStart;
+    double fInterval;
+    std::ostream* fOut;
+
+    std::thread fReporter;
+    std::mutex fMutex;
+    std::condition_variable fWake;
+    bool fStopping;
+};
+
+#endif // TELEMETRY_HH
@@ -2,6 +2,7 @@
 #include "ActionInitialization.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
+#include "SteppingAction.hh"
 #include "BetaDecay.hh"
 
 ActionInitialization::ActionInitialization() {}
@@ -13,17 +14,21 @@ void ActionInitialization::Build() const {
     BetaDecayPrimaryGenerator* primaryGenerator = new BetaDecayPrimaryGenerator();
     SetUserAction(primaryGenerator);
     
-    // Create run action
-    RunAction* runAction = new RunAction();
+    // Create run action (a resumed run sets the generator's event ids)
+    RunAction* runAction = new RunAction(primaryGenerator);
     SetUserAction(runAction);
     
     // Create event action (pass run action for data collection)
-    EventAction* eventAction = new EventAction(runAction);
+    EventAction* eventAction = new EventAction(runAction, primaryGenerator);
     SetUserAction(eventAction);
+    
+    // Create stepping action (energy deposits into the event action)
+    SetUserAction(new SteppingAction(eventAction));
 }
 
 void ActionInitialization::BuildForMaster() const {
-    // For multi-threaded runs (master thread)
+    // For multi-threaded runs (master thread): receives the merged Run
+    // and writes the combined output
     RunAction* runAction = new RunAction();
     SetUserAction(runAction);
 }
\ No newline at end of file
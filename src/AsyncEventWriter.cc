@@ -0,0 +1,249 @@
+// src/AsyncEventWriter.cc
+#include "AsyncEventWriter.hh"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace EventFile {
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double SecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    AsyncEventWriter::Settings Sanitize(AsyncEventWriter::Settings settings) {
+        if (settings.bufferRecords < 1) settings.bufferRecords = 1;
+        if (settings.buffersPerProducer < 2) settings.buffersPerProducer = 2;
+        return settings;
+    }
+}
+
+//==============================================================================
+// AsyncEventWriter
+//==============================================================================
+
+AsyncEventWriter::AsyncEventWriter(const std::string& path, Format format,
+                                   const Settings& settings, bool append)
+    : fFormat(format), fPath(path), fSettings(Sanitize(settings)),
+      fStopping(false), fClosed(false) {
+    if (fFormat == Format::Binary) {
+        // One buffer becomes one chunk
+        fBinaryFile.reset(new EventFileWriter(path, fSettings.bufferRecords, append));
+        fPosition.offset = fBinaryFile->GetBytesWritten();
+        fPosition.chunks = fBinaryFile->GetIndex();
+    } else {
+        fTextFile.open(path, append ? std::ios::binary | std::ios::app : std::ios::binary);
+        if (!fTextFile.is_open()) {
+            throw std::runtime_error("AsyncEventWriter: cannot open " + path);
+        }
+        if (!append) WriteTextHeader(fTextFile);
+        fTextFile.flush();
+        std::ifstream written(path, std::ios::binary | std::ios::ate);
+        fPosition.offset = static_cast<std::uint64_t>(written.tellg());
+    }
+
+    fThread = std::thread(&AsyncEventWriter::WriterLoop, this);
+}
+
+AsyncEventWriter::~AsyncEventWriter() {
+    try {
+        Close();
+    } catch (const std::exception&) {
+        // Destructors must not throw; call Close() to see write errors
+    }
+}
+
+std::unique_ptr<AsyncEventWriter::Producer> AsyncEventWriter::CreateProducer() {
+    return std::unique_ptr<Producer>(new Producer(this));
+}
+
+void AsyncEventWriter::Submit(Buffer* buffer) {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (!fClosed) {
+            fQueue.push_back(buffer);
+            fWork.notify_one();
+            return;
+        }
+        // Too late: the file is finished. Hand the buffer straight back so
+        // the producer does not wait forever.
+        buffer->records.clear();
+        buffer->owner->fFree.push_back(buffer);
+    }
+    fReturned.notify_all();
+}
+
+AsyncEventWriter::Buffer* AsyncEventWriter::Acquire(Producer* producer) {
+    std::unique_lock<std::mutex> lock(fMutex);
+    if (producer->fFree.empty()) {
+        const Clock::time_point start = Clock::now();
+        fReturned.wait(lock, [producer] { return !producer->fFree.empty(); });
+        fStatistics.stalls++;
+        fStatistics.stallSeconds += SecondsSince(start);
+    }
+    Buffer* buffer = producer->fFree.back();
+    producer->fFree.pop_back();
+    return buffer;
+}
+
+void AsyncEventWriter::Release(Producer* producer) {
+    std::unique_lock<std::mutex> lock(fMutex);
+    fReturned.wait(lock, [producer] {
+        return producer->fFree.size() == producer->fBuffers.size();
+    });
+}
+
+void AsyncEventWriter::WriterLoop() {
+    for (;;) {
+        Buffer* buffer;
+        bool failed;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fWork.wait(lock, [this] { return !fQueue.empty() || fStopping; });
+            if (fQueue.empty()) return;
+            buffer = fQueue.front();
+            fQueue.pop_front();
+            failed = static_cast<bool>(fError);
+        }
+
+        // The file is only touched by this thread until Close() joins it
+        const Clock::time_point start = Clock::now();
+        const std::uint64_t bytesBefore = fBinaryFile ? fBinaryFile->GetBytesWritten() : 0;
+        std::exception_ptr error;
+        if (!failed) {
+            try {
+                WriteBuffer(*buffer);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        const double seconds = SecondsSince(start);
+
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            if (error && !fError) fError = error;
+            if (!failed && !error) {
+                const std::uint64_t bytes = fBinaryFile ? fBinaryFile->GetBytesWritten() - bytesBefore
+                                                        : fTextScratch.size();
+                fStatistics.records += buffer->records.size();
+                fStatistics.buffers++;
+                fStatistics.bytes += bytes;
+                fPosition.offset += bytes;
+                if (fBinaryFile && bytes > 0) fPosition.chunks.push_back(fBinaryFile->GetIndex().back());
+            }
+            fStatistics.writeSeconds += seconds;
+            buffer->records.clear();
+            buffer->owner->fFree.push_back(buffer);
+        }
+        fReturned.notify_all();
+    }
+}
+
+void AsyncEventWriter::WriteBuffer(const Buffer& buffer) {
+    const std::vector<EventRecord>& records = buffer.records;
+    if (records.empty()) return;
+
+    if (fFormat == Format::Binary) {
+        fBinaryFile->WriteChunk(*EncodeChunk(records.data(),
+                                             static_cast<std::uint32_t>(records.size())));
+        fBinaryFile->Flush();
+        return;
+    }
+
+    fTextScratch.clear();
+    char line[160];
+    for (const EventRecord& record : records) {
+        fTextScratch.append(line, FormatTextLine(record, line, sizeof(line)));
+    }
+    fTextFile.write(fTextScratch.data(), fTextScratch.size());
+    fTextFile.flush();
+    if (!fTextFile) {
+        throw std::runtime_error("AsyncEventWriter: write failed on " + fPath);
+    }
+}
+
+void AsyncEventWriter::Close(const TextSummary& summary) {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (fClosed || fStopping) return;
+        fStopping = true;
+    }
+    fWork.notify_all();
+    if (fThread.joinable()) fThread.join();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fClosed = true;
+        error = fError;
+    }
+
+    if (fBinaryFile) {
+        fBinaryFile->Close();
+    } else {
+        WriteTextSummary(fTextFile, summary);
+        fTextFile.close();
+        if (!fTextFile && !error) {
+            throw std::runtime_error("AsyncEventWriter: close failed on " + fPath);
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+AsyncEventWriter::Statistics AsyncEventWriter::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    Statistics statistics = fStatistics;
+    if (fBinaryFile && fClosed) {
+        // Header, index and trailer
+        statistics.bytes = fBinaryFile->GetBytesWritten();
+    }
+    return statistics;
+}
+
+AsyncEventWriter::Position AsyncEventWriter::GetPosition() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fPosition;
+}
+
+//==============================================================================
+// AsyncEventWriter::Producer
+//==============================================================================
+
+AsyncEventWriter::Producer::Producer(AsyncEventWriter* writer)
+    : fWriter(writer), fCapacity(writer->fSettings.bufferRecords), fCurrent(nullptr) {
+    // All allocation happens here, none while events are recorded
+    for (std::uint32_t i = 0; i < writer->fSettings.buffersPerProducer; ++i) {
+        std::unique_ptr<Buffer> buffer(new Buffer);
+        buffer->records.reserve(fCapacity);
+        buffer->owner = this;
+        fFree.push_back(buffer.get());
+        fBuffers.push_back(std::move(buffer));
+    }
+    fCurrent = fFree.back();
+    fFree.pop_back();
+}
+
+AsyncEventWriter::Producer::~Producer() {
+    Flush();
+}
+
+void AsyncEventWriter::Producer::Submit() {
+    fWriter->Submit(fCurrent);
+    fCurrent = fWriter->Acquire(this);
+}
+
+void AsyncEventWriter::Producer::Flush() {
+    if (!fCurrent->records.empty()) {
+        fWriter->Submit(fCurrent);
+    } else {
+        std::lock_guard<std::mutex> lock(fWriter->fMutex);
+        fFree.push_back(fCurrent);
+    }
+    fCurrent = nullptr;
+    fWriter->Release(this);
+    fCurrent = fWriter->Acquire(this);
+}
+
+} // namespace EventFile
@@ -1,61 +1,757 @@
 // src/BetaDecay.cc - Minimal Geant4 Implementation
 #include "BetaDecay.hh"
+#include "BetaDecayMessenger.hh"
+#include "BetaSpectrumMath.hh"
+#include "DetectorConstruction.hh"
+#include "PhaseProfile.hh"
+#include "PrimaryReplayGenerator.hh"
+#include "StartupTimer.hh"
 #include "G4Event.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4ParticleTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
 #include "Randomize.hh"
 
-BetaDecayPrimaryGenerator::BetaDecayPrimaryGenerator() {
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Default for /betadecay/gun/seed
+    constexpr G4long DEFAULT_SEED = 12345;
+}
+
+BetaDecayPrimaryGenerator::BetaDecayPrimaryGenerator()
+    : fReplay(nullptr), fReplayFirstEvent(0), fSeed(DEFAULT_SEED), fStreamPerRun(true), fFirstEvent(0),
+      fReseedTransport(false), fBiasing(EmissionBiasing::ISOTROPIC), fBiasAxis(0., 0., 1.),
+      fBiasAngle(30.0*deg), fBiasMargin(2.0*deg), fBiasFraction(1.0), fConeAxis(0., 0., 1.),
+      fConeCos(-1.0), fBiasGeometryVersion(-1), fDirectionWeight(1.0) {
     fParticleGun = new G4ParticleGun(1);
-    
+
     // Default: Carbon-14 beta decay
     fDecayType = BetaDecayType::BETA_MINUS;
     fParentNucleus = BetaDecayIsotopes::C14;
     fQValue = BetaDecayIsotopes::QValues::C14_BETA_MINUS * MeV;
     fSourcePosition = G4ThreeVector(0., 0., 0.);
+    UpdateDaughterNucleus();
+
+    G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+    fElectron = particleTable->FindParticle("e-");
+    fPositron = particleTable->FindParticle("e+");
+    fNeutrino = particleTable->FindParticle("nu_e");
+    fAntiNeutrino = particleTable->FindParticle("anti_nu_e");
+    fGamma = particleTable->FindParticle("gamma");
+
+    fMessenger = new BetaDecayMessenger(this);
 }
 
 BetaDecayPrimaryGenerator::~BetaDecayPrimaryGenerator() {
+    delete fMessenger;
+    delete fReplay;
     delete fParticleGun;
 }
 
 void BetaDecayPrimaryGenerator::GeneratePrimaries(G4Event* event) {
-    // Simple: generate one electron
-    G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
-    G4ParticleDefinition* electron = particleTable->FindParticle("e-");
-    
-    fParticleGun->SetParticleDefinition(electron);
-    
-    // Random energy up to Q-value
-    G4double energy = G4UniformRand() * fQValue;
-    fParticleGun->SetParticleEnergy(energy);
-    
+    StartupTimer::FirstEvent();
+
+    // Generation is the first phase of an event
+    if (PhaseProfile* profile = PhaseProfile::GetActive()) profile->BeginEvent();
+    PhaseProfile::Scope timer(PhaseProfile::GENERATION);
+
+    // Event ids restart at 0 every run: the run picks the family of
+    // streams (unless pinned to the seed's), the global event id (all 64
+    // bits) the stream
+    const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+    const std::uint64_t runId = run && fStreamPerRun ? static_cast<std::uint64_t>(run->GetRunID()) : 0;
+    const G4long globalId = GetGlobalEventId(event->GetEventID());
+    fRandom.SetStream(CounterRandom::FamilySeed(static_cast<std::uint64_t>(fSeed), runId),
+                      static_cast<std::uint64_t>(globalId));
+
+    if (fReseedTransport) {
+        const std::uint64_t bits = fRandom.Next();
+        const long seeds[3] = {static_cast<long>(bits & 0x7fffffff),
+                               static_cast<long>((bits >> 32) & 0x7fffffff), 0};
+        G4Random::setTheSeeds(seeds);
+    }
+
+    if (fReplay) {
+        fReplay->GenerateRecord(event, fReplayFirstEvent + globalId);
+        return;
+    }
+
     // Source position
     fParticleGun->SetParticlePosition(fSourcePosition);
-    
+
+    if (fSource.IsEmpty()) GenerateDecay(event);
+    else GenerateSourceDecay(event);
+}
+
+void BetaDecayPrimaryGenerator::GenerateDecay(G4Event* event) {
+    switch (fDecayType) {
+        case BetaDecayType::BETA_MINUS:        GenerateBetaMinus(event); break;
+        case BetaDecayType::BETA_PLUS:         GenerateBetaPlus(event); break;
+        case BetaDecayType::ELECTRON_CAPTURE:  GenerateElectronCapture(event); break;
+        case BetaDecayType::DOUBLE_BETA_MINUS: GenerateDoubleBetaMinus(event); break;
+        case BetaDecayType::DOUBLE_BETA_PLUS:  GenerateDoubleBetaPlus(event); break;
+        case BetaDecayType::DOUBLE_BETA_0NU:   GenerateDoubleBeta0Nu(event); break;
+    }
+}
+
+void BetaDecayPrimaryGenerator::GenerateSourceDecay(G4Event* event) {
+    const std::size_t index = fSource.Select(fRandom.Uniform());
+    const SourceMixture::Branch& branch = fSource.GetBranch(index);
+    SourceTables& tables = fSourceTables[index];
+
+    // The branch stands in for the single-source configuration during the
+    // event. Its spectrum tables stay with it, so that switching branches
+    // costs no cache lookup.
+    const BetaDecayType type = fDecayType;
+    const G4double qValue = fQValue;
+    const G4int daughterZ = fDaughterNucleus.Z;
+    const G4int daughterA = fDaughterNucleus.A;
+    fDecayType = static_cast<BetaDecayType>(branch.decayType);
+    fQValue = branch.qValue*MeV;
+    fDaughterNucleus.Z = branch.daughterZ;
+    fDaughterNucleus.A = branch.daughterA;
+    fSpectrumTable.swap(tables.spectrum);
+    fDoubleBetaTable.swap(tables.doubleBeta);
+
+    const G4int nVertices = event->GetNumberOfPrimaryVertex();
+    GenerateDecay(event);
+
+    fSpectrumTable.swap(tables.spectrum);
+    fDoubleBetaTable.swap(tables.doubleBeta);
+    fDecayType = type;
+    fQValue = qValue;
+    fDaughterNucleus.Z = daughterZ;
+    fDaughterNucleus.A = daughterA;
+
+    // Prompt gammas join the decay vertex. They are isotropic, so the
+    // vertex weight of a biased lepton direction stays correct.
+    if (branch.gammas.empty()) return;
+    G4PrimaryVertex* vertex = nullptr;
+    if (event->GetNumberOfPrimaryVertex() > nVertices) {
+        vertex = event->GetPrimaryVertex(event->GetNumberOfPrimaryVertex() - 1);
+    } else {
+        vertex = new G4PrimaryVertex(fSourcePosition, 0.);
+        event->AddPrimaryVertex(vertex);
+    }
+    for (G4double energy : branch.gammas) {
+        G4PrimaryParticle* gamma = new G4PrimaryParticle(fGamma);
+        gamma->SetKineticEnergy(energy*MeV);
+        gamma->SetMomentumDirection(IsotropicDirection());
+        vertex->SetPrimary(gamma);
+    }
+}
+
+G4bool BetaDecayPrimaryGenerator::AddSourceIsotope(const G4String& name, G4double activity) {
+    if (!BetaDecayUtils::AddSource(fSource, name, activity/becquerel)) return false;
+    // The branches may have been reordered
+    fSourceTables.clear();
+    fSourceTables.resize(fSource.GetNumberOfBranches());
+    return true;
+}
+
+void BetaDecayPrimaryGenerator::SetSourceAge(G4double age) {
+    fSource.SetAge(age/second);
+}
+
+void BetaDecayPrimaryGenerator::ClearSource() {
+    fSource.Clear();
+    fSourceTables.clear();
+}
+
+void BetaDecayPrimaryGenerator::PrintSource() const {
+    if (fSource.IsEmpty()) {
+        G4cout << "Source: " << BetaDecayPhysics::GetElementSymbol(fParentNucleus.Z) << "-"
+               << fParentNucleus.A << " ("
+               << BetaDecayUtils::DecayTypeToString(fDecayType) << ", Q = " << fQValue/MeV
+               << " MeV)" << G4endl;
+        return;
+    }
+
+    const G4double total = fSource.GetTotalActivity();
+    G4cout << "Source at age " << fSource.GetAge()*second/day << " d: " << total << " Bq";
+    if (total > 0.) G4cout << ", 1e6 events = " << 1.0e6/total << " s";
+    G4cout << G4endl;
+    for (std::size_t i = 0; i < fSource.GetNumberOfIsotopes(); ++i) {
+        const SourceMixture::Isotope& isotope = fSource.GetIsotope(i);
+        G4cout << "  " << isotope.name << ": " << isotope.activity << " Bq (" << isotope.initialActivity
+               << " Bq at age 0)" << G4endl;
+        for (std::size_t b = 0; b < fSource.GetNumberOfBranches(); ++b) {
+            const SourceMixture::Branch& branch = fSource.GetBranch(b);
+            if (branch.isotope != i) continue;
+            G4cout << "    " << BetaDecayUtils::DecayTypeToString(static_cast<BetaDecayType>(branch.decayType))
+                   << " Q = " << branch.qValue << " MeV";
+            for (G4double gamma : branch.gammas) G4cout << " + " << gamma << " MeV gamma";
+            G4cout << ": " << fSource.GetBranchProbability(b) << " of the events" << G4endl;
+        }
+    }
+}
+
+void BetaDecayPrimaryGenerator::SetParentNucleus(G4int Z, G4int A, G4double excitation) {
+    fParentNucleus = Nucleus(Z, A, excitation);
+    UpdateDaughterNucleus();
+}
+
+G4bool BetaDecayPrimaryGenerator::SetIsotope(const G4String& name) {
+    Nucleus parent;
+    BetaDecayType type;
+    G4double qValue;
+    if (!BetaDecayUtils::FindIsotope(name, parent, type, qValue)) return false;
+
+    fDecayType = type;
+    fParentNucleus = parent;
+    fQValue = qValue*MeV;
+    UpdateDaughterNucleus();
+    return true;
+}
+
+G4bool BetaDecayPrimaryGenerator::SetReplayFile(const G4String& fileName) {
+    if (fileName.empty()) {
+        delete fReplay;
+        fReplay = nullptr;
+        return true;
+    }
+
+    PrimaryReplayGenerator* replay = nullptr;
+    try {
+        replay = new PrimaryReplayGenerator(fileName);
+    } catch (const std::runtime_error& e) {
+        G4cerr << "ERROR: " << e.what() << G4endl;
+        return false;
+    }
+    replay->SetFirstEvent(fReplayFirstEvent);
+    delete fReplay;
+    fReplay = replay;
+
+    if (G4Threading::G4GetThreadId() <= 0) {
+        G4cout << "Replaying " << fReplay->GetNumberOfEvents() << " primary events from "
+               << fileName << G4endl;
+    }
+    return true;
+}
+
+void BetaDecayPrimaryGenerator::SetReplayFirstEvent(G4long first) {
+    fReplayFirstEvent = first > 0 ? first : 0;
+    if (fReplay) fReplay->SetFirstEvent(fReplayFirstEvent);
+}
+
+void BetaDecayPrimaryGenerator::SetFirstEvent(G4long first) {
+    fFirstEvent = first > 0 ? first : 0;
+}
+
+void BetaDecayPrimaryGenerator::SetBiasing(EmissionBiasing mode) {
+    fBiasing = mode;
+    if (fBiasing == EmissionBiasing::CONE) {
+        fConeAxis = fBiasAxis;
+        fConeCos = std::cos(fBiasAngle);
+    }
+    fBiasGeometryVersion = -1;
+}
+
+void BetaDecayPrimaryGenerator::SetBiasCone(const G4ThreeVector& axis, G4double halfAngle) {
+    if (axis.mag2() > 0.) fBiasAxis = axis.unit();
+    fBiasAngle = std::min(std::max(halfAngle, 0.), pi);
+    SetBiasing(fBiasing);
+}
+
+void BetaDecayPrimaryGenerator::SetBiasMargin(G4double angle) {
+    fBiasMargin = std::max(angle, 0.);
+    fBiasGeometryVersion = -1;
+}
+
+void BetaDecayPrimaryGenerator::SetBiasFraction(G4double fraction) {
+    fBiasFraction = std::min(std::max(fraction, 0.), 1.);
+}
+
+void BetaDecayPrimaryGenerator::SetSpectrumValidation(G4int nSamples) {
+    BetaSpectrumTable::SetValidationSamples(nSamples > 0 ? nSamples : 0);
+    fSpectrumTable.reset();
+}
+
+void BetaDecayPrimaryGenerator::GenerateBetaMinus(G4Event* event) {
+    fParticleGun->SetParticleDefinition(fElectron);
+
+    // Energy from the Coulomb-corrected allowed spectrum
+    G4double energy = SampleBetaSpectrum(fQValue, fDaughterNucleus.Z);
+    fParticleGun->SetParticleEnergy(energy);
+
     // Random direction
-    fParticleGun->SetParticleMomentumDirection(G4RandomDirection());
-    
+    fParticleGun->SetParticleMomentumDirection(SampleDirection());
+
     // Generate
     fParticleGun->GeneratePrimaryVertex(event);
-    
-    // Print info
-    G4cout << "Generated beta decay electron: " 
-           << energy/MeV << " MeV" << G4endl;
+    SetVertexWeight(event);
 }
 
-void BetaDecayPrimaryGenerator::SetParentNucleus(G4int Z, G4int A, G4double excitation) {
-    fParentNucleus = Nucleus(Z, A, excitation);
+void BetaDecayPrimaryGenerator::GenerateBetaPlus(G4Event* event) {
+    fParticleGun->SetParticleDefinition(fPositron);
+
+    G4double energy = SampleBetaSpectrum(fQValue, fDaughterNucleus.Z);
+    fParticleGun->SetParticleEnergy(energy);
+    fParticleGun->SetParticleMomentumDirection(SampleDirection());
+    fParticleGun->GeneratePrimaryVertex(event);
+    SetVertexWeight(event);
+}
+
+G4double BetaDecayPrimaryGenerator::SampleBetaSpectrum(G4double qValue, G4int Z) {
+    const BetaSpectrumTable::Lepton lepton = GetSpectrumLepton();
+    const G4double q = qValue/MeV;
+
+    // Only a configuration change goes back to the shared cache
+    if (!fSpectrumTable || fSpectrumTable->GetZ() != Z ||
+        fSpectrumTable->GetQValue() != q || fSpectrumTable->GetLepton() != lepton) {
+        BetaSpectrumTable::ValidationResult validation;
+        fSpectrumTable = BetaSpectrumTable::Get(Z, q, lepton, &validation);
+
+        if (validation.nSamples > 0) {
+            G4cout << "Beta spectrum validation (Z=" << Z << ", Q=" << q << " MeV, "
+                   << (lepton == BetaSpectrumTable::Lepton::Positron ? "e+" : "e-") << "): "
+                   << validation.nSamples << " samples, chi2/ndf = "
+                   << validation.chi2 << "/" << validation.ndf
+                   << ", max pull " << validation.maxPull
+                   << " at " << validation.maxPullEnergy << " MeV" << G4endl;
+        }
+    }
+
+    const G4double u1 = fRandom.Uniform();
+    const G4double u2 = fRandom.Uniform();
+    return fSpectrumTable->Sample(u1, u2) * MeV;
+}
+
+G4ThreeVector BetaDecayPrimaryGenerator::SampleDirection() {
+    if (fBiasing == EmissionBiasing::ISOTROPIC) {
+        fDirectionWeight = 1.0;
+        return IsotropicDirection();
+    }
+
+    UpdateBiasCone();
+
+    // Uniform inside the cone with probability fBiasFraction, else uniform
+    // outside it; the weight is the ratio of the solid-angle fractions
+    const G4double inside = 0.5*(1.0 - fConeCos);
+    G4double cosTheta;
+    if (fRandom.Uniform() < fBiasFraction) {
+        cosTheta = 1.0 - fRandom.Uniform()*(1.0 - fConeCos);
+        fDirectionWeight = inside/fBiasFraction;
+    } else {
+        cosTheta = fConeCos - fRandom.Uniform()*(1.0 + fConeCos);
+        fDirectionWeight = (1.0 - inside)/(1.0 - fBiasFraction);
+    }
+    const G4double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
+    const G4double phi = twopi*fRandom.Uniform();
+    G4ThreeVector direction(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+    return direction.rotateUz(fConeAxis);
+}
+
+G4ThreeVector BetaDecayPrimaryGenerator::IsotropicDirection() {
+    const G4double cosTheta = 2.0*fRandom.Uniform() - 1.0;
+    const G4double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
+    const G4double phi = twopi*fRandom.Uniform();
+    return G4ThreeVector(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+}
+
+void BetaDecayPrimaryGenerator::SetVertexWeight(G4Event* event) const {
+    // The kernel gives the vertex weight to the primary tracks
+    event->GetPrimaryVertex(event->GetNumberOfPrimaryVertex() - 1)->SetWeight(fDirectionWeight);
+}
+
+void BetaDecayPrimaryGenerator::UpdateBiasCone() {
+    if (fBiasing != EmissionBiasing::DETECTOR) return;
+
+    // Recomputed when the array is rebuilt or the source moves
+    const DetectorConstruction* detector = static_cast<const DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    if (!detector || detector->GetGeometryVersion() == fBiasGeometryVersion) return;
+    fBiasGeometryVersion = detector->GetGeometryVersion();
+
+    // Widest angle to a corner of the array envelope
+    const DetectorConstruction::ArraySettings& array = detector->GetArray();
+    const G4ThreeVector centre(0., 0., array.distance);
+    const G4ThreeVector half(0.5*array.nx*array.pitch, 0.5*array.ny*array.pitch,
+                             0.5*array.crystalSize.z());
+    fConeAxis = (centre - fSourcePosition).unit();
+    G4double halfAngle = 0.;
+    for (G4int corner = 0; corner < 8; ++corner) {
+        const G4ThreeVector point(centre.x() + ((corner & 1) ? half.x() : -half.x()),
+                                  centre.y() + ((corner & 2) ? half.y() : -half.y()),
+                                  centre.z() + ((corner & 4) ? half.z() : -half.z()));
+        halfAngle = std::max(halfAngle, fConeAxis.angle(point - fSourcePosition));
+    }
+
+    // A source inside the envelope sees it in all directions
+    const G4ThreeVector offset = fSourcePosition - centre;
+    if (std::abs(offset.x()) < half.x() && std::abs(offset.y()) < half.y() &&
+        std::abs(offset.z()) < half.z()) {
+        halfAngle = pi;
+    }
+    halfAngle = std::min(halfAngle + fBiasMargin, pi);
+    fConeCos = std::cos(halfAngle);
+
+    if (G4Threading::G4GetThreadId() <= 0) {
+        G4cout << "Emission biased into a " << halfAngle/deg << " deg cone around the detector ("
+               << 0.5*(1.0 - fConeCos) << " of the sphere, " << fBiasFraction
+               << " of the primaries)" << G4endl;
+    }
+}
+
+G4double BetaDecayPrimaryGenerator::FermiFunction(G4double energy, G4int Z) {
+    const G4int chargeZ =
+        (GetSpectrumLepton() == BetaSpectrumTable::Lepton::Positron) ? -Z : Z;
+    return BetaDecayPhysics::FermiFunction(energy, chargeZ);
+}
+
+BetaSpectrumTable::Lepton BetaDecayPrimaryGenerator::GetSpectrumLepton() const {
+    return (fDecayType == BetaDecayType::BETA_PLUS ||
+            fDecayType == BetaDecayType::DOUBLE_BETA_PLUS)
+        ? BetaSpectrumTable::Lepton::Positron
+        : BetaSpectrumTable::Lepton::Electron;
+}
+
+void BetaDecayPrimaryGenerator::UpdateDaughterNucleus() {
+    fDaughterNucleus = BetaDecayUtils::GetDaughterNucleus(fParentNucleus, fDecayType);
+}
+
+void BetaDecayPrimaryGenerator::GenerateDoubleBetaMinus(G4Event* event) {
+    GenerateDoubleBeta(event, fElectron, DoubleBetaSpectrumTable::Mode::TwoNeutrino);
+}
+
+void BetaDecayPrimaryGenerator::GenerateDoubleBetaPlus(G4Event* event) {
+    GenerateDoubleBeta(event, fPositron, DoubleBetaSpectrumTable::Mode::TwoNeutrino);
+}
+
+void BetaDecayPrimaryGenerator::GenerateDoubleBeta0Nu(G4Event* event) {
+    GenerateDoubleBeta(event, fElectron, DoubleBetaSpectrumTable::Mode::Neutrinoless);
+}
+
+void BetaDecayPrimaryGenerator::GenerateDoubleBeta(G4Event* event, G4ParticleDefinition* lepton,
+                                                   DoubleBetaSpectrumTable::Mode mode) {
+    const BetaSpectrumTable::Lepton tableLepton = GetSpectrumLepton();
+    const G4int Z = fDaughterNucleus.Z;
+    const G4double q = fQValue/MeV;
+
+    // Only a configuration change goes back to the shared cache
+    if (!fDoubleBetaTable || fDoubleBetaTable->GetZ() != Z || fDoubleBetaTable->GetQValue() != q ||
+        fDoubleBetaTable->GetMode() != mode || fDoubleBetaTable->GetLepton() != tableLepton) {
+        fDoubleBetaTable = DoubleBetaSpectrumTable::Get(Z, q, mode, tableLepton);
+        if (G4Threading::G4GetThreadId() <= 0) {
+            const G4String directory = DoubleBetaSpectrumTable::GetCacheDirectory();
+            const G4String file = directory + "/" +
+                DoubleBetaSpectrumTable::CacheFileName(Z, q, mode, tableLepton);
+            G4cout << "Double beta spectrum (Z=" << Z << ", Q=" << q << " MeV, "
+                   << (mode == DoubleBetaSpectrumTable::Mode::TwoNeutrino ? "2nu" : "0nu") << "): ";
+            if (fDoubleBetaTable->IsMapped()) G4cout << "mapped from " << file;
+            else if (!directory.empty()) G4cout << "built and cached in " << file;
+            else G4cout << "built";
+            G4cout << G4endl;
+        }
+    }
+
+    G4double t1, t2;
+    const G4double u1 = fRandom.Uniform();
+    const G4double u2 = fRandom.Uniform();
+    const G4double u3 = fRandom.Uniform();
+    fDoubleBetaTable->Sample(u1, u2, u3, t1, t2);
+
+    // The first electron's direction carries the emission biasing and the
+    // second follows it at the correlated opening angle; the pair turns as
+    // a whole, so the weight of the first direction is the event weight
+    const G4ThreeVector first = SampleDirection();
+    const G4double cosTheta = DoubleBetaSpectrumTable::SampleCosTheta(t1, t2, fRandom.Uniform());
+    const G4double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
+    const G4double phi = twopi*fRandom.Uniform();
+    G4ThreeVector second(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+    second.rotateUz(first);
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(fSourcePosition, 0.);
+    const G4double energies[2] = {t1*MeV, t2*MeV};
+    const G4ThreeVector directions[2] = {first, second};
+    for (G4int i = 0; i < 2; ++i) {
+        G4PrimaryParticle* particle = new G4PrimaryParticle(lepton);
+        particle->SetKineticEnergy(energies[i]);
+        particle->SetMomentumDirection(directions[i]);
+        vertex->SetPrimary(particle);
+    }
+    event->AddPrimaryVertex(vertex);
+    SetVertexWeight(event);
+}
+
+void BetaDecayPrimaryGenerator::GenerateElectronCapture(G4Event* event) {
+    // A two-body decay: the neutrino takes Q. It leaves the world without
+    // interacting, so it is not biased. The daughter's X-rays and Auger
+    // electrons (keV) are not emitted.
+    fDirectionWeight = 1.0;
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(fSourcePosition, 0.);
+    G4PrimaryParticle* neutrino = new G4PrimaryParticle(fNeutrino);
+    neutrino->SetKineticEnergy(fQValue);
+    neutrino->SetMomentumDirection(IsotropicDirection());
+    vertex->SetPrimary(neutrino);
+    event->AddPrimaryVertex(vertex);
+    SetVertexWeight(event);
 }
 
 // Stub implementations for other required methods
-void BetaDecayPrimaryGenerator::GenerateBetaMinus(G4Event* event) { GeneratePrimaries(event); }
-void BetaDecayPrimaryGenerator::GenerateBetaPlus(G4Event* event) { GeneratePrimaries(event); }
-void BetaDecayPrimaryGenerator::GenerateElectronCapture(G4Event* event) {}
-void BetaDecayPrimaryGenerator::GenerateDoubleBetaMinus(G4Event* event) {}
-void BetaDecayPrimaryGenerator::GenerateDoubleBetaPlus(G4Event* event) {}
-void BetaDecayPrimaryGenerator::GenerateDoubleBeta0Nu(G4Event* event) {}
-G4double BetaDecayPrimaryGenerator::SampleBetaSpectrum(G4double qValue, G4int Z) { return G4UniformRand() * qValue; }
-G4double BetaDecayPrimaryGenerator::FermiFunction(G4double energy, G4int Z) { return 1.0; }
 void BetaDecayPrimaryGenerator::GenerateDecayParticles(std::vector<DecayParticle>& particles) {}
-void BetaDecayPrimaryGenerator::UpdateDaughterNucleus() {}
+
+//==============================================================================
+// BetaDecayPhysics
+//==============================================================================
+
+namespace {
+    NuclideTable::Transition ToTransition(BetaDecayType type) {
+        switch (type) {
+            case BetaDecayType::BETA_MINUS:        return NuclideTable::Transition::BetaMinus;
+            case BetaDecayType::BETA_PLUS:         return NuclideTable::Transition::BetaPlus;
+            case BetaDecayType::ELECTRON_CAPTURE:  return NuclideTable::Transition::ElectronCapture;
+            case BetaDecayType::DOUBLE_BETA_MINUS: return NuclideTable::Transition::DoubleBetaMinus;
+            case BetaDecayType::DOUBLE_BETA_PLUS:  return NuclideTable::Transition::DoubleBetaPlus;
+            case BetaDecayType::DOUBLE_BETA_0NU:   return NuclideTable::Transition::DoubleBetaMinus;
+        }
+        return NuclideTable::Transition::BetaMinus;
+    }
+}
+
+G4double BetaDecayPhysics::CalculateQValue(const Nucleus& parent, const Nucleus& daughter,
+                                           BetaDecayType type) {
+    const G4double delta = parent.A == daughter.A
+        ? NuclideTable::AtomicMassDifference(parent.Z, daughter.Z, parent.A)
+        : NuclideTable::AtomicMass(parent.Z, parent.A) - NuclideTable::AtomicMass(daughter.Z, daughter.A);
+    G4int positrons = 0;
+    if (type == BetaDecayType::BETA_PLUS) positrons = 1;
+    if (type == BetaDecayType::DOUBLE_BETA_PLUS) positrons = 2;
+    return (delta - 2.0*positrons*NuclideTable::ELECTRON_MASS)*MeV;
+}
+
+G4bool BetaDecayPhysics::IsDecayAllowed(const Nucleus& parent, BetaDecayType type,
+                                        G4double qValue) {
+    const NuclideTable::Transition transition = ToTransition(type);
+    const G4int daughterZ = parent.Z + NuclideTable::ChargeChange(transition);
+    if (NuclideTable::IsTabulated(parent.Z, parent.A) &&
+        NuclideTable::IsTabulated(daughterZ, parent.A)) {
+        return NuclideTable::QValue(parent.Z, parent.A, transition) > 0.;
+    }
+    return qValue > 0.;
+}
+
+G4double BetaDecayPhysics::GetNuclearMass(G4int Z, G4int A) {
+    return (NuclideTable::AtomicMass(Z, A) - Z*NuclideTable::ELECTRON_MASS)*MeV;
+}
+
+G4String BetaDecayPhysics::GetElementSymbol(G4int Z) {
+    const char* symbol = NuclideTable::ElementSymbol(Z);
+    return symbol ? G4String(symbol) : "Z" + std::to_string(Z);
+}
+
+G4double BetaDecayPhysics::BetaSpectrumShape(G4double energy, G4double qValue, G4int Z) {
+    return BetaSpectrumMath::SpectrumShape(energy/MeV, qValue/MeV, Z);
+}
+
+G4double BetaDecayPhysics::FermiFunction(G4double electronEnergy, G4int Z) {
+    return BetaSpectrumMath::FermiFunction(electronEnergy/MeV, Z);
+}
+
+// The batch kernels take MeV; Geant4 internal energy units are MeV, so the
+// arrays are passed through without a scaling copy
+static_assert(MeV == 1.0, "batch spectrum API assumes MeV internal energy unit");
+
+void BetaDecayPhysics::BetaSpectrumShape(const G4double* energies, G4double* values,
+                                         std::size_t n, G4double qValue, G4int Z) {
+    BetaSpectrumMath::SpectrumShape(energies, values, n, qValue/MeV, Z);
+}
+
+void BetaDecayPhysics::FermiFunction(const G4double* electronEnergies, G4double* values,
+                                     std::size_t n, G4int Z) {
+    BetaSpectrumMath::FermiFunction(electronEnergies, values, n, Z);
+}
+
+//==============================================================================
+// BetaDecayUtils
+//==============================================================================
+
+Nucleus BetaDecayUtils::GetDaughterNucleus(const Nucleus& parent, BetaDecayType type) {
+    G4int dZ = 0;
+    switch (type) {
+        case BetaDecayType::BETA_MINUS:        dZ = +1; break;
+        case BetaDecayType::BETA_PLUS:         dZ = -1; break;
+        case BetaDecayType::ELECTRON_CAPTURE:  dZ = -1; break;
+        case BetaDecayType::DOUBLE_BETA_MINUS: dZ = +2; break;
+        case BetaDecayType::DOUBLE_BETA_PLUS:  dZ = -2; break;
+        case BetaDecayType::DOUBLE_BETA_0NU:   dZ = +2; break;
+    }
+    return Nucleus(parent.Z + dZ, parent.A);
+}
+
+G4String BetaDecayUtils::DecayTypeToString(BetaDecayType type) {
+    switch (type) {
+        case BetaDecayType::BETA_MINUS:        return "beta-";
+        case BetaDecayType::BETA_PLUS:         return "beta+";
+        case BetaDecayType::ELECTRON_CAPTURE:  return "EC";
+        case BetaDecayType::DOUBLE_BETA_MINUS: return "2nu2beta-";
+        case BetaDecayType::DOUBLE_BETA_PLUS:  return "2nu2beta+";
+        case BetaDecayType::DOUBLE_BETA_0NU:   return "0nu2beta-";
+    }
+    return "unknown";
+}
+
+namespace {
+    struct Isotope {
+        const Nucleus* parent;
+        BetaDecayType type;
+        G4double qValue;
+    };
+
+    const Isotope ISOTOPES[] = {
+        {&BetaDecayIsotopes::C14,   BetaDecayType::BETA_MINUS,        BetaDecayIsotopes::QValues::C14_BETA_MINUS},
+        {&BetaDecayIsotopes::Na22,  BetaDecayType::BETA_PLUS,         BetaDecayIsotopes::QValues::Na22_BETA_PLUS},
+        {&BetaDecayIsotopes::K40,   BetaDecayType::BETA_MINUS,        BetaDecayIsotopes::QValues::K40_BETA_MINUS},
+        {&BetaDecayIsotopes::Ge76,  BetaDecayType::DOUBLE_BETA_MINUS, BetaDecayIsotopes::QValues::Ge76_DBD},
+        {&BetaDecayIsotopes::Se82,  BetaDecayType::DOUBLE_BETA_MINUS, BetaDecayIsotopes::QValues::Se82_DBD},
+        {&BetaDecayIsotopes::Xe136, BetaDecayType::DOUBLE_BETA_MINUS, BetaDecayIsotopes::QValues::Xe136_DBD},
+        {&BetaDecayIsotopes::Te130, BetaDecayType::DOUBLE_BETA_MINUS, BetaDecayIsotopes::QValues::Te130_DBD},
+        {&BetaDecayIsotopes::Mo100, BetaDecayType::DOUBLE_BETA_MINUS, BetaDecayIsotopes::QValues::Mo100_DBD}
+    };
+}
+
+G4bool BetaDecayUtils::FindIsotope(const G4String& name, Nucleus& parent, BetaDecayType& type,
+                                   G4double& qValue) {
+    for (const Isotope& isotope : ISOTOPES) {
+        if (isotope.parent->name == name) {
+            parent = *isotope.parent;
+            type = isotope.type;
+            qValue = isotope.qValue;
+            return true;
+        }
+    }
+    return false;
+}
+
+G4String BetaDecayUtils::IsotopeNames() {
+    G4String names;
+    for (const Isotope& isotope : ISOTOPES) {
+        if (!names.empty()) names += " ";
+        names += isotope.parent->name;
+    }
+    return names;
+}
+
+namespace {
+    // Built-in source isotopes (ENSDF-style rounded half-lives and branching
+    // ratios). Q is the kinetic energy shared by the leptons: to the
+    // populated level, whose de-excitation gamma follows promptly.
+    struct SourceBranchData {
+        BetaDecayType type;
+        G4double ratio;
+        G4double qValue;     // MeV
+        G4double gamma;      // MeV, 0 if none
+    };
+
+    struct SourceData {
+        const char* name;
+        G4int Z;
+        G4int A;
+        G4double halfLife;   // Years
+        const char* daughter;   // Chain daughter fed by every decay, or nullptr
+        std::vector<SourceBranchData> branches;
+    };
+
+    using NuclideTable::QValue;
+    using NuclideTable::Transition;
+    constexpr G4double Na22_GAMMA = 1.2745;   // MeV, Ne-22 2+ level
+    constexpr G4double K40_GAMMA = 1.4608;    // MeV, Ar-40 2+ level
+
+    // Parents precede their chain daughters
+    const SourceData SOURCES[] = {
+        {"C-14", 6, 14, 5700., nullptr,
+         {{BetaDecayType::BETA_MINUS, 1.0, QValue(6, 14, Transition::BetaMinus), 0.}}},
+        {"Na-22", 11, 22, 2.6018, nullptr,
+         {{BetaDecayType::BETA_PLUS, 0.9030, QValue(11, 22, Transition::BetaPlus) - Na22_GAMMA, Na22_GAMMA},
+          {BetaDecayType::ELECTRON_CAPTURE, 0.0964,
+           QValue(11, 22, Transition::ElectronCapture) - Na22_GAMMA, Na22_GAMMA},
+          {BetaDecayType::BETA_PLUS, 0.0006, QValue(11, 22, Transition::BetaPlus), 0.}}},
+        {"K-40", 19, 40, 1.248e9, nullptr,
+         {{BetaDecayType::BETA_MINUS, 0.8928, QValue(19, 40, Transition::BetaMinus), 0.},
+          {BetaDecayType::ELECTRON_CAPTURE, 0.1055,
+           QValue(19, 40, Transition::ElectronCapture) - K40_GAMMA, K40_GAMMA},
+          {BetaDecayType::ELECTRON_CAPTURE, 0.0017, QValue(19, 40, Transition::ElectronCapture), 0.}}},
+        {"Sr-90", 38, 90, 28.79, "Y-90",
+         {{BetaDecayType::BETA_MINUS, 1.0, QValue(38, 90, Transition::BetaMinus), 0.}}},
+        {"Y-90", 39, 90, 64.05/(24.*365.25), nullptr,
+         {{BetaDecayType::BETA_MINUS, 1.0, QValue(39, 90, Transition::BetaMinus), 0.}}},
+        {"Ge-76", 32, 76, 1.926e21, nullptr,
+         {{BetaDecayType::DOUBLE_BETA_MINUS, 1.0, QValue(32, 76, Transition::DoubleBetaMinus), 0.}}}
+    };
+
+    constexpr std::size_t N_SOURCES = sizeof(SOURCES)/sizeof(SOURCES[0]);
+
+    // Index in SOURCES, N_SOURCES if unknown
+    std::size_t FindSourceData(const std::string& name) {
+        for (std::size_t k = 0; k < N_SOURCES; ++k) {
+            if (name == SOURCES[k].name) return k;
+        }
+        return N_SOURCES;
+    }
+
+    // Adds isotope k of SOURCES and its chain below it, with the activities
+    // by SOURCES index; returns its index in the source
+    std::size_t AddSourceData(SourceMixture& source, std::size_t k, const std::vector<G4double>& activities) {
+        const SourceData& data = SOURCES[k];
+        const std::size_t index =
+            source.AddIsotope(data.name, data.halfLife*365.25*24.*3600., activities[k]);
+        const Nucleus parent(data.Z, data.A);
+        for (const SourceBranchData& branchData : data.branches) {
+            const Nucleus daughter = BetaDecayUtils::GetDaughterNucleus(parent, branchData.type);
+            SourceMixture::Branch branch;
+            branch.decayType = static_cast<int>(branchData.type);
+            branch.daughterZ = daughter.Z;
+            branch.daughterA = daughter.A;
+            branch.qValue = branchData.qValue;
+            branch.ratio = branchData.ratio;
+            if (branchData.gamma > 0.) branch.gammas.push_back(branchData.gamma);
+            source.AddBranch(index, branch);
+        }
+        const std::size_t daughter = data.daughter ? FindSourceData(data.daughter) : N_SOURCES;
+        if (daughter < N_SOURCES) source.AddFeeding(index, AddSourceData(source, daughter, activities), 1.0);
+        return index;
+    }
+}
+
+G4bool BetaDecayUtils::AddSource(SourceMixture& source, const G4String& name, G4double activity) {
+    const std::size_t added = FindSourceData(name);
+    if (added == N_SOURCES) return false;
+
+    // Rebuilt in the order of SOURCES, so that an isotope added before its
+    // parent (Y-90, then Sr-90) ends up as its daughter rather than twice;
+    // adding an isotope again adds to its activity
+    std::vector<G4double> activities(N_SOURCES, 0.);
+    std::vector<bool> present(N_SOURCES, false);
+    for (std::size_t i = 0; i < source.GetNumberOfIsotopes(); ++i) {
+        const std::size_t k = FindSourceData(source.GetIsotope(i).name);
+        activities[k] += source.GetIsotope(i).initialActivity;
+        present[k] = true;
+    }
+    activities[added] += activity;
+    present[added] = true;
+
+    source.Clear();
+    for (std::size_t k = 0; k < N_SOURCES; ++k) {
+        if (present[k] && source.FindIsotope(SOURCES[k].name) == source.GetNumberOfIsotopes()) {
+            AddSourceData(source, k, activities);
+        }
+    }
+    return true;
+}
+
+G4String BetaDecayUtils::SourceNames() {
+    G4String names;
+    for (const SourceData& data : SOURCES) {
+        if (!names.empty()) names += " ";
+        names += data.name;
+    }
+    return names;
+}
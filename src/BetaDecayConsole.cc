@@ -0,0 +1,569 @@
+// src/BetaDecayConsole.cc - Standalone (Geant4-free) decay generator
+//
+// Built into the BetaDecayEngine library only. BetaDecayConsole.h reuses the
+// names of the Geant4 types in BetaDecay.hh (BetaDecayType, Nucleus,
+// DecayEvent), so this file must never be linked into BetaDecaySimulation.
+#include "BetaDecayConsole.h"
+#include "BetaSpectrumMath.hh"
+#include "BetaSpectrumTable.hh"
+#include "DecayEventBatch.hh"
+#include "DoubleBetaSpectrumTable.hh"
+#include "NuclideTable.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double LN2 = 0.69314718055994530942;
+    constexpr double RYDBERG = 13.605693e-6;   // MeV
+
+    int ChargeChange(BetaDecayType type) {
+        switch (type) {
+            case BetaDecayType::BETA_MINUS:            return +1;
+            case BetaDecayType::BETA_PLUS:             return -1;
+            case BetaDecayType::ELECTRON_CAPTURE:      return -1;
+            case BetaDecayType::DOUBLE_BETA_MINUS:     return +2;
+            case BetaDecayType::DOUBLE_BETA_PLUS:      return -2;
+            case BetaDecayType::DOUBLE_BETA_MINUS_0NU: return +2;
+        }
+        return 0;
+    }
+
+    Nucleus Daughter(const Nucleus& parent, BetaDecayType type) {
+        return Nucleus(parent.atomicNumber + ChargeChange(type), parent.massNumber);
+    }
+}
+
+//==============================================================================
+// Nucleus, DecayProduct, DecayEvent
+//==============================================================================
+
+Nucleus::Nucleus(int z, int a, const std::string& sym)
+    : atomicNumber(z), massNumber(a), energy(0.0),
+      symbol(sym.empty() ? NuclearData::getElementSymbol(z) : sym) {}
+
+void Nucleus::display() const {
+    std::cout << symbol << "-" << massNumber << " (Z=" << atomicNumber
+              << ", A=" << massNumber << ")";
+    if (energy > 0.0) std::cout << " E*=" << energy << " MeV";
+    std::cout << std::endl;
+}
+
+double Nucleus::getBindingEnergy() const {
+    // From the evaluated mass where tabulated, else semi-empirical; MeV
+    const int Z = atomicNumber;
+    const int A = massNumber;
+    if (A <= 1) return 0.0;
+    return Z*NuclideTable::HYDROGEN_MASS + (A - Z)*NuclideTable::NEUTRON_MASS
+         - NuclideTable::AtomicMass(Z, A);
+}
+
+DecayProduct::DecayProduct(const std::string& p, double e)
+    : particle(p), energy(e), momentum{0.0, 0.0, 0.0} {}
+
+DecayEvent::DecayEvent()
+    : decayType(BetaDecayType::BETA_MINUS), parentNucleus(0, 0, "n"),
+      daughterNucleus(0, 0, "n"), qValue(0.0), decayTime(0.0), isSuccessful(false) {}
+
+void DecayEvent::display() const {
+    std::cout << "Decay: " << parentNucleus.symbol << "-" << parentNucleus.massNumber
+              << " -> " << daughterNucleus.symbol << "-" << daughterNucleus.massNumber
+              << " (Q = " << qValue << " MeV)" << (isSuccessful ? "" : " [failed]") << std::endl;
+    for (const DecayProduct& product : products) {
+        std::cout << "  " << std::setw(10) << std::left << product.particle << std::right
+                  << " T = " << std::setw(10) << product.energy << " MeV  p = ("
+                  << product.momentum[0] << ", " << product.momentum[1] << ", "
+                  << product.momentum[2] << ") MeV/c" << std::endl;
+    }
+}
+
+double DecayEvent::getTotalEnergy() const {
+    double total = 0.0;
+    for (const DecayProduct& product : products) total += product.energy;
+    return total;
+}
+
+//==============================================================================
+// BetaDecaySimulator
+//==============================================================================
+
+BetaDecaySimulator::BetaDecaySimulator(unsigned int seed)
+    : random(seed), nextEventId(0), numThreads(0) {}
+
+BetaDecaySimulator::~BetaDecaySimulator() {}
+
+void BetaDecaySimulator::setSeed(std::uint64_t seed) {
+    random.SetStream(seed, 0);
+    nextEventId = 0;
+}
+
+double BetaDecaySimulator::fermiFunction(double electronEnergy, int Z) {
+    return BetaSpectrumMath::FermiFunction(electronEnergy, Z);
+}
+
+double BetaDecaySimulator::betaSpectrum(double electronEnergy, double qValue, int Z) {
+    return BetaSpectrumMath::SpectrumShape(electronEnergy, qValue, Z);
+}
+
+std::vector<double> BetaDecaySimulator::generateMomentum(double energy, double mass) {
+    double p[3];
+    sampleMomentum(energy, mass, p);
+    return {p[0], p[1], p[2]};
+}
+
+void BetaDecaySimulator::sampleMomentum(double energy, double mass, double p[3]) {
+    // Isotropic direction, |p| from the kinetic energy
+    const double momentum = std::sqrt(energy*(energy + 2.0*mass));
+    const double cosTheta = 2.0*random.Uniform() - 1.0;
+    const double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
+    const double phi = 2.0*PI*random.Uniform();
+    p[0] = momentum*sinTheta*std::cos(phi);
+    p[1] = momentum*sinTheta*std::sin(phi);
+    p[2] = momentum*cosTheta;
+}
+
+void BetaDecaySimulator::conserveMomentumEnergy(DecayEventBatch& batch, double qValue,
+                                                int daughterZ, int daughterA) {
+    typedef DecayEventBatch::ParticleType Type;
+    const DecayEventBatch::EventView event = batch[batch.GetNumberOfEvents() - 1];
+    const std::size_t first = event.GetFirstParticle();
+    const std::size_t last = event.GetLastParticle();
+    double* energy = batch.GetEnergies();
+    double* px = batch.GetPx();
+    double* py = batch.GetPy();
+    double* pz = batch.GetPz();
+    const Type* type = batch.GetParticleTypes();
+
+    // Neutrinos absorb the recoil energy; without neutrinos (0nu) the
+    // charged leptons share it in proportion to their energies
+    bool hasNeutrino = false;
+    for (std::size_t i = first; i < last; ++i) {
+        if (type[i] == Type::Neutrino || type[i] == Type::AntiNeutrino) hasNeutrino = true;
+    }
+    auto adjustable = [hasNeutrino, type](std::size_t i) {
+        const bool neutrino = type[i] == Type::Neutrino || type[i] == Type::AntiNeutrino;
+        return neutrino == hasNeutrino;
+    };
+    const double adjustableMass = hasNeutrino ? 0.0 : ELECTRON_MASS;
+
+    const double recoilMass = NuclearData::getAtomicMass(daughterZ, daughterA)
+                            - daughterZ*ELECTRON_MASS;
+    double recoil[3] = {0.0, 0.0, 0.0};
+    double recoilEnergy = 0.0;
+
+    // The recoil takes ~1e-4 of Q, so a few fixed-point steps converge to
+    // rounding
+    for (int iteration = 0; iteration < 3; ++iteration) {
+        double fixedEnergy = 0.0, scalableEnergy = 0.0;
+        for (std::size_t i = first; i < last; ++i) {
+            (adjustable(i) ? scalableEnergy : fixedEnergy) += energy[i];
+        }
+        if (scalableEnergy <= 0.0) break;
+
+        const double scale = std::max(0.0, qValue - recoilEnergy - fixedEnergy)/scalableEnergy;
+        recoil[0] = recoil[1] = recoil[2] = 0.0;
+        for (std::size_t i = first; i < last; ++i) {
+            if (adjustable(i)) {
+                const double oldP = std::sqrt(energy[i]*(energy[i] + 2.0*adjustableMass));
+                energy[i] *= scale;
+                const double newP = std::sqrt(energy[i]*(energy[i] + 2.0*adjustableMass));
+                const double ratio = oldP > 0.0 ? newP/oldP : 0.0;
+                px[i] *= ratio;
+                py[i] *= ratio;
+                pz[i] *= ratio;
+            }
+            recoil[0] -= px[i];
+            recoil[1] -= py[i];
+            recoil[2] -= pz[i];
+        }
+        const double p2 = recoil[0]*recoil[0] + recoil[1]*recoil[1] + recoil[2]*recoil[2];
+        recoilEnergy = std::sqrt(p2 + recoilMass*recoilMass) - recoilMass;
+    }
+
+    batch.AddParticle(Type::Recoil, recoilEnergy, recoil[0], recoil[1], recoil[2]);
+}
+
+double BetaDecaySimulator::sampleSingleBeta(int daughterZ, double qValue, bool positron) {
+    const BetaSpectrumTable::Lepton lepton =
+        positron ? BetaSpectrumTable::Lepton::Positron : BetaSpectrumTable::Lepton::Electron;
+    if (!spectrumTable || spectrumTable->GetZ() != daughterZ ||
+        spectrumTable->GetQValue() != qValue || spectrumTable->GetLepton() != lepton) {
+        spectrumTable = BetaSpectrumTable::Get(daughterZ, qValue, lepton);
+    }
+    const double u1 = random.Uniform();
+    const double u2 = random.Uniform();
+    return spectrumTable->Sample(u1, u2);
+}
+
+void BetaDecaySimulator::sampleDoubleBeta(int daughterZ, double qValue, bool positron,
+                                          bool neutrinoless, double& t1, double& t2) {
+    const DoubleBetaSpectrumTable::Mode mode = neutrinoless
+        ? DoubleBetaSpectrumTable::Mode::Neutrinoless : DoubleBetaSpectrumTable::Mode::TwoNeutrino;
+    const BetaSpectrumTable::Lepton lepton =
+        positron ? BetaSpectrumTable::Lepton::Positron : BetaSpectrumTable::Lepton::Electron;
+    if (!doubleBetaTable || doubleBetaTable->GetZ() != daughterZ ||
+        doubleBetaTable->GetQValue() != qValue || doubleBetaTable->GetMode() != mode ||
+        doubleBetaTable->GetLepton() != lepton) {
+        doubleBetaTable = DoubleBetaSpectrumTable::Get(daughterZ, qValue, mode, lepton);
+    }
+    const double u1 = random.Uniform();
+    const double u2 = random.Uniform();
+    const double u3 = random.Uniform();
+    doubleBetaTable->Sample(u1, u2, u3, t1, t2);
+}
+
+void BetaDecaySimulator::addLepton(DecayEventBatch& batch, DecayEventBatch::ParticleType type,
+                                   double energy, double mass) {
+    double p[3];
+    sampleMomentum(energy, mass, p);
+    batch.AddParticle(type, energy, p[0], p[1], p[2]);
+}
+
+void BetaDecaySimulator::addLeptonPair(DecayEventBatch& batch, DecayEventBatch::ParticleType type,
+                                       double t1, double t2) {
+    double p[3];
+    sampleMomentum(t1, ELECTRON_MASS, p);
+    batch.AddParticle(type, t1, p[0], p[1], p[2]);
+
+    // Second lepton at the correlated opening angle, uniform in azimuth
+    // around the first: (u, v, d) is an orthonormal frame with d along it
+    const double norm = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+    const double d[3] = {norm > 0.0 ? p[0]/norm : 0.0, norm > 0.0 ? p[1]/norm : 0.0,
+                         norm > 0.0 ? p[2]/norm : 1.0};
+    const double e[3] = {std::abs(d[2]) < 0.9 ? 0.0 : 1.0, 0.0, std::abs(d[2]) < 0.9 ? 1.0 : 0.0};
+    double u[3] = {e[1]*d[2] - e[2]*d[1], e[2]*d[0] - e[0]*d[2], e[0]*d[1] - e[1]*d[0]};
+    const double uNorm = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+    for (double& component : u) component /= uNorm;
+    const double v[3] = {d[1]*u[2] - d[2]*u[1], d[2]*u[0] - d[0]*u[2], d[0]*u[1] - d[1]*u[0]};
+
+    const double cosTheta = DoubleBetaSpectrumTable::SampleCosTheta(t1, t2, random.Uniform());
+    const double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
+    const double phi = 2.0*PI*random.Uniform();
+    const double momentum = std::sqrt(t2*(t2 + 2.0*ELECTRON_MASS));
+    const double a = sinTheta*std::cos(phi);
+    const double b = sinTheta*std::sin(phi);
+    batch.AddParticle(type, t2, momentum*(a*u[0] + b*v[0] + cosTheta*d[0]),
+                      momentum*(a*u[1] + b*v[1] + cosTheta*d[1]),
+                      momentum*(a*u[2] + b*v[2] + cosTheta*d[2]));
+}
+
+void BetaDecaySimulator::addNeutrinos(DecayEventBatch& batch, DecayEventBatch::ParticleType type,
+                                      int count, double energy) {
+    if (count == 1) {
+        addLepton(batch, type, energy, 0.0);
+        return;
+    }
+    // Two neutrinos sharing E: phase space E1^2 E2^2, i.e. x ~ Beta(3, 3)
+    double x;
+    do {
+        x = random.Uniform();
+    } while (random.Uniform()*1.875 > 30.0*x*x*(1.0 - x)*(1.0 - x));
+    addLepton(batch, type, x*energy, 0.0);
+    addLepton(batch, type, (1.0 - x)*energy, 0.0);
+}
+
+bool BetaDecaySimulator::generate(const Nucleus& parent, BetaDecayType type, double qValue,
+                                  std::int64_t eventId, DecayEventBatch& batch) {
+    typedef DecayEventBatch::ParticleType Type;
+    const int daughterZ = parent.atomicNumber + ChargeChange(type);
+
+    // EC: K-shell capture; the binding energy goes to X-rays/Auger
+    // electrons, which are not generated (hydrogen-like, screening Z-1)
+    if (type == BetaDecayType::ELECTRON_CAPTURE) {
+        const double zEff = parent.atomicNumber - 1.0;
+        qValue -= RYDBERG*zEff*zEff;
+    }
+    if (qValue <= 0.0) return false;
+
+    // Every draw of the event comes from its own stream
+    random.SetStream(static_cast<std::uint64_t>(eventId));
+    batch.BeginEvent(eventId, static_cast<std::uint8_t>(type), qValue, daughterZ, parent.massNumber);
+
+    double t1, t2;
+    switch (type) {
+        case BetaDecayType::BETA_MINUS:
+            t1 = sampleSingleBeta(daughterZ, qValue, false);
+            addLepton(batch, Type::Electron, t1, ELECTRON_MASS);
+            addNeutrinos(batch, Type::AntiNeutrino, 1, qValue - t1);
+            break;
+        case BetaDecayType::BETA_PLUS:
+            t1 = sampleSingleBeta(daughterZ, qValue, true);
+            addLepton(batch, Type::Positron, t1, ELECTRON_MASS);
+            addNeutrinos(batch, Type::Neutrino, 1, qValue - t1);
+            break;
+        case BetaDecayType::ELECTRON_CAPTURE:
+            addNeutrinos(batch, Type::Neutrino, 1, qValue);
+            break;
+        case BetaDecayType::DOUBLE_BETA_MINUS:
+            sampleDoubleBeta(daughterZ, qValue, false, false, t1, t2);
+            addLeptonPair(batch, Type::Electron, t1, t2);
+            addNeutrinos(batch, Type::AntiNeutrino, 2, qValue - t1 - t2);
+            break;
+        case BetaDecayType::DOUBLE_BETA_PLUS:
+            sampleDoubleBeta(daughterZ, qValue, true, false, t1, t2);
+            addLeptonPair(batch, Type::Positron, t1, t2);
+            addNeutrinos(batch, Type::Neutrino, 2, qValue - t1 - t2);
+            break;
+        case BetaDecayType::DOUBLE_BETA_MINUS_0NU:
+            sampleDoubleBeta(daughterZ, qValue, false, true, t1, t2);
+            addLeptonPair(batch, Type::Electron, t1, t2);
+            break;
+    }
+
+    conserveMomentumEnergy(batch, qValue, daughterZ, parent.massNumber);
+    return true;
+}
+
+DecayEvent BetaDecaySimulator::toDecayEvent(const DecayEventBatch::EventView& view,
+                                            const Nucleus& parent) const {
+    DecayEvent event;
+    event.decayType = static_cast<BetaDecayType>(view.GetDecayType());
+    event.parentNucleus = parent;
+    event.daughterNucleus = Nucleus(view.GetDaughterZ(), view.GetDaughterA());
+    event.qValue = view.GetQValue();
+    event.isSuccessful = true;
+    event.products.reserve(view.GetNumberOfParticles());
+    for (std::size_t i = 0; i < view.GetNumberOfParticles(); ++i) {
+        const DecayEventBatch::ParticleView particle = view.GetParticle(i);
+        const bool recoil = particle.GetType() == DecayEventBatch::ParticleType::Recoil;
+        DecayProduct product(recoil ? event.daughterNucleus.symbol +
+                                      std::to_string(event.daughterNucleus.massNumber)
+                                    : std::string(particle.GetName()),
+                             particle.GetEnergy());
+        product.momentum[0] = particle.GetPx();
+        product.momentum[1] = particle.GetPy();
+        product.momentum[2] = particle.GetPz();
+        event.products.push_back(product);
+    }
+    return event;
+}
+
+DecayEvent BetaDecaySimulator::simulate(const Nucleus& parent, BetaDecayType type, double qValue) {
+    scratch.Clear();
+    if (!generate(parent, type, qValue, nextEventId++, scratch)) {
+        DecayEvent event;
+        event.decayType = type;
+        event.parentNucleus = parent;
+        event.daughterNucleus = Daughter(parent, type);
+        event.qValue = qValue;
+        return event;
+    }
+    return toDecayEvent(scratch[0], parent);
+}
+
+DecayEvent BetaDecaySimulator::simulateBetaMinus(const Nucleus& parent, double qValue) {
+    return simulate(parent, BetaDecayType::BETA_MINUS, qValue);
+}
+
+DecayEvent BetaDecaySimulator::simulateBetaPlus(const Nucleus& parent, double qValue) {
+    return simulate(parent, BetaDecayType::BETA_PLUS, qValue);
+}
+
+DecayEvent BetaDecaySimulator::simulateElectronCapture(const Nucleus& parent, double qValue) {
+    return simulate(parent, BetaDecayType::ELECTRON_CAPTURE, qValue);
+}
+
+DecayEvent BetaDecaySimulator::simulateDoubleBetaMinus(const Nucleus& parent, double qValue) {
+    return simulate(parent, BetaDecayType::DOUBLE_BETA_MINUS, qValue);
+}
+
+DecayEvent BetaDecaySimulator::simulateDoubleBetaPlus(const Nucleus& parent, double qValue) {
+    return simulate(parent, BetaDecayType::DOUBLE_BETA_PLUS, qValue);
+}
+
+DecayEvent BetaDecaySimulator::simulateDoubleBetaMinus0Nu(const Nucleus& parent, double qValue) {
+    return simulate(parent, BetaDecayType::DOUBLE_BETA_MINUS_0NU, qValue);
+}
+
+double BetaDecaySimulator::calculateHalfLife(double decayConstant) const {
+    return decayConstant > 0.0 ? LN2/decayConstant : INFINITY;
+}
+
+double BetaDecaySimulator::generateDecayTime(double halfLife) {
+    return -halfLife/LN2*std::log(1.0 - random.Uniform());
+}
+
+bool BetaDecaySimulator::canDecay(const Nucleus& parent, BetaDecayType type) const {
+    const Nucleus daughter = Daughter(parent, type);
+    if (daughter.atomicNumber < 1 || daughter.atomicNumber > NuclideTable::MAX_Z ||
+        daughter.atomicNumber >= parent.massNumber) return false;
+    return NuclearData::getQValue(parent, daughter, type) > 0.0;
+}
+
+int BetaDecaySimulator::getNumberOfThreads() const {
+    if (numThreads > 0) return numThreads;
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+void BetaDecaySimulator::runBlocks(long long numEvents,
+                                   const std::function<void(BetaDecaySimulator&, int, long long)>& block) {
+    if (numEvents <= 0) return;
+
+    const long long nBlocks = (numEvents + BLOCK_SIZE - 1)/BLOCK_SIZE;
+    const int nWorkers = static_cast<int>(std::min<long long>(getNumberOfThreads(), nBlocks));
+    std::atomic<long long> nextBlock(0);
+
+    auto work = [&](int worker) {
+        // Same seed as this simulator: an event depends only on its id
+        BetaDecaySimulator local(0);
+        local.setSeed(random.GetSeed());
+        for (long long index = nextBlock++; index < nBlocks; index = nextBlock++) {
+            block(local, worker, index);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int worker = 1; worker < nWorkers; ++worker) threads.emplace_back(work, worker);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+}
+
+void BetaDecaySimulator::runDecays(const Nucleus& parent, BetaDecayType type, double qValue,
+                                   long long numEvents, const BatchSink& sink) {
+    // One reusable batch per worker: no allocation after the first block
+    const std::int64_t firstId = nextEventId;
+    nextEventId += numEvents > 0 ? numEvents : 0;
+
+    std::vector<DecayEventBatch> batches(getNumberOfThreads());
+    runBlocks(numEvents, [&](BetaDecaySimulator& local, int worker, long long index) {
+        DecayEventBatch& batch = batches[worker];
+        batch.Clear();
+        batch.Reserve(BLOCK_SIZE, 5*BLOCK_SIZE);
+        const long long end = std::min(numEvents, (index + 1)*BLOCK_SIZE);
+        for (long long i = index*BLOCK_SIZE; i < end; ++i) {
+            local.generate(parent, type, qValue, firstId + i, batch);
+        }
+        sink(worker, batch);
+    });
+}
+
+void BetaDecaySimulator::runMultipleDecays(const Nucleus& parent, BetaDecayType type,
+                                           double qValue, long long numEvents,
+                                           DecayEventBatch& events) {
+    events.Clear();
+    if (numEvents <= 0) return;
+    const std::int64_t firstId = nextEventId;
+    nextEventId += numEvents;
+
+    // Blocks are generated in any order and joined in block order
+    const long long nBlocks = (numEvents + BLOCK_SIZE - 1)/BLOCK_SIZE;
+    std::vector<DecayEventBatch> blocks(nBlocks);
+    runBlocks(numEvents, [&](BetaDecaySimulator& local, int, long long index) {
+        const long long end = std::min(numEvents, (index + 1)*BLOCK_SIZE);
+        for (long long i = index*BLOCK_SIZE; i < end; ++i) {
+            local.generate(parent, type, qValue, firstId + i, blocks[index]);
+        }
+    });
+
+    std::size_t nParticles = 0;
+    for (const DecayEventBatch& block : blocks) nParticles += block.GetNumberOfParticles();
+    events.Reserve(numEvents, nParticles);
+    for (const DecayEventBatch& block : blocks) events.Append(block);
+}
+
+std::vector<DecayEvent> BetaDecaySimulator::runMultipleDecays(const Nucleus& parent,
+                                                              BetaDecayType type,
+                                                              double qValue,
+                                                              int numEvents) {
+    DecayEventBatch batch;
+    runMultipleDecays(parent, type, qValue, numEvents, batch);
+
+    // A decay that is not allowed leaves the batch empty; report every
+    // event as failed, as simulate() does
+    if (batch.IsEmpty()) {
+        return std::vector<DecayEvent>(numEvents > 0 ? numEvents : 0,
+                                       simulate(parent, type, qValue));
+    }
+    std::vector<DecayEvent> events;
+    events.reserve(batch.GetNumberOfEvents());
+    for (const DecayEventBatch::EventView event : batch) {
+        events.push_back(toDecayEvent(event, parent));
+    }
+    return events;
+}
+
+void BetaDecaySimulator::analyzeEnergyDistribution(const std::vector<DecayEvent>& events) const {
+    // Visible energy: kinetic energy of the charged leptons
+    std::vector<double> visible;
+    visible.reserve(events.size());
+    double maxQ = 0.0;
+    for (const DecayEvent& event : events) {
+        if (!event.isSuccessful) continue;
+        double sum = 0.0;
+        for (const DecayProduct& product : event.products) {
+            if (product.particle == "e-" || product.particle == "e+") sum += product.energy;
+        }
+        visible.push_back(sum);
+        maxQ = std::max(maxQ, event.qValue);
+    }
+
+    std::cout << "Energy distribution: " << visible.size() << " of " << events.size()
+              << " events successful" << std::endl;
+    if (visible.empty() || maxQ <= 0.0) return;
+
+    double mean = 0.0;
+    for (double e : visible) mean += e;
+    mean /= visible.size();
+    double variance = 0.0;
+    for (double e : visible) variance += (e - mean)*(e - mean);
+    variance /= visible.size();
+    const auto range = std::minmax_element(visible.begin(), visible.end());
+
+    std::cout << "  Electron/positron kinetic energy: mean " << mean << " MeV, rms "
+              << std::sqrt(variance) << " MeV, range [" << *range.first << ", "
+              << *range.second << "] MeV" << std::endl;
+
+    const int nBins = 20;
+    std::vector<std::size_t> histogram(nBins, 0);
+    for (double e : visible) {
+        histogram[std::min(static_cast<int>(e/maxQ*nBins), nBins - 1)]++;
+    }
+    const std::size_t peak = *std::max_element(histogram.begin(), histogram.end());
+    for (int i = 0; i < nBins; ++i) {
+        const int width = peak ? static_cast<int>(50.0*histogram[i]/peak) : 0;
+        std::cout << "  " << std::fixed << std::setprecision(3) << std::setw(7) << (i + 0.5)*maxQ/nBins
+                  << " MeV | " << std::string(width, '#') << " " << histogram[i] << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+//==============================================================================
+// NuclearData
+//==============================================================================
+
+double NuclearData::getAtomicMass(int Z, int A) {
+    // Neutral atom mass in MeV/c^2: evaluated where tabulated, else from the
+    // semi-empirical binding energy
+    return NuclideTable::AtomicMass(Z, A);
+}
+
+std::string NuclearData::getElementSymbol(int Z) {
+    const char* symbol = NuclideTable::ElementSymbol(Z);
+    return symbol ? symbol : "Z" + std::to_string(Z);
+}
+
+double NuclearData::getQValue(const Nucleus& parent, const Nucleus& daughter, BetaDecayType type) {
+    // Atomic masses: beta- and EC need M(P) > M(D); each emitted positron
+    // costs two electron masses
+    const double delta = parent.massNumber == daughter.massNumber
+        ? NuclideTable::AtomicMassDifference(parent.atomicNumber, daughter.atomicNumber,
+                                             parent.massNumber)
+        : getAtomicMass(parent.atomicNumber, parent.massNumber)
+          - getAtomicMass(daughter.atomicNumber, daughter.massNumber);
+    switch (type) {
+        case BetaDecayType::BETA_PLUS:        return delta - 2.0*NuclideTable::ELECTRON_MASS;
+        case BetaDecayType::DOUBLE_BETA_PLUS: return delta - 4.0*NuclideTable::ELECTRON_MASS;
+        default:                              return delta;
+    }
+}
+
+bool NuclearData::isStable(int Z, int A) {
+    return NuclideTable::IsStable(Z, A);
+}
@@ -0,0 +1,283 @@
+// src/BetaDecayMessenger.cc
+#include "BetaDecayMessenger.hh"
+#include "BetaDecay.hh"
+#include "DoubleBetaSpectrumTable.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithALongInt.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWith3Vector.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+#include "G4Threading.hh"
+
+#include <sstream>
+
+BetaDecayMessenger::BetaDecayMessenger(BetaDecayPrimaryGenerator* generator)
+    : G4UImessenger(), fGenerator(generator) {
+    fDirectory = new G4UIdirectory("/betadecay/gun/");
+    fDirectory->SetGuidance("Beta decay primary generator control");
+    
+    fValidateCmd = new G4UIcmdWithAnInteger("/betadecay/gun/validateSpectrum", this);
+    fValidateCmd->SetGuidance("Check the tabulated beta spectrum against the analytic shape.");
+    fValidateCmd->SetGuidance("Each table is sampled N times once, when it is next used,");
+    fValidateCmd->SetGuidance("and chi2/ndf is printed. 0 disables validation.");
+    fValidateCmd->SetParameterName("nSamples", false);
+    fValidateCmd->SetRange("nSamples >= 0");
+    fValidateCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fSeedCmd = new G4UIcmdWithALongInt("/betadecay/gun/seed", this);
+    fSeedCmd->SetGuidance("Seed of the primary generator.");
+    fSeedCmd->SetGuidance("Each event draws from its own stream of this seed, keyed by");
+    fSeedCmd->SetGuidance("run and event id: primaries do not depend on the number of");
+    fSeedCmd->SetGuidance("threads or the order in which events are processed.");
+    fSeedCmd->SetParameterName("seed", false);
+    fSeedCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fStreamPerRunCmd = new G4UIcmdWithABool("/betadecay/gun/streamPerRun", this);
+    fStreamPerRunCmd->SetGuidance("Key the streams on the run id as well as the seed (default true).");
+    fStreamPerRunCmd->SetGuidance("With false every run replays the primaries of the same seed, e.g.");
+    fStreamPerRunCmd->SetGuidance("to compare physics settings on identical events (fastsim.mac).");
+    fStreamPerRunCmd->SetParameterName("perRun", true);
+    fStreamPerRunCmd->SetDefaultValue(true);
+    fStreamPerRunCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fFirstEventCmd = new G4UIcmdWithALongInt("/betadecay/gun/firstEvent", this);
+    fFirstEventCmd->SetGuidance("Global id of the run's event 0 (default 0): the random stream and");
+    fFirstEventCmd->SetGuidance("the output records use firstEvent + event id. Jobs running");
+    fFirstEventCmd->SetGuidance("consecutive id ranges of one workload with the same seed draw the");
+    fFirstEventCmd->SetGuidance("same primaries as a single job (see BetaDecaySimulation --shards).");
+    fFirstEventCmd->SetParameterName("id", false);
+    fFirstEventCmd->SetRange("id >= 0");
+    fFirstEventCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fReseedTransportCmd = new G4UIcmdWithABool("/betadecay/gun/reseedTransport", this);
+    fReseedTransportCmd->SetGuidance("Also seed the transport random engine from the event's stream,");
+    fReseedTransportCmd->SetGuidance("so that a single event can be re-simulated in isolation.");
+    fReseedTransportCmd->SetParameterName("reseed", true);
+    fReseedTransportCmd->SetDefaultValue(true);
+    fReseedTransportCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fIsotopeCmd = new G4UIcmdWithAString("/betadecay/gun/isotope", this);
+    fIsotopeCmd->SetGuidance("Decay source: sets the parent nucleus, decay mode and Q-value.");
+    fIsotopeCmd->SetParameterName("isotope", false);
+    fIsotopeCmd->SetCandidates(BetaDecayUtils::IsotopeNames().c_str());
+    fIsotopeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fDecayModeCmd = new G4UIcmdWithAString("/betadecay/gun/decayMode", this);
+    fDecayModeCmd->SetGuidance("Decay mode of the current parent nucleus, e.g. 0nu2beta- after");
+    fDecayModeCmd->SetGuidance("/betadecay/gun/isotope Ge-76 for the neutrinoless mode.");
+    fDecayModeCmd->SetParameterName("mode", false);
+    fDecayModeCmd->SetCandidates("beta- beta+ EC 2nu2beta- 2nu2beta+ 0nu2beta-");
+    fDecayModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fQValueCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/gun/qValue", this);
+    fQValueCmd->SetGuidance("Override the Q-value of the current parent nucleus, e.g. to scan");
+    fQValueCmd->SetGuidance("the spectrum shape. /betadecay/gun/isotope restores the tabulated");
+    fQValueCmd->SetGuidance("value; the spectrum tables follow on the next event.");
+    fQValueCmd->SetParameterName("Q", false);
+    fQValueCmd->SetRange("Q>0");
+    fQValueCmd->SetUnitCategory("Energy");
+    fQValueCmd->SetDefaultUnit("MeV");
+    fQValueCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fPositionCmd = new G4UIcmdWith3VectorAndUnit("/betadecay/gun/position", this);
+    fPositionCmd->SetGuidance("Position of the point source (default the origin).");
+    fPositionCmd->SetParameterName("x", "y", "z", false);
+    fPositionCmd->SetUnitCategory("Length");
+    fPositionCmd->SetDefaultUnit("cm");
+    fPositionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fTableCacheCmd = new G4UIcmdWithAString("/betadecay/gun/tableCache", this);
+    fTableCacheCmd->SetGuidance("Directory of the double beta spectrum table files (default none:");
+    fTableCacheCmd->SetGuidance("tables are built in memory; --physics-cache sets DIR/spectra).");
+    fTableCacheCmd->SetGuidance("A table is written there when first built; later runs and");
+    fTableCacheCmd->SetGuidance("other processes map the file instead. \"none\" disables it.");
+    fTableCacheCmd->SetParameterName("directory", false);
+    fTableCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fReplayCmd = new G4UIcmdWithAString("/betadecay/gun/replay", this);
+    fReplayCmd->SetGuidance("Replay a pre-generated primary file (BetaDecayGenerator --primaries)");
+    fReplayCmd->SetGuidance("instead of sampling the decays. Every worker maps the same file");
+    fReplayCmd->SetGuidance("read-only; the event of global id n (see firstEvent) takes record");
+    fReplayCmd->SetGuidance("replayFirstEvent + n.");
+    fReplayCmd->SetGuidance("\"none\" returns to sampling.");
+    fReplayCmd->SetParameterName("file", false);
+    fReplayCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fReplayFirstCmd = new G4UIcmdWithALongInt("/betadecay/gun/replayFirstEvent", this);
+    fReplayFirstCmd->SetGuidance("Record of the replay file used for event 0 (default 0).");
+    fReplayFirstCmd->SetParameterName("record", false);
+    fReplayFirstCmd->SetRange("record >= 0");
+    fReplayFirstCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBiasCmd = new G4UIcmdWithAString("/betadecay/gun/bias", this);
+    fBiasCmd->SetGuidance("Solid-angle biasing of the emission directions:");
+    fBiasCmd->SetGuidance("  isotropic : no biasing, all weights 1");
+    fBiasCmd->SetGuidance("  cone      : the cone of biasAxis and biasAngle");
+    fBiasCmd->SetGuidance("  detector  : the smallest cone containing the detector array,");
+    fBiasCmd->SetGuidance("              widened by biasMargin");
+    fBiasCmd->SetGuidance("Each vertex carries the statistical weight of its direction;");
+    fBiasCmd->SetGuidance("the run summary and the output records are weighted.");
+    fBiasCmd->SetParameterName("mode", false);
+    fBiasCmd->SetCandidates("isotropic cone detector");
+    fBiasCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBiasAxisCmd = new G4UIcmdWith3Vector("/betadecay/gun/biasAxis", this);
+    fBiasAxisCmd->SetGuidance("Axis of the cone mode (need not be normalised).");
+    fBiasAxisCmd->SetParameterName("x", "y", "z", false);
+    fBiasAxisCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBiasAngleCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/gun/biasAngle", this);
+    fBiasAngleCmd->SetGuidance("Half-angle of the cone mode.");
+    fBiasAngleCmd->SetParameterName("angle", false);
+    fBiasAngleCmd->SetRange("angle>0");
+    fBiasAngleCmd->SetUnitCategory("Angle");
+    fBiasAngleCmd->SetDefaultUnit("deg");
+    fBiasAngleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBiasMarginCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/gun/biasMargin", this);
+    fBiasMarginCmd->SetGuidance("Added to the half-angle of the detector mode (default 2 deg).");
+    fBiasMarginCmd->SetParameterName("margin", false);
+    fBiasMarginCmd->SetRange("margin>=0");
+    fBiasMarginCmd->SetUnitCategory("Angle");
+    fBiasMarginCmd->SetDefaultUnit("deg");
+    fBiasMarginCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBiasFractionCmd = new G4UIcmdWithADouble("/betadecay/gun/biasFraction", this);
+    fBiasFractionCmd->SetGuidance("Fraction of the primaries emitted into the cone (default 1);");
+    fBiasFractionCmd->SetGuidance("the rest is emitted outside it with a larger weight, which");
+    fBiasFractionCmd->SetGuidance("keeps particles that scatter into the detector.");
+    fBiasFractionCmd->SetParameterName("fraction", false);
+    fBiasFractionCmd->SetRange("fraction>0 && fraction<=1");
+    fBiasFractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fSourceDirectory = new G4UIdirectory("/betadecay/source/");
+    fSourceDirectory->SetGuidance("Mixed sources: several isotopes, branches and decay chains");
+    
+    fSourceAddCmd = new G4UIcommand("/betadecay/source/add", this);
+    fSourceAddCmd->SetGuidance("Add an isotope with its activity at age 0. Its decay branches");
+    fSourceAddCmd->SetGuidance("(with their prompt gammas) and chain daughters come from the");
+    fSourceAddCmd->SetGuidance("built-in decay data. Once a source isotope is added, every");
+    fSourceAddCmd->SetGuidance("event picks an isotope and branch by activity x branching ratio");
+    fSourceAddCmd->SetGuidance("and /betadecay/gun/isotope is not used.");
+    G4UIparameter* isotope = new G4UIparameter("isotope", 's', false);
+    isotope->SetParameterCandidates(BetaDecayUtils::SourceNames().c_str());
+    fSourceAddCmd->SetParameter(isotope);
+    G4UIparameter* activity = new G4UIparameter("activity", 'd', false);
+    activity->SetParameterRange("activity>=0");
+    fSourceAddCmd->SetParameter(activity);
+    G4UIparameter* unit = new G4UIparameter("unit", 's', true);
+    unit->SetDefaultValue("Bq");
+    unit->SetParameterCandidates("Bq kBq MBq GBq Ci mCi uCi");
+    fSourceAddCmd->SetParameter(unit);
+    fSourceAddCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fSourceAgeCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/source/age", this);
+    fSourceAgeCmd->SetGuidance("Time since the activities given to /betadecay/source/add;");
+    fSourceAgeCmd->SetGuidance("the isotopes decay and chain daughters grow in (Bateman).");
+    fSourceAgeCmd->SetParameterName("age", false);
+    fSourceAgeCmd->SetRange("age>=0");
+    fSourceAgeCmd->SetUnitCategory("Time");
+    fSourceAgeCmd->SetDefaultUnit("d");
+    fSourceAgeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fSourceClearCmd = new G4UIcmdWithoutParameter("/betadecay/source/clear", this);
+    fSourceClearCmd->SetGuidance("Remove all source isotopes: back to the single parent.");
+    fSourceClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fSourceListCmd = new G4UIcmdWithoutParameter("/betadecay/source/list", this);
+    fSourceListCmd->SetGuidance("Print the isotopes, activities and branch probabilities.");
+    fSourceListCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+BetaDecayMessenger::~BetaDecayMessenger() {
+    delete fSourceListCmd;
+    delete fSourceClearCmd;
+    delete fSourceAgeCmd;
+    delete fSourceAddCmd;
+    delete fSourceDirectory;
+    delete fBiasFractionCmd;
+    delete fBiasMarginCmd;
+    delete fBiasAngleCmd;
+    delete fBiasAxisCmd;
+    delete fBiasCmd;
+    delete fReplayFirstCmd;
+    delete fReplayCmd;
+    delete fTableCacheCmd;
+    delete fPositionCmd;
+    delete fQValueCmd;
+    delete fDecayModeCmd;
+    delete fIsotopeCmd;
+    delete fReseedTransportCmd;
+    delete fFirstEventCmd;
+    delete fStreamPerRunCmd;
+    delete fSeedCmd;
+    delete fValidateCmd;
+    delete fDirectory;
+}
+
+void BetaDecayMessenger::SetNewValue(G4UIcommand* command, G4String newValue) {
+    if (command == fValidateCmd) {
+        fGenerator->SetSpectrumValidation(fValidateCmd->GetNewIntValue(newValue));
+    } else if (command == fSeedCmd) {
+        fGenerator->SetSeed(fSeedCmd->GetNewLongIntValue(newValue));
+    } else if (command == fStreamPerRunCmd) {
+        fGenerator->SetStreamPerRun(fStreamPerRunCmd->GetNewBoolValue(newValue));
+    } else if (command == fFirstEventCmd) {
+        fGenerator->SetFirstEvent(fFirstEventCmd->GetNewLongIntValue(newValue));
+    } else if (command == fReseedTransportCmd) {
+        fGenerator->SetReseedTransport(fReseedTransportCmd->GetNewBoolValue(newValue));
+    } else if (command == fIsotopeCmd) {
+        fGenerator->SetIsotope(newValue);
+    } else if (command == fDecayModeCmd) {
+        const BetaDecayType types[] = {
+            BetaDecayType::BETA_MINUS, BetaDecayType::BETA_PLUS, BetaDecayType::ELECTRON_CAPTURE,
+            BetaDecayType::DOUBLE_BETA_MINUS, BetaDecayType::DOUBLE_BETA_PLUS,
+            BetaDecayType::DOUBLE_BETA_0NU
+        };
+        for (BetaDecayType type : types) {
+            if (BetaDecayUtils::DecayTypeToString(type) == newValue) fGenerator->SetDecayType(type);
+        }
+    } else if (command == fQValueCmd) {
+        fGenerator->SetQValue(fQValueCmd->GetNewDoubleValue(newValue));
+    } else if (command == fPositionCmd) {
+        fGenerator->SetSourcePosition(fPositionCmd->GetNew3VectorValue(newValue));
+    } else if (command == fTableCacheCmd) {
+        DoubleBetaSpectrumTable::SetCacheDirectory(newValue == "none" ? "" : newValue);
+    } else if (command == fReplayCmd) {
+        fGenerator->SetReplayFile(newValue == "none" ? "" : newValue);
+    } else if (command == fReplayFirstCmd) {
+        fGenerator->SetReplayFirstEvent(fReplayFirstCmd->GetNewLongIntValue(newValue));
+    } else if (command == fBiasCmd) {
+        if (newValue == "cone") fGenerator->SetBiasing(EmissionBiasing::CONE);
+        else if (newValue == "detector") fGenerator->SetBiasing(EmissionBiasing::DETECTOR);
+        else fGenerator->SetBiasing(EmissionBiasing::ISOTROPIC);
+    } else if (command == fBiasAxisCmd) {
+        fGenerator->SetBiasCone(fBiasAxisCmd->GetNew3VectorValue(newValue), fGenerator->GetBiasAngle());
+    } else if (command == fBiasAngleCmd) {
+        fGenerator->SetBiasCone(fGenerator->GetBiasAxis(), fBiasAngleCmd->GetNewDoubleValue(newValue));
+    } else if (command == fBiasMarginCmd) {
+        fGenerator->SetBiasMargin(fBiasMarginCmd->GetNewDoubleValue(newValue));
+    } else if (command == fBiasFractionCmd) {
+        fGenerator->SetBiasFraction(fBiasFractionCmd->GetNewDoubleValue(newValue));
+    } else if (command == fSourceAddCmd) {
+        std::istringstream values(newValue);
+        G4String isotope;
+        G4double activity = 0.;
+        G4String unit = "Bq";
+        values >> isotope >> activity >> unit;
+        fGenerator->AddSourceIsotope(isotope, activity*G4UIcommand::ValueOf(unit));
+    } else if (command == fSourceAgeCmd) {
+        fGenerator->SetSourceAge(fSourceAgeCmd->GetNewDoubleValue(newValue));
+    } else if (command == fSourceClearCmd) {
+        fGenerator->ClearSource();
+    } else if (command == fSourceListCmd) {
+        if (G4Threading::G4GetThreadId() <= 0) fGenerator->PrintSource();
+    }
+}
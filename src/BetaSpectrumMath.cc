@@ -0,0 +1,79 @@
+// src/BetaSpectrumMath.cc
+#include "BetaSpectrumMath.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace BetaSpectrumMath {
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double HALF_LOG_TWO_PI = 0.91893853320467274178;
+    constexpr double NUCLEAR_RADIUS = 1.2;   // r0 in fm, R = r0 A^(1/3)
+    constexpr double MIN_MOMENTUM = 1.0e-6;  // in units of m_e c
+    constexpr int GAMMA_SHIFT = 8;           // Recurrence shift before Stirling
+}
+
+int EstimateMassNumber(int Z) {
+    const int absZ = std::abs(Z);
+    return static_cast<int>(std::lround(2.0*absZ + 0.0077*absZ*absZ));
+}
+
+double LogAbsGamma(double x, double y) {
+    // Shift z up by GAMMA_SHIFT with Gamma(z) = Gamma(z+N) / prod(z+k) so the
+    // Stirling series converges to double precision
+    const std::complex<double> z(x, y);
+    double logProduct = 0.0;
+    for (int k = 0; k < GAMMA_SHIFT; ++k) {
+        logProduct += std::log(std::abs(z + double(k)));
+    }
+
+    const std::complex<double> w = z + double(GAMMA_SHIFT);
+    const std::complex<double> inv = 1.0/w;
+    const std::complex<double> inv2 = inv*inv;
+    const std::complex<double> series =
+        inv*(1.0/12.0 + inv2*(-1.0/360.0 + inv2*(1.0/1260.0 - inv2/1680.0)));
+    const std::complex<double> logGammaW =
+        (w - 0.5)*std::log(w) - w + HALF_LOG_TWO_PI + series;
+
+    return logGammaW.real() - logProduct;
+}
+
+double FermiFunction(double kineticEnergy, int Z, int A) {
+    if (Z == 0) return 1.0;
+    if (A <= 0) A = EstimateMassNumber(Z);
+
+    const double alphaZ = ALPHA*Z;
+    const double W = 1.0 + std::max(kineticEnergy, 0.0)/ELECTRON_MASS;
+    const double p = std::max(std::sqrt(W*W - 1.0), MIN_MOMENTUM);
+    const double gamma = std::sqrt(1.0 - alphaZ*alphaZ);
+    const double eta = alphaZ*W/p;
+    const double radius = NUCLEAR_RADIUS*std::cbrt(double(A))/COMPTON_WAVELENGTH;
+
+    // Evaluated in log space: exp(pi*eta) and |Gamma(gamma + i*eta)|^2
+    // individually overflow near the endpoint for heavy daughters
+    const double logF = std::log(2.0*(1.0 + gamma))
+                      + 2.0*(gamma - 1.0)*std::log(2.0*p*radius)
+                      + PI*eta
+                      + 2.0*LogAbsGamma(gamma, eta)
+                      - 2.0*std::lgamma(2.0*gamma + 1.0);
+    return std::exp(logF);
+}
+
+double LeptonFactor(double kineticEnergy, int Z, int A) {
+    // The momentum floor matches FermiFunction so that F*p keeps its finite
+    // limit at T = 0 for electrons
+    const double W = 1.0 + std::max(kineticEnergy, 0.0)/ELECTRON_MASS;
+    const double p = std::max(std::sqrt(W*W - 1.0), MIN_MOMENTUM);
+    return FermiFunction(kineticEnergy, Z, A)*p*W;
+}
+
+double SpectrumShape(double kineticEnergy, double qValue, int Z, int A) {
+    if (kineticEnergy < 0.0 || kineticEnergy >= qValue) return 0.0;
+
+    const double neutrinoEnergy = qValue - kineticEnergy;
+    return LeptonFactor(kineticEnergy, Z, A)*neutrinoEnergy*neutrinoEnergy;
+}
+
+} // namespace BetaSpectrumMath
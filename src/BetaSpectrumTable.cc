@@ -0,0 +1,190 @@
+// src/BetaSpectrumTable.cc
+#include "BetaSpectrumTable.hh"
+#include "BetaSpectrumMath.hh"
+#include "CounterRandom.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+    using TableKey = std::tuple<int, long long, int>;
+
+    std::mutex gTableMutex;
+    std::map<TableKey, std::shared_ptr<const BetaSpectrumTable>> gTableCache;
+    std::map<TableKey, std::size_t> gValidated;  // Samples used per validated key
+    std::atomic<std::size_t> gValidationSamples{0};
+
+    // Simpson integration of f over [a, b] with n (even) intervals
+    template <typename F>
+    double Integrate(F f, double a, double b, int n) {
+        const double h = (b - a)/n;
+        double sum = f(a) + f(b);
+        for (int i = 1; i < n; ++i) {
+            sum += (i % 2 ? 4.0 : 2.0)*f(a + i*h);
+        }
+        return sum*h/3.0;
+    }
+}
+
+BetaSpectrumTable::BetaSpectrumTable(int Z, double qValue, Lepton lepton,
+                                     std::size_t nBins)
+    : fZ(Z), fQValue(qValue), fLepton(lepton), fNBins(nBins),
+      fBinWidth(0.0), fNormalization(0.0) {
+    if (qValue <= 0.0 || nBins == 0) {
+        throw std::invalid_argument("BetaSpectrumTable: Q-value and bin count must be positive");
+    }
+    fBinWidth = qValue/nBins;
+
+    // One batch evaluation on the half-bin grid serves both the bin edges
+    // (even points) and the Simpson normalization (all points)
+    const std::size_t nPoints = 2*nBins + 1;
+    std::vector<double> energies(nPoints), shape(nPoints);
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        energies[i] = 0.5*i*fBinWidth;
+    }
+    const int chargeZ = (fLepton == Lepton::Positron) ? -fZ : fZ;
+    BetaSpectrumMath::SpectrumShape(energies.data(), shape.data(), nPoints, qValue, chargeZ);
+
+    fEdgeDensity.resize(nBins + 1);
+    for (std::size_t i = 0; i <= nBins; ++i) {
+        fEdgeDensity[i] = shape[2*i];
+    }
+
+    std::vector<double> weights(nBins);
+    double simpson = 0.0;
+    for (std::size_t i = 0; i < nBins; ++i) {
+        weights[i] = 0.5*(fEdgeDensity[i] + fEdgeDensity[i + 1])*fBinWidth;
+        simpson += shape[2*i] + 4.0*shape[2*i + 1] + shape[2*i + 2];
+    }
+    BuildAliasTable(weights, fProbability, fAlias);
+
+    fNormalization = simpson*fBinWidth/6.0;
+}
+
+std::shared_ptr<const BetaSpectrumTable>
+BetaSpectrumTable::Get(int Z, double qValue, Lepton lepton, ValidationResult* validation) {
+    // Q is keyed at eV resolution so equal configurations share a table
+    const TableKey key(Z, std::llround(qValue*1.0e6), static_cast<int>(lepton));
+    if (validation) *validation = ValidationResult();
+
+    std::lock_guard<std::mutex> lock(gTableMutex);
+    auto it = gTableCache.find(key);
+    if (it == gTableCache.end()) {
+        it = gTableCache.emplace(key, std::make_shared<const BetaSpectrumTable>(Z, qValue, lepton)).first;
+    }
+
+    const std::size_t nSamples = gValidationSamples.load();
+    if (validation && nSamples > 0 && gValidated[key] != nSamples) {
+        gValidated[key] = nSamples;
+        *validation = it->second->Validate(nSamples);
+    }
+    return it->second;
+}
+
+void BetaSpectrumTable::SetValidationSamples(std::size_t nSamples) {
+    gValidationSamples.store(nSamples);
+}
+
+std::size_t BetaSpectrumTable::GetValidationSamples() {
+    return gValidationSamples.load();
+}
+
+double BetaSpectrumTable::Shape(double kineticEnergy) const {
+    const int chargeZ = (fLepton == Lepton::Positron) ? -fZ : fZ;
+    return BetaSpectrumMath::SpectrumShape(kineticEnergy, fQValue, chargeZ);
+}
+
+double BetaSpectrumTable::Density(double kineticEnergy) const {
+    return Shape(kineticEnergy)/fNormalization;
+}
+
+void BetaSpectrumTable::BuildAliasTable(const std::vector<double>& weights,
+                                        std::vector<double>& probability,
+                                        std::vector<std::uint32_t>& alias) {
+    // Vose's variant of Walker's alias method
+    const std::size_t n = weights.size();
+    double total = 0.0;
+    for (double w : weights) total += w;
+
+    probability.assign(n, 1.0);
+    alias.resize(n);
+    for (std::size_t i = 0; i < n; ++i) alias[i] = static_cast<std::uint32_t>(i);
+
+    std::vector<double> scaled(n);
+    std::vector<std::uint32_t> small, large;
+    small.reserve(n);
+    large.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i]*n/total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const std::uint32_t s = small.back();
+        small.pop_back();
+        const std::uint32_t l = large.back();
+
+        probability[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are 1 up to rounding
+    for (std::uint32_t i : small) probability[i] = 1.0;
+    for (std::uint32_t i : large) probability[i] = 1.0;
+}
+
+void BetaSpectrumTable::Sample(const double* u, double* energies, std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) energies[i] = Sample(u[2*i], u[2*i + 1]);
+}
+
+BetaSpectrumTable::ValidationResult
+BetaSpectrumTable::Validate(std::size_t nSamples, int nBins, std::uint64_t seed) const {
+    ValidationResult result;
+    result.nSamples = nSamples;
+    result.nBins = nBins;
+
+    CounterRandom random(seed);
+    const std::size_t chunk = 4096;
+    std::vector<double> u(2*chunk), energies(chunk);
+
+    std::vector<std::size_t> observed(nBins, 0);
+    const double histWidth = fQValue/nBins;
+    for (std::size_t done = 0; done < nSamples; done += chunk) {
+        const std::size_t n = std::min(chunk, nSamples - done);
+        random.Fill(u.data(), 2*n);
+        Sample(u.data(), energies.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const int bin = std::min(static_cast<int>(energies[i]/histWidth), nBins - 1);
+            ++observed[bin];
+        }
+    }
+
+    // Bins with fewer than 5 expected entries are left out of chi2
+    int usedBins = 0;
+    for (int i = 0; i < nBins; ++i) {
+        const double lo = i*histWidth;
+        const double expected = nSamples *
+            Integrate([this](double T) { return Density(T); }, lo, lo + histWidth, 16);
+        if (expected < 5.0) continue;
+
+        const double diff = observed[i] - expected;
+        result.chi2 += diff*diff/expected;
+        const double pull = std::abs(diff)/std::sqrt(expected);
+        if (pull > result.maxPull) {
+            result.maxPull = pull;
+            result.maxPullEnergy = lo + 0.5*histWidth;
+        }
+        ++usedBins;
+    }
+    result.ndf = std::max(usedBins - 1, 0);
+    return result;
+}
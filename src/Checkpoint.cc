@@ -0,0 +1,458 @@
+// src/Checkpoint.cc
+#include "Checkpoint.hh"
+#include "EventFileReader.hh"
+#include "EventFileWriter.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Checkpoint {
+
+//==============================================================================
+// EventRanges
+//==============================================================================
+
+void EventRanges::Add(std::int64_t id) {
+    if (!fRanges.empty() && fRanges.back().second == id) {
+        fRanges.back().second = id + 1;
+        return;
+    }
+    Add(Range(id, id + 1));
+}
+
+void EventRanges::Add(const Range& range) {
+    if (range.first >= range.second) return;
+    if (fRanges.empty() || fRanges.back().second < range.first) {
+        fRanges.push_back(range);
+        return;
+    }
+    
+    // Replace the ranges it overlaps or touches by their union
+    auto first = std::lower_bound(fRanges.begin(), fRanges.end(), range,
+                                  [](const Range& a, const Range& b) { return a.second < b.first; });
+    auto last = first;
+    Range merged = range;
+    while (last != fRanges.end() && last->first <= range.second) {
+        merged.first = std::min(merged.first, last->first);
+        merged.second = std::max(merged.second, last->second);
+        ++last;
+    }
+    first = fRanges.erase(first, last);
+    fRanges.insert(first, merged);
+}
+
+void EventRanges::Merge(const EventRanges& other) {
+    for (const Range& range : other.fRanges) Add(range);
+}
+
+bool EventRanges::Contains(std::int64_t id) const {
+    const auto it = std::upper_bound(fRanges.begin(), fRanges.end(), id,
+                                     [](std::int64_t value, const Range& r) { return value < r.first; });
+    return it != fRanges.begin() && id < std::prev(it)->second;
+}
+
+std::uint64_t EventRanges::Count() const {
+    std::uint64_t count = 0;
+    for (const Range& range : fRanges) count += range.second - range.first;
+    return count;
+}
+
+EventRanges EventRanges::Complement(std::int64_t first, std::int64_t last) const {
+    EventRanges missing;
+    std::int64_t next = first;
+    for (const Range& range : fRanges) {
+        if (range.second <= next) continue;
+        if (range.first >= last) break;
+        if (range.first > next) missing.fRanges.push_back(Range(next, range.first));
+        next = range.second;
+    }
+    if (next < last) missing.fRanges.push_back(Range(next, last));
+    return missing;
+}
+
+std::int64_t EventRanges::Select(std::uint64_t n) const {
+    for (const Range& range : fRanges) {
+        const std::uint64_t size = range.second - range.first;
+        if (n < size) return range.first + static_cast<std::int64_t>(n);
+        n -= size;
+    }
+    return (fRanges.empty() ? 0 : fRanges.back().second) + static_cast<std::int64_t>(n);
+}
+
+//==============================================================================
+// Checkpoint files
+//==============================================================================
+
+namespace {
+    std::string SlotName(const std::string& path, unsigned slot, const char* extension) {
+        return path + "." + std::to_string(slot) + extension;
+    }
+    
+    void Fail(const std::string& path, const std::string& line) {
+        throw std::runtime_error("Checkpoint: malformed line in " + path + ": " + line);
+    }
+}
+
+void Write(const std::string& path, const State& state) {
+    // The main file goes last and replaces the previous one in one step
+    CounterFile::Write(SlotName(path, state.slot, CounterFile::EXTENSION), state.counters);
+    HistogramFile::Write(SlotName(path, state.slot, HistogramFile::EXTENSION), state.histograms);
+    
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary);
+        if (!out) throw std::runtime_error("Checkpoint: cannot create " + temporary);
+    
+        out << HEADER << " " << VERSION << "\n"
+            << "slot " << state.slot << "\n"
+            << "run " << state.runId << "\n"
+            << "events " << state.events << "\n"
+            << "resumes " << state.resumes << "\n";
+        out << "done " << state.done.GetRanges().size();
+        for (const EventRanges::Range& range : state.done.GetRanges()) {
+            out << " " << range.first << " " << range.second;
+        }
+        out << "\n";
+        if (!state.eventFile.empty()) {
+            out << "event_format " << (state.binaryEvents ? "binary" : "text") << "\n"
+                << "event_offset " << state.eventPosition.offset << "\n";
+            for (const EventFile::IndexEntry& chunk : state.eventPosition.chunks) {
+                out << "chunk " << chunk.offset << " " << chunk.nRows << " " << chunk.firstEventId << " "
+                    << chunk.lastEventId << "\n";
+            }
+            // Last: the name is the rest of the line
+            out << "event_file " << state.eventFile << "\n";
+        }
+    
+        out.flush();
+        if (!out) throw std::runtime_error("Checkpoint: write error on " + temporary);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Checkpoint: cannot replace " + path);
+    }
+}
+
+State Read(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Checkpoint: cannot open " + path);
+    
+    std::string line;
+    const std::string header = HEADER;
+    if (!std::getline(in, line) || line.compare(0, header.size(), header) != 0) {
+        throw std::runtime_error("Checkpoint: " + path + " is not a checkpoint file");
+    }
+    std::istringstream version(line.substr(header.size()));
+    unsigned fileVersion = 0;
+    if (!(version >> fileVersion) || fileVersion > VERSION) {
+        throw std::runtime_error("Checkpoint: " + path + " has a newer format version");
+    }
+    
+    State state;
+    bool hasFormat = false;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "slot") {
+            if (!(fields >> state.slot) || state.slot > 1) Fail(path, line);
+        } else if (key == "run") {
+            if (!(fields >> state.runId)) Fail(path, line);
+        } else if (key == "events") {
+            if (!(fields >> state.events)) Fail(path, line);
+        } else if (key == "resumes") {
+            if (!(fields >> state.resumes)) Fail(path, line);
+        } else if (key == "done") {
+            std::size_t n = 0;
+            if (!(fields >> n)) Fail(path, line);
+            for (std::size_t i = 0; i < n; ++i) {
+                EventRanges::Range range;
+                if (!(fields >> range.first >> range.second)) Fail(path, line);
+                state.done.Add(range);
+            }
+        } else if (key == "event_format") {
+            std::string format;
+            if (!(fields >> format) || (format != "binary" && format != "text")) Fail(path, line);
+            state.binaryEvents = format == "binary";
+            hasFormat = true;
+        } else if (key == "event_offset") {
+            if (!(fields >> state.eventPosition.offset)) Fail(path, line);
+        } else if (key == "chunk") {
+            EventFile::IndexEntry chunk = {};
+            if (!(fields >> chunk.offset >> chunk.nRows >> chunk.firstEventId >> chunk.lastEventId)) {
+                Fail(path, line);
+            }
+            state.eventPosition.chunks.push_back(chunk);
+        } else if (key == "event_file") {
+            state.eventFile = line.size() > key.size() + 1 ? line.substr(key.size() + 1) : std::string();
+        } else {
+            Fail(path, line);
+        }
+    }
+    if (!state.eventFile.empty() && !hasFormat) {
+        throw std::runtime_error("Checkpoint: " + path + " has no event format");
+    }
+    
+    state.counters = CounterFile::Read(SlotName(path, state.slot, CounterFile::EXTENSION));
+    state.histograms = HistogramFile::Read(SlotName(path, state.slot, HistogramFile::EXTENSION));
+    return state;
+}
+
+bool Exists(const std::string& path) {
+    std::ifstream file(path);
+    return file.good();
+}
+
+void Remove(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + ".tmp").c_str());
+    for (unsigned slot = 0; slot < 2; ++slot) {
+        std::remove(SlotName(path, slot, CounterFile::EXTENSION).c_str());
+        std::remove(SlotName(path, slot, HistogramFile::EXTENSION).c_str());
+    }
+}
+
+//==============================================================================
+// Resuming the event file
+//==============================================================================
+
+namespace {
+    std::uint64_t PrepareBinary(State& state, const std::string& original) {
+        // Cut the original at the checkpoint and give it the index and
+        // trailer of the chunks before that point
+        const std::vector<EventFile::IndexEntry>& chunks = state.eventPosition.chunks;
+        const std::uint64_t offset = state.eventPosition.offset;
+        struct stat info;
+        if (::stat(original.c_str(), &info) != 0 || static_cast<std::uint64_t>(info.st_size) < offset ||
+            ::truncate(original.c_str(), static_cast<off_t>(offset)) != 0) {
+            throw std::runtime_error("Checkpoint: " + state.eventFile + " is shorter than the checkpoint");
+        }
+    
+        EventFile::FileHeader header;
+        EventFile::FileTrailer trailer = {};
+        trailer.indexOffset = offset;
+        trailer.nChunks = chunks.size();
+        for (const EventFile::IndexEntry& chunk : chunks) trailer.nRows += chunk.nRows;
+        std::memcpy(trailer.magic, EventFile::TRAILER_MAGIC, sizeof(trailer.magic));
+    
+        std::FILE* file = std::fopen(original.c_str(), "r+b");
+        bool ok = file && std::fread(&header, sizeof(header), 1, file) == 1 &&
+                  std::fseek(file, 0, SEEK_END) == 0;
+        if (ok && !chunks.empty()) {
+            ok = std::fwrite(chunks.data(), sizeof(EventFile::IndexEntry), chunks.size(), file) == chunks.size();
+        }
+        ok = ok && std::fwrite(&trailer, sizeof(trailer), 1, file) == 1;
+        if (file && std::fclose(file) != 0) ok = false;
+        if (!ok) throw std::runtime_error("Checkpoint: cannot repair " + original);
+    
+        // Keep the records of the finished events only
+        std::uint64_t kept = 0;
+        {
+            const EventFile::EventFileReader reader(original);
+            EventFile::EventFileWriter writer(state.eventFile, header.chunkRows);
+            for (std::uint64_t c = 0; c < reader.GetNumberOfChunks(); ++c) {
+                const EventFile::ChunkView view = reader.GetChunk(c);
+                for (std::uint32_t row = 0; row < view.nRows; ++row) {
+                    const EventFile::EventRecord record = view.GetRecord(row);
+                    if (state.done.Contains(record.eventId)) writer.Append(record);
+                }
+            }
+            writer.Close();
+            kept = writer.GetNumberOfRows();
+        }
+    
+        // Where the appended chunks will start
+        const EventFile::EventFileReader rebuilt(state.eventFile);
+        state.eventPosition.chunks.clear();
+        for (std::uint64_t c = 0; c < rebuilt.GetNumberOfChunks(); ++c) {
+            state.eventPosition.chunks.push_back(rebuilt.GetIndexEntry(c));
+        }
+        state.eventPosition.offset = rebuilt.GetFileSize() - sizeof(EventFile::FileTrailer) -
+                                     rebuilt.GetNumberOfChunks()*sizeof(EventFile::IndexEntry);
+        return kept;
+    }
+    
+    std::uint64_t PrepareText(State& state, const std::string& original) {
+        std::ifstream in(original, std::ios::binary);
+        std::ofstream out(state.eventFile, std::ios::binary);
+        if (!in || !out) throw std::runtime_error("Checkpoint: cannot rewrite " + state.eventFile);
+    
+        std::uint64_t consumed = 0;
+        std::uint64_t kept = 0;
+        std::string line;
+        while (consumed < state.eventPosition.offset && std::getline(in, line)) {
+            consumed += line.size() + 1;
+            if (line.empty()) continue;
+            if (line[0] == '#') {
+                out << line << "\n";
+            } else if (state.done.Contains(std::strtoll(line.c_str(), nullptr, 10))) {
+                out << line << "\n";
+                ++kept;
+            }
+        }
+        if (consumed < state.eventPosition.offset) {
+            throw std::runtime_error("Checkpoint: " + state.eventFile + " is shorter than the checkpoint");
+        }
+        out.flush();
+        if (!out) throw std::runtime_error("Checkpoint: write error on " + state.eventFile);
+        state.eventPosition.offset = static_cast<std::uint64_t>(out.tellp());
+        return kept;
+    }
+    
+    std::string BackupName(const State& state, std::uint32_t resumes) {
+        return state.eventFile + ".resume" + std::to_string(resumes);
+    }
+}
+
+std::uint64_t PrepareEventFile(const std::string& path, State& state) {
+    if (state.eventFile.empty()) return 0;
+    
+    // The backup of this checkpoint's resume count is its original: the
+    // event file next to it is incomplete. One of the previous count is
+    // left over from an interruption after the checkpoint was replaced.
+    if (state.resumes > 0) std::remove(BackupName(state, state.resumes - 1).c_str());
+    const std::string original = BackupName(state, state.resumes);
+    if (!Exists(original) && std::rename(state.eventFile.c_str(), original.c_str()) != 0) {
+        throw std::runtime_error("Checkpoint: cannot move " + state.eventFile + " aside");
+    }
+    const std::uint64_t kept = state.binaryEvents ? PrepareBinary(state, original)
+                                                  : PrepareText(state, original);
+    
+    // From here on the checkpoint describes the rebuilt file
+    state.resumes++;
+    state.slot = 1 - state.slot;
+    Write(path, state);
+    std::remove(original.c_str());
+    return kept;
+}
+
+//==============================================================================
+// Coordinator
+//==============================================================================
+
+Coordinator::Coordinator()
+    : fInterval(0.0), fWriter(nullptr), fActive(false), fRequest(0), fStopping(false),
+      fCheckpoints(0) {}
+
+Coordinator::~Coordinator() {
+    Stop();
+}
+
+void Coordinator::Start(const std::string& path, const State& base, double interval,
+                        const EventFile::AsyncEventWriter* writer) {
+    Stop();
+    if (base.done.IsEmpty()) Remove(path);
+    
+    std::lock_guard<std::mutex> lock(fMutex);
+    fPath = path;
+    fBase = base;
+    fInterval = interval;
+    fWriter = writer;
+    fSlots.clear();
+    fStopping = false;
+    fCheckpoints = 0;
+    fError.clear();
+    fActive.store(true, std::memory_order_relaxed);
+    fThread = std::thread(&Coordinator::Loop, this);
+}
+
+void Coordinator::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fWake.notify_all();
+    if (fThread.joinable()) fThread.join();
+    fActive.store(false, std::memory_order_relaxed);
+}
+
+void Coordinator::Register(int thread) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    Slot& slot = fSlots[thread];
+    slot.answered = fRequest.load(std::memory_order_relaxed);
+    slot.final = false;
+}
+
+void Coordinator::Submit(int thread, std::uint32_t request, Snapshot snapshot, bool final) {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        Slot& slot = fSlots[thread];
+        slot.answered = request;
+        slot.final = final;
+        slot.snapshot = std::move(snapshot);
+    }
+    fWake.notify_all();
+}
+
+std::uint32_t Coordinator::GetNumberOfCheckpoints() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fCheckpoints;
+}
+
+std::string Coordinator::GetError() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fError;
+}
+
+bool Coordinator::Answered(std::uint32_t request) const {
+    for (const auto& slot : fSlots) {
+        if (!slot.second.final && slot.second.answered != request) return false;
+    }
+    return true;
+}
+
+void Coordinator::Loop() {
+    const auto interval = std::chrono::duration<double>(fInterval);
+    std::unique_lock<std::mutex> lock(fMutex);
+    for (;;) {
+        if (fWake.wait_for(lock, interval, [this] { return fStopping; })) return;
+    
+        const std::uint32_t request = fRequest.load(std::memory_order_relaxed) + 1;
+        fRequest.store(request, std::memory_order_relaxed);
+        fWake.wait(lock, [this, request] { return fStopping || Answered(request); });
+        if (fStopping) return;
+    
+        // Every thread has flushed the records of the events in its
+        // snapshot, so they lie before the writer's position
+        State state = fBase;
+        state.slot = 1 - fBase.slot;
+        for (const auto& slot : fSlots) {
+            state.counters.Merge(slot.second.snapshot.counters);
+            if (state.histograms.Size() == 0) {
+                state.histograms = slot.second.snapshot.histograms;
+            } else {
+                state.histograms.Merge(slot.second.snapshot.histograms);
+            }
+            state.done.Merge(slot.second.snapshot.done);
+        }
+        if (fWriter) state.eventPosition = fWriter->GetPosition();
+    
+        lock.unlock();
+        std::string error;
+        try {
+            Write(fPath, state);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        lock.lock();
+        if (error.empty()) {
+            fBase.slot = state.slot;
+            ++fCheckpoints;
+        } else {
+            fError = error;
+        }
+    }
+}
+
+} // namespace Checkpoint
@@ -0,0 +1,91 @@
+// src/Counters.cc
+#include "Counters.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+//==============================================================================
+// CounterSet
+//==============================================================================
+
+const std::vector<double>* CounterSet::Find(const std::string& name) const {
+    const auto it = fCounters.find(name);
+    return it != fCounters.end() ? &it->second : nullptr;
+}
+
+double CounterSet::Get(const std::string& name, std::size_t index) const {
+    const std::vector<double>* values = Find(name);
+    return values && index < values->size() ? (*values)[index] : 0.0;
+}
+
+void CounterSet::Merge(const CounterSet& other) {
+    for (const auto& counter : other.fCounters) {
+        std::vector<double>& values = fCounters[counter.first];
+        if (values.size() < counter.second.size()) values.resize(counter.second.size(), 0.0);
+        for (std::size_t i = 0; i < counter.second.size(); ++i) values[i] += counter.second[i];
+    }
+}
+
+//==============================================================================
+// CounterFile
+//==============================================================================
+
+namespace CounterFile {
+
+void Write(const std::string& path, const CounterSet& counters) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("CounterFile: cannot create " + path);
+    
+    out << HEADER << " " << VERSION << "\n";
+    char value[32];
+    for (const auto& counter : counters.GetCounters()) {
+        out << counter.first << " " << counter.second.size();
+        for (double v : counter.second) {
+            std::snprintf(value, sizeof(value), " %.17g", v);
+            out << value;
+        }
+        out << "\n";
+    }
+    
+    out.flush();
+    if (!out) throw std::runtime_error("CounterFile: write error on " + path);
+}
+
+CounterSet Read(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("CounterFile: cannot open " + path);
+    
+    std::string line;
+    const std::string header = HEADER;
+    if (!std::getline(in, line) || line.compare(0, header.size(), header) != 0) {
+        throw std::runtime_error("CounterFile: " + path + " is not a counter file");
+    }
+    std::istringstream version(line.substr(header.size()));
+    unsigned fileVersion = 0;
+    if (!(version >> fileVersion) || fileVersion > VERSION) {
+        throw std::runtime_error("CounterFile: " + path + " has a newer format version");
+    }
+    
+    CounterSet counters;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        std::string name;
+        std::size_t n = 0;
+        if (!(fields >> name >> n)) {
+            throw std::runtime_error("CounterFile: malformed line in " + path + ": " + line);
+        }
+        std::vector<double> values(n);
+        for (double& v : values) {
+            if (!(fields >> v)) {
+                throw std::runtime_error("CounterFile: malformed line in " + path + ": " + line);
+            }
+        }
+        counters.Set(name, values);
+    }
+    return counters;
+}
+
+} // namespace CounterFile
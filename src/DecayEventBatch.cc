@@ -0,0 +1,114 @@
+// src/DecayEventBatch.cc
+#include "DecayEventBatch.hh"
+
+const char* DecayEventBatch::GetParticleName(ParticleType type) {
+    switch (type) {
+        case ParticleType::Electron:     return "e-";
+        case ParticleType::Positron:     return "e+";
+        case ParticleType::Neutrino:     return "nu_e";
+        case ParticleType::AntiNeutrino: return "anti_nu_e";
+        case ParticleType::Gamma:        return "gamma";
+        case ParticleType::Recoil:       return "recoil";
+    }
+    return "unknown";
+}
+
+std::int32_t DecayEventBatch::GetPDGCode(ParticleType type) {
+    switch (type) {
+        case ParticleType::Electron:     return 11;
+        case ParticleType::Positron:     return -11;
+        case ParticleType::Neutrino:     return 12;
+        case ParticleType::AntiNeutrino: return -12;
+        case ParticleType::Gamma:        return 22;
+        case ParticleType::Recoil:       return 0;
+    }
+    return 0;
+}
+
+void DecayEventBatch::ParticleView::GetDirection(double direction[3]) const {
+    const double p = GetMomentum();
+    const double scale = p > 0.0 ? 1.0/p : 0.0;
+    direction[0] = GetPx()*scale;
+    direction[1] = GetPy()*scale;
+    direction[2] = GetPz()*scale;
+}
+
+double DecayEventBatch::EventView::GetTotalEnergy() const {
+    double total = 0.0;
+    for (std::size_t i = GetFirstParticle(); i < GetLastParticle(); ++i) {
+        total += fBatch->fEnergy[i];
+    }
+    return total;
+}
+
+double DecayEventBatch::EventView::GetVisibleEnergy() const {
+    double total = 0.0;
+    for (std::size_t i = GetFirstParticle(); i < GetLastParticle(); ++i) {
+        const ParticleType type = fBatch->fType[i];
+        if (type == ParticleType::Electron || type == ParticleType::Positron) {
+            total += fBatch->fEnergy[i];
+        }
+    }
+    return total;
+}
+
+void DecayEventBatch::Clear() {
+    fEventId.clear();
+    fDecayType.clear();
+    fQValue.clear();
+    fDaughterZ.clear();
+    fDaughterA.clear();
+    fParticleOffset.resize(1);
+    fType.clear();
+    fEnergy.clear();
+    fPx.clear();
+    fPy.clear();
+    fPz.clear();
+}
+
+void DecayEventBatch::Reserve(std::size_t nEvents, std::size_t nParticles) {
+    fEventId.reserve(nEvents);
+    fDecayType.reserve(nEvents);
+    fQValue.reserve(nEvents);
+    fDaughterZ.reserve(nEvents);
+    fDaughterA.reserve(nEvents);
+    fParticleOffset.reserve(nEvents + 1);
+    fType.reserve(nParticles);
+    fEnergy.reserve(nParticles);
+    fPx.reserve(nParticles);
+    fPy.reserve(nParticles);
+    fPz.reserve(nParticles);
+}
+
+void DecayEventBatch::DiscardEvent() {
+    if (fEventId.empty()) return;
+    fParticleOffset.pop_back();
+    const std::size_t nParticles = fParticleOffset.back();
+    fType.resize(nParticles);
+    fEnergy.resize(nParticles);
+    fPx.resize(nParticles);
+    fPy.resize(nParticles);
+    fPz.resize(nParticles);
+    fEventId.pop_back();
+    fDecayType.pop_back();
+    fQValue.pop_back();
+    fDaughterZ.pop_back();
+    fDaughterA.pop_back();
+}
+
+void DecayEventBatch::Append(const DecayEventBatch& other) {
+    const std::uint32_t base = fParticleOffset.back();
+    fEventId.insert(fEventId.end(), other.fEventId.begin(), other.fEventId.end());
+    fDecayType.insert(fDecayType.end(), other.fDecayType.begin(), other.fDecayType.end());
+    fQValue.insert(fQValue.end(), other.fQValue.begin(), other.fQValue.end());
+    fDaughterZ.insert(fDaughterZ.end(), other.fDaughterZ.begin(), other.fDaughterZ.end());
+    fDaughterA.insert(fDaughterA.end(), other.fDaughterA.begin(), other.fDaughterA.end());
+    for (std::size_t i = 1; i < other.fParticleOffset.size(); ++i) {
+        fParticleOffset.push_back(base + other.fParticleOffset[i]);
+    }
+    fType.insert(fType.end(), other.fType.begin(), other.fType.end());
+    fEnergy.insert(fEnergy.end(), other.fEnergy.begin(), other.fEnergy.end());
+    fPx.insert(fPx.end(), other.fPx.begin(), other.fPx.end());
+    fPy.insert(fPy.end(), other.fPy.begin(), other.fPy.end());
+    fPz.insert(fPz.end(), other.fPz.begin(), other.fPz.end());
+}
@@ -1,32 +1,115 @@
 #include "DetectorConstruction.hh"
+#include "DetectorMessenger.hh"
+#include "ElectronFastModel.hh"
 #include "G4NistManager.hh"
 #include "G4Box.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4PVParameterised.hh"
+#include "G4RegionStore.hh"
+#include "G4VPVParameterisation.hh"
+#include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
+#include <algorithm>
+#include <cmath>
 
-DetectorConstruction::DetectorConstruction() {}
-DetectorConstruction::~DetectorConstruction() {}
+namespace {
+    // Places copy ix*ny + iy of the crystal at its grid position in the
+    // envelope; all copies share the solid, so only the translation changes
+    class CrystalArrayParameterisation : public G4VPVParameterisation {
+    public:
+        CrystalArrayParameterisation(G4int nx, G4int ny, G4double pitch)
+            : fNy(ny), fX0(-0.5*(nx - 1)*pitch), fY0(-0.5*(ny - 1)*pitch), fPitch(pitch) {}
+    
+        void ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* volume) const override {
+            volume->SetTranslation(G4ThreeVector(fX0 + (copyNo/fNy)*fPitch,
+                                                 fY0 + (copyNo%fNy)*fPitch, 0.));
+            volume->SetRotation(nullptr);
+        }
+    
+    private:
+        G4int fNy;
+        G4double fX0;
+        G4double fY0;
+        G4double fPitch;
+    };
+}
+
+DetectorConstruction::ArraySettings::ArraySettings()
+    : nx(1), ny(1), pitch(10.0*cm), crystalSize(10.0*cm, 10.0*cm, 10.0*cm),
+      material("G4_SODIUM_IODIDE"), distance(20.0*cm), layout(Layout::REPLICA),
+      smartless(2.0), optimise(true) {}
+
+DetectorConstruction::FastSimSettings::FastSimSettings()
+    : enabled(false), threshold(500*keV), leakage(true), annihilation(true) {}
+
+G4ThreadLocal ElectronFastModel* DetectorConstruction::fFastModel = nullptr;
+
+DetectorConstruction::DetectorConstruction()
+    : fSourceVolume(nullptr), fDetectorVolume(nullptr), fGeometryVersion(0) {
+    fMessenger = new DetectorMessenger(this);
+}
+
+DetectorConstruction::~DetectorConstruction() {
+    delete fMessenger;
+}
+
+void DetectorConstruction::SetArraySettings(const ArraySettings& settings) {
+    fSettings = settings;
+    
+    // Before the first Construct() there is nothing to rebuild
+    if (fGeometryVersion > 0) G4RunManager::GetRunManager()->ReinitializeGeometry(true);
+}
 
 G4VPhysicalVolume* DetectorConstruction::Construct() {
     // Get material manager
     G4NistManager* nist = G4NistManager::Instance();
     
-    // Create world volume
-    G4double worldSize = 1.0*m;
+    ArraySettings array = fSettings;
+    array.nx = std::max(1, array.nx);
+    array.ny = std::max(1, array.ny);
+    if (array.crystalSize.x() > array.pitch || array.crystalSize.y() > array.pitch) {
+        G4cerr << "WARNING: crystals wider than the pitch of " << array.pitch/cm
+               << " cm would overlap; their x and y size is reduced to the pitch" << G4endl;
+        array.crystalSize.setX(std::min(array.crystalSize.x(), array.pitch));
+        array.crystalSize.setY(std::min(array.crystalSize.y(), array.pitch));
+    }
+    G4Material* detMat = nist->FindOrBuildMaterial(array.material);
+    if (!detMat) {
+        G4cerr << "WARNING: unknown material " << array.material
+               << ", using G4_SODIUM_IODIDE" << G4endl;
+        array.material = "G4_SODIUM_IODIDE";
+        detMat = nist->FindOrBuildMaterial(array.material);
+    }
+    
+    // Create world volume, large enough for the array
+    const G4double arrayHalfX = 0.5*array.nx*array.pitch;
+    const G4double arrayHalfY = 0.5*array.ny*array.pitch;
+    const G4double arrayHalfZ = 0.5*array.crystalSize.z();
+    G4double worldSize = std::max(1.0*m, 2.0*(std::max(arrayHalfX, arrayHalfY) + 10.0*cm));
+    worldSize = std::max(worldSize, 2.0*(std::abs(array.distance) + arrayHalfZ + 10.0*cm));
     G4Material* worldMat = nist->FindOrBuildMaterial("G4_AIR");
     
     G4Box* solidWorld = new G4Box("World", worldSize/2, worldSize/2, worldSize/2);
     G4LogicalVolume* logicWorld = new G4LogicalVolume(solidWorld, worldMat, "World");
     G4VPhysicalVolume* physWorld = new G4PVPlacement(0, G4ThreeVector(), logicWorld, "World", 0, false, 0);
     
-    // Create a simple detector (NaI scintillator)
-    G4double detSize = 10.0*cm;
-    G4Material* detMat = nist->FindOrBuildMaterial("G4_SODIUM_IODIDE");
+    // Detector array (NaI scintillator crystals by default) in an air envelope
+    G4Box* solidEnvelope = new G4Box("DetectorArray", arrayHalfX, arrayHalfY, arrayHalfZ);
+    G4LogicalVolume* logicEnvelope = new G4LogicalVolume(solidEnvelope, worldMat, "DetectorArray");
+    new G4PVPlacement(0, G4ThreeVector(0, 0, array.distance), logicEnvelope, "DetectorArray",
+                      logicWorld, false, 0);
+    logicEnvelope->SetSmartless(array.smartless);
+    logicEnvelope->SetOptimisation(array.optimise);
     
-    G4Box* solidDet = new G4Box("Detector", detSize/2, detSize/2, detSize/2);
+    G4Box* solidDet = new G4Box("Detector", array.crystalSize.x()/2, array.crystalSize.y()/2,
+                                array.crystalSize.z()/2);
     G4LogicalVolume* logicDet = new G4LogicalVolume(solidDet, detMat, "Detector");
-    new G4PVPlacement(0, G4ThreeVector(0, 0, 20*cm), logicDet, "Detector", logicWorld, false, 0);
+    fBuilt = array;
+    if (array.layout == Layout::PARAMETERISED) BuildParameterisedArray(logicEnvelope, logicDet);
+    else BuildReplicaArray(logicEnvelope, logicDet);
+    fDetectorVolume = logicDet;
     
     // Create source volume (where beta decays happen)
     G4double sourceSize = 1.0*cm;
@@ -35,6 +118,54 @@ G4VPhysicalVolume* DetectorConstruction::Construct() {
     G4Box* solidSource = new G4Box("Source", sourceSize/2, sourceSize/2, sourceSize/2);
     G4LogicalVolume* logicSource = new G4LogicalVolume(solidSource, sourceMat, "Source");
     new G4PVPlacement(0, G4ThreeVector(0, 0, 0), logicSource, "Source", logicWorld, false, 0);
+    fSourceVolume = logicSource;
+    
+    // Production-cut regions (cuts are set by PhysicsList); the world keeps
+    // the default region. Regions outlive a rebuild, the volumes do not.
+    G4RegionStore* regions = G4RegionStore::GetInstance();
+    regions->FindOrCreateRegion("Source")->AddRootLogicalVolume(logicSource);
+    regions->FindOrCreateRegion("Detector")->AddRootLogicalVolume(logicEnvelope);
+    
+    ++fGeometryVersion;
+    G4cout << "Detector array: " << array.nx << " x " << array.ny << " " << array.material
+           << " crystals (" << (array.layout == Layout::PARAMETERISED ? "parameterised" : "replica")
+           << "), pitch " << array.pitch/cm << " cm, centre at z = " << array.distance/cm
+           << " cm" << G4endl;
     
     return physWorld;
 }
+
+void DetectorConstruction::ConstructSDandField() {
+    // Called again on every rebuild; the region, and the model attached to
+    // it, outlive the volumes
+    if (fFastModel) return;
+    G4Region* region = G4RegionStore::GetInstance()->GetRegion("Detector", false);
+    if (region) fFastModel = new ElectronFastModel("ElectronFastModel", region, this);
+}
+
+void DetectorConstruction::BuildReplicaArray(G4LogicalVolume* envelope, G4LogicalVolume* crystal) {
+    const ArraySettings& array = fBuilt;
+    G4Material* air = envelope->GetMaterial();
+    const G4double halfZ = 0.5*array.crystalSize.z();
+    
+    G4Box* solidColumn = new G4Box("DetectorColumn", 0.5*array.pitch, 0.5*array.ny*array.pitch, halfZ);
+    G4LogicalVolume* logicColumn = new G4LogicalVolume(solidColumn, air, "DetectorColumn");
+    new G4PVReplica("DetectorColumn", logicColumn, envelope, kXAxis, array.nx, array.pitch);
+    logicColumn->SetSmartless(array.smartless);
+    logicColumn->SetOptimisation(array.optimise);
+    
+    G4Box* solidCell = new G4Box("DetectorCell", 0.5*array.pitch, 0.5*array.pitch, halfZ);
+    G4LogicalVolume* logicCell = new G4LogicalVolume(solidCell, air, "DetectorCell");
+    new G4PVReplica("DetectorCell", logicCell, logicColumn, kYAxis, array.ny, array.pitch);
+    
+    new G4PVPlacement(0, G4ThreeVector(), crystal, "Detector", logicCell, false, 0);
+}
+
+void DetectorConstruction::BuildParameterisedArray(G4LogicalVolume* envelope,
+                                                   G4LogicalVolume* crystal) {
+    const ArraySettings& array = fBuilt;
+    
+    // kUndefined: the envelope's smart voxels are built in all three axes
+    new G4PVParameterised("Detector", crystal, envelope, kUndefined, array.nx*array.ny,
+                          new CrystalArrayParameterisation(array.nx, array.ny, array.pitch));
+}
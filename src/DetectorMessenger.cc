@@ -0,0 +1,194 @@
+// src/DetectorMessenger.cc
+#include "DetectorMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+#include <sstream>
+
+DetectorMessenger::DetectorMessenger(DetectorConstruction* detector)
+    : G4UImessenger(), fDetector(detector) {
+    fDirectory = new G4UIdirectory("/betadecay/detector/");
+    fDirectory->SetGuidance("Segmented detector array (rebuilt before the next run)");
+    
+    fArraySizeCmd = new G4UIcommand("/betadecay/detector/arraySize", this);
+    fArraySizeCmd->SetGuidance("Number of crystals in x and y.");
+    G4UIparameter* nx = new G4UIparameter("nx", 'i', false);
+    nx->SetParameterRange("nx>0");
+    fArraySizeCmd->SetParameter(nx);
+    G4UIparameter* ny = new G4UIparameter("ny", 'i', false);
+    ny->SetParameterRange("ny>0");
+    fArraySizeCmd->SetParameter(ny);
+    
+    fPitchCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/detector/pitch", this);
+    fPitchCmd->SetGuidance("Centre-to-centre distance of neighbouring crystals.");
+    fPitchCmd->SetParameterName("pitch", false);
+    fPitchCmd->SetRange("pitch>0");
+    fPitchCmd->SetUnitCategory("Length");
+    
+    fCrystalSizeCmd = new G4UIcmdWith3VectorAndUnit("/betadecay/detector/crystalSize", this);
+    fCrystalSizeCmd->SetGuidance("Full x, y and z length of a crystal (x and y at most the pitch).");
+    fCrystalSizeCmd->SetParameterName("x", "y", "z", false);
+    fCrystalSizeCmd->SetUnitCategory("Length");
+    
+    fMaterialCmd = new G4UIcmdWithAString("/betadecay/detector/material", this);
+    fMaterialCmd->SetGuidance("NIST material of the crystals, e.g. G4_SODIUM_IODIDE, G4_CESIUM_IODIDE,");
+    fMaterialCmd->SetGuidance("G4_BGO, G4_Ge or G4_PLASTIC_SC_VINYLTOLUENE.");
+    fMaterialCmd->SetParameterName("material", false);
+    
+    fDistanceCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/detector/distance", this);
+    fDistanceCmd->SetGuidance("Position of the array centre on the z axis (source at 0).");
+    fDistanceCmd->SetParameterName("distance", false);
+    fDistanceCmd->SetUnitCategory("Length");
+    
+    fLayoutCmd = new G4UIcmdWithAString("/betadecay/detector/layout", this);
+    fLayoutCmd->SetGuidance("How the array is built:");
+    fLayoutCmd->SetGuidance("  replica       : nested x and y replicas (indexed navigation)");
+    fLayoutCmd->SetGuidance("  parameterised : one parameterised volume (smart voxels)");
+    fLayoutCmd->SetParameterName("layout", false);
+    fLayoutCmd->SetCandidates("replica parameterised");
+    
+    fSmartlessCmd = new G4UIcmdWithADouble("/betadecay/detector/smartless", this);
+    fSmartlessCmd->SetGuidance("Smart voxels per daughter volume in the array volumes");
+    fSmartlessCmd->SetGuidance("(Geant4 default 2). Larger values trade memory for fewer");
+    fSmartlessCmd->SetGuidance("candidate volumes per navigation step.");
+    fSmartlessCmd->SetParameterName("smartless", false);
+    fSmartlessCmd->SetRange("smartless>0");
+    
+    fOptimiseCmd = new G4UIcmdWithABool("/betadecay/detector/optimise", this);
+    fOptimiseCmd->SetGuidance("Build smart voxels for the array volumes.");
+    fOptimiseCmd->SetParameterName("optimise", true);
+    fOptimiseCmd->SetDefaultValue(true);
+    
+    fFastSimDirectory = new G4UIdirectory("/betadecay/fastsim/");
+    fFastSimDirectory->SetGuidance("Local absorption of low-energy e-/e+ in the crystals. Run the");
+    fFastSimDirectory->SetGuidance("same seed with it off and on to compare against full tracking.");
+    
+    fFastSimEnableCmd = new G4UIcmdWithABool("/betadecay/fastsim/enable", this);
+    fFastSimEnableCmd->SetGuidance("Use the fast simulation from the next run (off by default).");
+    fFastSimEnableCmd->SetGuidance("The run summary compares the last fast and full runs.");
+    fFastSimEnableCmd->SetParameterName("enable", true);
+    fFastSimEnableCmd->SetDefaultValue(true);
+    
+    fThresholdCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/fastsim/threshold", this);
+    fThresholdCmd->SetGuidance("Kinetic energy below which e-/e+ in a crystal deposit");
+    fThresholdCmd->SetGuidance("their energy at once (default 500 keV).");
+    fThresholdCmd->SetParameterName("energy", false);
+    fThresholdCmd->SetRange("energy>0");
+    fThresholdCmd->SetUnitCategory("Energy");
+    
+    fLeakageCmd = new G4UIcmdWithABool("/betadecay/fastsim/leakage", this);
+    fLeakageCmd->SetGuidance("Emit the parameterised bremsstrahlung yield as a tracked photon");
+    fLeakageCmd->SetGuidance("instead of depositing it (default on).");
+    fLeakageCmd->SetParameterName("leakage", true);
+    fLeakageCmd->SetDefaultValue(true);
+    
+    fAnnihilationCmd = new G4UIcmdWithABool("/betadecay/fastsim/annihilation", this);
+    fAnnihilationCmd->SetGuidance("Replace absorbed positrons by two back-to-back 511 keV");
+    fAnnihilationCmd->SetGuidance("photons (default on).");
+    fAnnihilationCmd->SetParameterName("annihilation", true);
+    fAnnihilationCmd->SetDefaultValue(true);
+    
+    // The detector is shared by all threads: master only
+    G4UIcommand* const commands[] = {fArraySizeCmd, fPitchCmd, fCrystalSizeCmd, fMaterialCmd,
+                                     fDistanceCmd, fLayoutCmd, fSmartlessCmd, fOptimiseCmd,
+                                     fFastSimEnableCmd, fThresholdCmd, fLeakageCmd,
+                                     fAnnihilationCmd};
+    for (G4UIcommand* command : commands) {
+        command->AvailableForStates(G4State_PreInit, G4State_Idle);
+        command->SetToBeBroadcasted(false);
+    }
+}
+
+DetectorMessenger::~DetectorMessenger() {
+    delete fAnnihilationCmd;
+    delete fLeakageCmd;
+    delete fThresholdCmd;
+    delete fFastSimEnableCmd;
+    delete fFastSimDirectory;
+    delete fOptimiseCmd;
+    delete fSmartlessCmd;
+    delete fLayoutCmd;
+    delete fDistanceCmd;
+    delete fMaterialCmd;
+    delete fCrystalSizeCmd;
+    delete fPitchCmd;
+    delete fArraySizeCmd;
+    delete fDirectory;
+}
+
+void DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue) {
+    // Fast-simulation settings need no rebuild
+    DetectorConstruction::FastSimSettings fastSim = fDetector->GetFastSimSettings();
+    G4bool fastSimCommand = true;
+    if (command == fFastSimEnableCmd) {
+        fastSim.enabled = fFastSimEnableCmd->GetNewBoolValue(newValue);
+    } else if (command == fThresholdCmd) {
+        fastSim.threshold = fThresholdCmd->GetNewDoubleValue(newValue);
+    } else if (command == fLeakageCmd) {
+        fastSim.leakage = fLeakageCmd->GetNewBoolValue(newValue);
+    } else if (command == fAnnihilationCmd) {
+        fastSim.annihilation = fAnnihilationCmd->GetNewBoolValue(newValue);
+    } else {
+        fastSimCommand = false;
+    }
+    if (fastSimCommand) {
+        fDetector->SetFastSimSettings(fastSim);
+        return;
+    }
+    
+    DetectorConstruction::ArraySettings settings = fDetector->GetArraySettings();
+    
+    if (command == fArraySizeCmd) {
+        std::istringstream values(newValue);
+        values >> settings.nx >> settings.ny;
+    } else if (command == fPitchCmd) {
+        settings.pitch = fPitchCmd->GetNewDoubleValue(newValue);
+    } else if (command == fCrystalSizeCmd) {
+        settings.crystalSize = fCrystalSizeCmd->GetNew3VectorValue(newValue);
+    } else if (command == fMaterialCmd) {
+        settings.material = newValue;
+    } else if (command == fDistanceCmd) {
+        settings.distance = fDistanceCmd->GetNewDoubleValue(newValue);
+    } else if (command == fLayoutCmd) {
+        settings.layout = (newValue == "parameterised") ? DetectorConstruction::Layout::PARAMETERISED
+                                                        : DetectorConstruction::Layout::REPLICA;
+    } else if (command == fSmartlessCmd) {
+        settings.smartless = fSmartlessCmd->GetNewDoubleValue(newValue);
+    } else if (command == fOptimiseCmd) {
+        settings.optimise = fOptimiseCmd->GetNewBoolValue(newValue);
+    }
+    
+    fDetector->SetArraySettings(settings);
+}
+
+G4String DetectorMessenger::GetCurrentValue(G4UIcommand* command) {
+    const DetectorConstruction::ArraySettings& settings = fDetector->GetArraySettings();
+    
+    if (command == fArraySizeCmd) {
+        return G4UIcommand::ConvertToString(settings.nx) + " " +
+               G4UIcommand::ConvertToString(settings.ny);
+    }
+    if (command == fPitchCmd) return G4UIcommand::ConvertToString(settings.pitch, "cm");
+    if (command == fCrystalSizeCmd) return G4UIcommand::ConvertToString(settings.crystalSize, "cm");
+    if (command == fMaterialCmd) return settings.material;
+    if (command == fDistanceCmd) return G4UIcommand::ConvertToString(settings.distance, "cm");
+    if (command == fLayoutCmd) {
+        return settings.layout == DetectorConstruction::Layout::PARAMETERISED ? "parameterised"
+                                                                             : "replica";
+    }
+    if (command == fSmartlessCmd) return G4UIcommand::ConvertToString(settings.smartless);
+    if (command == fOptimiseCmd) return G4UIcommand::ConvertToString(settings.optimise);
+    
+    const DetectorConstruction::FastSimSettings& fastSim = fDetector->GetFastSimSettings();
+    if (command == fFastSimEnableCmd) return G4UIcommand::ConvertToString(fastSim.enabled);
+    if (command == fThresholdCmd) return G4UIcommand::ConvertToString(fastSim.threshold, "keV");
+    if (command == fLeakageCmd) return G4UIcommand::ConvertToString(fastSim.leakage);
+    if (command == fAnnihilationCmd) return G4UIcommand::ConvertToString(fastSim.annihilation);
+    return "";
+}
@@ -0,0 +1,274 @@
+// src/DoubleBetaSpectrumTable.cc
+#include "DoubleBetaSpectrumTable.hh"
+#include "BetaSpectrumMath.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    //==========================================================================
+    // Table file
+    //
+    //   CacheHeader
+    //   probability[nCells]   float64
+    //   alias[nCells]         uint32
+    //
+    // Little-endian, native layout; the header is 64 bytes so that the
+    // arrays are 8-byte aligned in the mapping.
+    //==========================================================================
+
+    constexpr char CACHE_MAGIC[8] = {'B', 'D', 'B', 'B', 'T', 'A', 'B', 'L'};
+    constexpr std::uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t mode;
+        std::int32_t Z;
+        std::uint32_t lepton;
+        std::uint64_t nBins;
+        std::uint64_t nCells;
+        double qValue;
+        std::uint64_t reserved[2];
+    };
+    static_assert(sizeof(CacheHeader) == 64, "CacheHeader layout");
+
+    using TableKey = std::tuple<int, long long, int, int>;
+
+    std::mutex gTableMutex;
+    std::map<TableKey, std::shared_ptr<const DoubleBetaSpectrumTable>> gTableCache;
+    std::string gCacheDirectory;
+
+    // Two-point Gauss-Legendre nodes on [0, 1]
+    constexpr double GAUSS_LOW = 0.21132486540518711775;
+    constexpr double GAUSS_HIGH = 0.78867513459481288225;
+
+    double Power5(double x) {
+        const double x2 = x*x;
+        return x2*x2*x;
+    }
+}
+
+DoubleBetaSpectrumTable::DoubleBetaSpectrumTable(int Z, double qValue, Mode mode, Lepton lepton,
+                                                 std::size_t nBins)
+    : fZ(Z), fQValue(qValue), fMode(mode), fLepton(lepton), fNBins(nBins),
+      fNCells(mode == Mode::TwoNeutrino ? nBins*nBins : nBins), fBinWidth(0.0),
+      fProbability(nullptr), fAlias(nullptr), fMapping(nullptr), fMappingSize(0) {
+    if (qValue <= 0.0 || nBins == 0) {
+        throw std::invalid_argument("DoubleBetaSpectrumTable: Q-value and bin count must be positive");
+    }
+    fBinWidth = qValue/nBins;
+    BuildCells();
+}
+
+DoubleBetaSpectrumTable::DoubleBetaSpectrumTable(const std::string& path)
+    : fZ(0), fQValue(0.0), fMode(Mode::TwoNeutrino), fLepton(Lepton::Electron), fNBins(0),
+      fNCells(0), fBinWidth(0.0), fProbability(nullptr), fAlias(nullptr),
+      fMapping(nullptr), fMappingSize(0) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("DoubleBetaSpectrumTable: cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(CacheHeader)) {
+        ::close(fd);
+        throw std::runtime_error("DoubleBetaSpectrumTable: " + path + " is too short");
+    }
+    fMappingSize = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, fMappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("DoubleBetaSpectrumTable: cannot map " + path);
+    }
+
+    const CacheHeader* header = static_cast<const CacheHeader*>(mapping);
+    const bool twoNeutrino = header->mode == static_cast<std::uint32_t>(Mode::TwoNeutrino);
+    // Bounded so that the cell count neither overflows nor outgrows the
+    // 32-bit aliases
+    const bool binsOk = header->nBins > 0 && header->nBins <= 0xffff;
+    const std::uint64_t expectedCells = twoNeutrino ? header->nBins*header->nBins : header->nBins;
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->version != CACHE_VERSION || !binsOk || header->nCells != expectedCells ||
+        !(header->qValue > 0.0) ||
+        fMappingSize != sizeof(CacheHeader) + header->nCells*(sizeof(double) + sizeof(std::uint32_t))) {
+        ::munmap(mapping, fMappingSize);
+        throw std::runtime_error("DoubleBetaSpectrumTable: " + path + " is not a table file");
+    }
+
+    fMapping = mapping;
+    fZ = header->Z;
+    fQValue = header->qValue;
+    fMode = twoNeutrino ? Mode::TwoNeutrino : Mode::Neutrinoless;
+    fLepton = header->lepton == static_cast<std::uint32_t>(Lepton::Positron) ? Lepton::Positron
+                                                                              : Lepton::Electron;
+    fNBins = static_cast<std::size_t>(header->nBins);
+    fNCells = static_cast<std::size_t>(header->nCells);
+    fBinWidth = fQValue/fNBins;
+
+    const char* data = static_cast<const char*>(mapping) + sizeof(CacheHeader);
+    fProbability = reinterpret_cast<const double*>(data);
+    fAlias = reinterpret_cast<const std::uint32_t*>(data + fNCells*sizeof(double));
+
+    // Sample() indexes with the aliases: a corrupt file must not reach it
+    for (std::size_t i = 0; i < fNCells; ++i) {
+        if (fAlias[i] >= fNCells || !(fProbability[i] >= 0.0 && fProbability[i] <= 1.0)) {
+            ::munmap(mapping, fMappingSize);
+            fMapping = nullptr;
+            throw std::runtime_error("DoubleBetaSpectrumTable: " + path + " has a corrupt alias table");
+        }
+    }
+}
+
+DoubleBetaSpectrumTable::~DoubleBetaSpectrumTable() {
+    if (fMapping) ::munmap(fMapping, fMappingSize);
+}
+
+void DoubleBetaSpectrumTable::BuildCells() {
+    const int chargeZ = (fLepton == Lepton::Positron) ? -fZ : fZ;
+    const double h = fBinWidth;
+    const double q = fQValue;
+
+    // f at the two Gauss nodes, the lower edge and the centre of every bin
+    std::vector<double> gaussLow(fNBins), gaussHigh(fNBins), edge(fNBins), centre(fNBins);
+    for (std::size_t i = 0; i < fNBins; ++i) {
+        gaussLow[i] = BetaSpectrumMath::LeptonFactor((i + GAUSS_LOW)*h, chargeZ);
+        gaussHigh[i] = BetaSpectrumMath::LeptonFactor((i + GAUSS_HIGH)*h, chargeZ);
+        edge[i] = BetaSpectrumMath::LeptonFactor(i*h, chargeZ);
+        centre[i] = BetaSpectrumMath::LeptonFactor((i + 0.5)*h, chargeZ);
+    }
+
+    std::vector<double> weights(fNCells, 0.0);
+    if (fMode == Mode::Neutrinoless) {
+        for (std::size_t i = 0; i < fNBins; ++i) {
+            const double t1 = (i + GAUSS_LOW)*h;
+            const double t2 = (i + GAUSS_HIGH)*h;
+            weights[i] = 0.5*h*(gaussLow[i]*BetaSpectrumMath::LeptonFactor(q - t1, chargeZ) +
+                                gaussHigh[i]*BetaSpectrumMath::LeptonFactor(q - t2, chargeZ));
+        }
+    } else {
+        for (std::size_t i = 0; i < fNBins; ++i) {
+            for (std::size_t j = 0; i + j < fNBins; ++j) {
+                double weight;
+                if (i + j + 1 < fNBins) {
+                    // Full cell: 2 x 2 Gauss-Legendre
+                    const double x[2] = {(i + GAUSS_LOW)*h, (i + GAUSS_HIGH)*h};
+                    const double y[2] = {(j + GAUSS_LOW)*h, (j + GAUSS_HIGH)*h};
+                    const double fx[2] = {gaussLow[i], gaussHigh[i]};
+                    const double fy[2] = {gaussLow[j], gaussHigh[j]};
+                    weight = 0.0;
+                    for (int a = 0; a < 2; ++a) {
+                        for (int b = 0; b < 2; ++b) {
+                            weight += fx[a]*fy[b]*Power5(q - x[a] - y[b]);
+                        }
+                    }
+                    weight *= 0.25*h*h;
+                } else {
+                    // Half cell below the diagonal: edge-midpoint rule (the
+                    // midpoint on the diagonal itself contributes zero)
+                    const double k = 0.5*h;
+                    weight = h*h/6.0*(centre[i]*edge[j] + edge[i]*centre[j])*Power5(k);
+                }
+                weights[i*fNBins + j] = weight;
+            }
+        }
+    }
+
+    BetaSpectrumTable::BuildAliasTable(weights, fOwnedProbability, fOwnedAlias);
+    fProbability = fOwnedProbability.data();
+    fAlias = fOwnedAlias.data();
+}
+
+std::shared_ptr<const DoubleBetaSpectrumTable>
+DoubleBetaSpectrumTable::Get(int Z, double qValue, Mode mode, Lepton lepton) {
+    // Q is keyed at eV resolution so equal configurations share a table
+    const TableKey key(Z, std::llround(qValue*1.0e6), static_cast<int>(mode),
+                       static_cast<int>(lepton));
+
+    std::lock_guard<std::mutex> lock(gTableMutex);
+    auto it = gTableCache.find(key);
+    if (it != gTableCache.end()) return it->second;
+
+    std::shared_ptr<const DoubleBetaSpectrumTable> table;
+    const std::string path = gCacheDirectory.empty()
+        ? std::string() : gCacheDirectory + "/" + CacheFileName(Z, qValue, mode, lepton);
+    if (!path.empty()) {
+        try {
+            table = std::make_shared<const DoubleBetaSpectrumTable>(path);
+            if (table->GetZ() != Z || table->GetMode() != mode || table->GetLepton() != lepton ||
+                std::llround(table->GetQValue()*1.0e6) != std::get<1>(key)) {
+                table.reset();
+            }
+        } catch (const std::runtime_error&) {
+            table.reset();
+        }
+    }
+
+    if (!table) {
+        auto built = std::make_shared<const DoubleBetaSpectrumTable>(Z, qValue, mode, lepton);
+        // The cache only saves time, so a failed write is not an error. The
+        // file appears under its final name only once it is complete.
+        if (!path.empty()) {
+            const std::string partial = path + ".tmp" + std::to_string(::getpid());
+            try {
+                built->Write(partial);
+                if (std::rename(partial.c_str(), path.c_str()) != 0) std::remove(partial.c_str());
+            } catch (const std::runtime_error&) {
+                std::remove(partial.c_str());
+            }
+        }
+        table = built;
+    }
+    gTableCache.emplace(key, table);
+    return table;
+}
+
+void DoubleBetaSpectrumTable::SetCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(gTableMutex);
+    gCacheDirectory = directory;
+}
+
+std::string DoubleBetaSpectrumTable::GetCacheDirectory() {
+    std::lock_guard<std::mutex> lock(gTableMutex);
+    return gCacheDirectory;
+}
+
+std::string DoubleBetaSpectrumTable::CacheFileName(int Z, double qValue, Mode mode, Lepton lepton,
+                                                   std::size_t nBins) {
+    char name[96];
+    std::snprintf(name, sizeof(name), "bb%s_Z%d_Q%lldeV_%s_%zu.bdbbtab",
+                  mode == Mode::TwoNeutrino ? "2nu" : "0nu", Z, std::llround(qValue*1.0e6),
+                  lepton == Lepton::Positron ? "eplus" : "eminus", nBins);
+    return name;
+}
+
+void DoubleBetaSpectrumTable::Write(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::runtime_error("DoubleBetaSpectrumTable: cannot create " + path);
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.mode = static_cast<std::uint32_t>(fMode);
+    header.Z = fZ;
+    header.lepton = static_cast<std::uint32_t>(fLepton);
+    header.nBins = fNBins;
+    header.nCells = fNCells;
+    header.qValue = fQValue;
+
+    const bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                    std::fwrite(fProbability, sizeof(double), fNCells, file) == fNCells &&
+                    std::fwrite(fAlias, sizeof(std::uint32_t), fNCells, file) == fNCells;
+    if (std::fclose(file) != 0 || !ok) {
+        throw std::runtime_error("DoubleBetaSpectrumTable: write error on " + path);
+    }
+}
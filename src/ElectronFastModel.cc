@@ -0,0 +1,86 @@
+// src/ElectronFastModel.cc
+#include "ElectronFastModel.hh"
+#include "DetectorConstruction.hh"
+#include "Run.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Electron.hh"
+#include "G4Gamma.hh"
+#include "G4Material.hh"
+#include "G4Positron.hh"
+#include "G4RandomDirection.hh"
+#include "G4RunManager.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+ElectronFastModel::ElectronFastModel(const G4String& name, G4Region* envelope,
+                                     const DetectorConstruction* detector)
+    : G4VFastSimulationModel(name, envelope), fDetector(detector),
+      fMaterial(nullptr), fMeanZ(0.) {}
+
+ElectronFastModel::~ElectronFastModel() {}
+
+G4bool ElectronFastModel::IsApplicable(const G4ParticleDefinition& particle) {
+    return &particle == G4Electron::Definition() || &particle == G4Positron::Definition();
+}
+
+G4bool ElectronFastModel::ModelTrigger(const G4FastTrack& fastTrack) {
+    const DetectorConstruction::FastSimSettings& settings = fDetector->GetFastSimSettings();
+    if (!settings.enabled) return false;
+    
+    // The region also holds the air of the envelope and the replica cells
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    return track->GetKineticEnergy() < settings.threshold &&
+           track->GetVolume()->GetLogicalVolume() == fDetector->GetDetectorVolume();
+}
+
+void ElectronFastModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) {
+    const DetectorConstruction::FastSimSettings& settings = fDetector->GetFastSimSettings();
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const G4double energy = track->GetKineticEnergy();
+    const G4bool annihilate = settings.annihilation &&
+                              track->GetDefinition() == G4Positron::Definition();
+    
+    G4double radiated = 0.;
+    if (settings.leakage) radiated = energy*RadiativeYield(energy, GetMeanZ(track->GetMaterial()));
+    
+    fastStep.KillPrimaryTrack();
+    fastStep.ProposePrimaryTrackPathLength(0.);
+    fastStep.ProposeTotalEnergyDeposited(energy - radiated);
+    fastStep.SetNumberOfSecondaryTracks((radiated > 0. ? 1 : 0) + (annihilate ? 2 : 0));
+    
+    // Secondaries in global coordinates
+    const G4ThreeVector& position = track->GetPosition();
+    const G4double time = track->GetGlobalTime();
+    if (radiated > 0.) {
+        fastStep.CreateSecondaryTrack(
+            G4DynamicParticle(G4Gamma::Definition(), track->GetMomentumDirection(), radiated),
+            position, time, false);
+    }
+    if (annihilate) {
+        const G4ThreeVector direction = G4RandomDirection();
+        fastStep.CreateSecondaryTrack(
+            G4DynamicParticle(G4Gamma::Definition(), direction, electron_mass_c2), position, time, false);
+        fastStep.CreateSecondaryTrack(
+            G4DynamicParticle(G4Gamma::Definition(), -direction, electron_mass_c2), position, time, false);
+    }
+    
+    // Counted on this thread's run
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    if (Run* run = static_cast<Run*>(runManager->GetNonConstCurrentRun())) {
+        run->AddFastSimTrack(energy - radiated);
+    }
+}
+
+G4double ElectronFastModel::RadiativeYield(G4double energy, G4double z) {
+    const G4double x = 6.0e-4*z*energy/MeV;
+    return x/(1. + x);
+}
+
+G4double ElectronFastModel::GetMeanZ(const G4Material* material) {
+    // Electrons per atom; cached because the crystals share one material
+    if (material != fMaterial) {
+        fMaterial = material;
+        fMeanZ = material->GetElectronDensity()/material->GetTotNbOfAtomsPerVolume();
+    }
+    return fMeanZ;
+}
@@ -1,30 +1,78 @@
 // src/EventAction.cc
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "BetaDecay.hh"
+#include "PhaseProfile.hh"
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Gamma.hh"
 #include "G4SystemOfUnits.hh"
 #include <iostream>
 
-EventAction::EventAction(RunAction* runAction)
-    : G4UserEventAction(), fRunAction(runAction),
+EventAction::EventAction(RunAction* runAction, const BetaDecayPrimaryGenerator* generator)
+    : G4UserEventAction(), fRunAction(runAction), fGenerator(generator),
       fEventID(0), fTotalEnergy(0.0), 
-      fNumElectrons(0), fDecayType(1) {}
+      fNumElectrons(0), fDecayType(1) {
+    fElectron = G4Electron::Definition();
+    fPositron = G4Positron::Definition();
+    fGamma = G4Gamma::Definition();
+    fDeposits.Clear();
+}
 
 EventAction::~EventAction() {}
 
 void EventAction::BeginOfEventAction(const G4Event* event) {
-    fEventID = event->GetEventID();
+    fEventID = fGenerator->GetGlobalEventId(event->GetEventID());
     fTotalEnergy = 0.0;
     fNumElectrons = 0;
     fDecayType = 1;  // Default to single beta
+    fDeposits.Clear();
     
-    // Print progress every 100 events
-    if (fEventID % 100 == 0) {
-        G4cout << "Processing event " << fEventID << "..." << G4endl;
-    }
+    if (PhaseProfile* profile = PhaseProfile::GetActive()) profile->BeginTracking();
 }
 
 void EventAction::EndOfEventAction(const G4Event* event) {
+    PhaseProfile* profile = PhaseProfile::GetActive();
+    if (profile) profile->EndTracking();
+    {
+        PhaseProfile::Scope timer(PhaseProfile::END_OF_EVENT);
+        ProcessEvent(event);
+        fRunAction->EndOfEvent(fEventID);
+    }
+    if (profile) profile->EndEvent();
+}
+
+void EventAction::ProcessEvent(const G4Event* event) {
+    // The primaries are the decay products of this event; the event weight
+    // is the product of the vertex weights (biased emission)
+    G4double weight = 1.0;
+    fLeptonEnergies.clear();
+    for (G4int iv = 0; iv < event->GetNumberOfPrimaryVertex(); ++iv) {
+        const G4PrimaryVertex* vertex = event->GetPrimaryVertex(iv);
+        weight *= vertex->GetWeight();
+        for (G4int ip = 0; ip < vertex->GetNumberOfParticle(); ++ip) {
+            const G4PrimaryParticle* primary = vertex->GetPrimary(ip);
+            AddTrack(primary->GetParticleDefinition(), primary->GetKineticEnergy());
+            if (primary->GetParticleDefinition() == fElectron ||
+                primary->GetParticleDefinition() == fPositron) {
+                fLeptonEnergies.push_back(primary->GetKineticEnergy());
+            }
+        }
+    }
+    
+    // Everything handed to RunAction counts as output
+    PhaseProfile::Scope timer(PhaseProfile::OUTPUT);
+    fRunAction->AddDeposits(fDeposits, weight);
+    for (G4int crystal : fHitCrystals) {
+        fRunAction->AddCrystalDeposit(crystal, weight*fCrystalEnergy[crystal]);
+        fCrystalEnergy[crystal] = 0.;
+    }
+    fHitCrystals.clear();
+    
     // Send data to RunAction for file output
     if (fNumElectrons > 0) {
         // Simple heuristic: >1 electron might be double beta
@@ -33,15 +81,26 @@ void EventAction::EndOfEventAction(const G4Event* event) {
         }
         
         fRunAction->AddEventData(fTotalEnergy, "e-", fDecayType);
+        
+        // One output line per primary particle
+        for (G4int iv = 0; iv < event->GetNumberOfPrimaryVertex(); ++iv) {
+            const G4PrimaryVertex* vertex = event->GetPrimaryVertex(iv);
+            for (G4int ip = 0; ip < vertex->GetNumberOfParticle(); ++ip) {
+                const G4PrimaryParticle* primary = vertex->GetPrimary(ip);
+                fRunAction->AddParticleData(fEventID, primary->GetPDGcode(),
+                                            primary->GetKineticEnergy(), fDecayType,
+                                            vertex->GetPosition(), vertex->GetWeight());
+            }
+        }
     }
+    fRunAction->FillHistograms(fDeposits, fDecayType, fLeptonEnergies, weight);
 }
 
-void EventAction::AddTrack(G4double energy, G4String particleName,
-                          G4double x, G4double y, G4double z,
+void EventAction::AddTrack(const G4ParticleDefinition* particle, G4double energy,
                           G4int decayType) {
     fTotalEnergy += energy;
     
-    if (particleName == "e-") {
+    if (particle == fElectron || particle == fPositron) {
         fNumElectrons++;
     }
     
@@ -0,0 +1,63 @@
+// src/EventFileFormat.cc
+#include "EventFileFormat.hh"
+
+#include <cstdio>
+
+namespace EventFile {
+
+const ColumnDescriptor COLUMNS[N_COLUMNS] = {
+    {COLUMN_EVENT_ID,   std::uint8_t(ColumnType::Int64),   8, 0, "event"},
+    {COLUMN_DECAY_TYPE, std::uint8_t(ColumnType::UInt8),   1, 0, "decay"},
+    {COLUMN_PARTICLE,   std::uint8_t(ColumnType::Int32),   4, 0, "pdg"},
+    {COLUMN_ENERGY,     std::uint8_t(ColumnType::Float64), 8, 0, "energy"},
+    {COLUMN_X,          std::uint8_t(ColumnType::Float32), 4, 0, "x"},
+    {COLUMN_Y,          std::uint8_t(ColumnType::Float32), 4, 0, "y"},
+    {COLUMN_Z,          std::uint8_t(ColumnType::Float32), 4, 0, "z"},
+    {COLUMN_WEIGHT,     std::uint8_t(ColumnType::Float64), 8, 0, "weight"},
+};
+
+const char* ParticleName(std::int32_t pdgCode, char* scratch, std::size_t size) {
+    switch (pdgCode) {
+        case 11:   return "e-";
+        case -11:  return "e+";
+        case 22:   return "gamma";
+        case 12:   return "nu_e";
+        case -12:  return "anti_nu_e";
+        case 2212: return "proton";
+        case 2112: return "neutron";
+        default:   break;
+    }
+    std::snprintf(scratch, size, "pdg:%d", pdgCode);
+    return scratch;
+}
+
+void WriteTextHeader(std::ostream& out) {
+    out << "# Beta Decay Simulation Output\n";
+    out << "# Event | Particle | Energy (MeV) | DecayType | X | Y | Z (mm) | Weight\n";
+    out << "# DecayType: 1=SingleBeta, 2=DoubleBeta\n";
+    out << "########################################\n";
+}
+
+std::size_t FormatTextLine(const EventRecord& record, char* line, std::size_t size) {
+    char scratch[24];
+    const int length = std::snprintf(line, size, "%lld %s %.6f %d %.4f %.4f %.4f %.6g\n",
+                                     static_cast<long long>(record.eventId),
+                                     ParticleName(record.particle, scratch, sizeof(scratch)),
+                                     record.energy, int(record.decayType),
+                                     record.x, record.y, record.z, record.weight);
+    if (length < 0) return 0;
+    return static_cast<std::size_t>(length) < size ? length : size - 1;
+}
+
+void WriteTextSummary(std::ostream& out, const TextSummary& summary) {
+    out << "########################################\n";
+    out << "# SUMMARY\n";
+    out << "# Total events: " << summary.totalEvents << "\n";
+    out << "# Single beta decays: " << summary.singleBetaCount << "\n";
+    out << "# Double beta decays: " << summary.doubleBetaCount << "\n";
+    if (summary.totalEvents > 0) {
+        out << "# Average energy: " << summary.totalEnergy/summary.totalEvents << " MeV\n";
+    }
+}
+
+} // namespace EventFile
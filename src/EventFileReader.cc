@@ -0,0 +1,192 @@
+// src/EventFileReader.cc
+#include "EventFileReader.hh"
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace EventFile {
+
+EventRecord ChunkView::GetRecord(std::uint32_t row) const {
+    EventRecord record;
+    record.eventId = eventId ? eventId[row] : 0;
+    record.decayType = decayType ? decayType[row] : 0;
+    record.particle = particle ? particle[row] : 0;
+    record.energy = energy ? energy[row] : 0.0;
+    record.x = x ? x[row] : 0.0f;
+    record.y = y ? y[row] : 0.0f;
+    record.z = z ? z[row] : 0.0f;
+    record.weight = weight ? weight[row] : 1.0;
+    return record;
+}
+
+EventFileReader::EventFileReader(const std::string& path)
+    : fData(nullptr), fSize(0), fHeader(nullptr), fColumns(nullptr),
+      fIndex(nullptr), fTrailer(nullptr) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("EventFileReader: cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("EventFileReader: cannot stat " + path);
+    }
+    fSize = static_cast<std::size_t>(info.st_size);
+    if (fSize < sizeof(FileHeader) + sizeof(FileTrailer)) {
+        ::close(fd);
+        throw std::runtime_error("EventFileReader: " + path + " is too short");
+    }
+    
+    void* mapping = ::mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("EventFileReader: cannot map " + path);
+    }
+    ::madvise(mapping, fSize, MADV_SEQUENTIAL);
+    fData = static_cast<const char*>(mapping);
+    
+    fHeader = reinterpret_cast<const FileHeader*>(fData);
+    fTrailer = reinterpret_cast<const FileTrailer*>(fData + fSize - sizeof(FileTrailer));
+    try {
+        Validate(path);
+    } catch (...) {
+        ::munmap(mapping, fSize);
+        fData = nullptr;
+        throw;
+    }
+}
+
+void EventFileReader::Validate(const std::string& path) {
+    const auto fail = [&path](const std::string& what) {
+        throw std::runtime_error("EventFileReader: " + path + " " + what);
+    };
+    
+    // Sections: header and column directory, chunks, index, trailer. The
+    // sizes are bounded before they are multiplied, so nothing overflows.
+    const std::uint64_t indexEnd = fSize - sizeof(FileTrailer);
+    if (std::memcmp(fHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        std::memcmp(fTrailer->magic, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0 ||
+        fTrailer->indexOffset > indexEnd || fTrailer->indexOffset % 8 != 0 ||
+        fTrailer->nChunks > (indexEnd - fTrailer->indexOffset)/sizeof(IndexEntry) ||
+        fTrailer->indexOffset + fTrailer->nChunks*sizeof(IndexEntry) != indexEnd) {
+        fail("is not a complete event file");
+    }
+    const std::uint64_t chunksBegin =
+        Align8(sizeof(FileHeader) + std::size_t(fHeader->nColumns)*sizeof(ColumnDescriptor));
+    if (chunksBegin > fTrailer->indexOffset) fail("has a malformed column directory");
+    fColumns = reinterpret_cast<const ColumnDescriptor*>(fData + sizeof(FileHeader));
+    fIndex = reinterpret_cast<const IndexEntry*>(fData + fTrailer->indexOffset);
+    
+    // Known columns are read as their type, so their width must match it
+    std::uint64_t rowBytes = 0;
+    for (std::uint16_t i = 0; i < fHeader->nColumns; ++i) {
+        const ColumnDescriptor& column = fColumns[i];
+        for (const ColumnDescriptor& known : COLUMNS) {
+            if (column.id == known.id && column.width != known.width) fail("has a malformed column directory");
+        }
+        if (column.width == 0) fail("has a malformed column directory");
+        rowBytes += column.width;
+    }
+    
+    std::uint64_t rows = 0;
+    for (std::uint64_t c = 0; c < fTrailer->nChunks; ++c) {
+        const IndexEntry& entry = fIndex[c];
+        // The unpadded size first, which bounds the padded sum below
+        if (entry.offset < chunksBegin || entry.offset % 8 != 0 ||
+            entry.offset > fTrailer->indexOffset - sizeof(ChunkHeader) ||
+            std::uint64_t(entry.nRows)*rowBytes > fTrailer->indexOffset - sizeof(ChunkHeader) - entry.offset) {
+            fail("has chunk " + std::to_string(c) + " outside the file");
+        }
+        std::uint64_t end = entry.offset + sizeof(ChunkHeader);
+        for (std::uint16_t i = 0; i < fHeader->nColumns; ++i) {
+            end += Align8(std::size_t(entry.nRows)*fColumns[i].width);
+        }
+        const ChunkHeader* header = reinterpret_cast<const ChunkHeader*>(fData + entry.offset);
+        if (end > fTrailer->indexOffset || std::memcmp(header->magic, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0 ||
+            header->nRows != entry.nRows) {
+            fail("has chunk " + std::to_string(c) + " outside the file");
+        }
+        rows += entry.nRows;
+    }
+    if (rows != fTrailer->nRows) fail("has an index that disagrees with its trailer");
+}
+
+EventFileReader::~EventFileReader() {
+    if (fData) ::munmap(const_cast<char*>(fData), fSize);
+}
+
+ChunkView EventFileReader::GetChunk(std::uint64_t chunk) const {
+    const IndexEntry& entry = fIndex[chunk];
+    ChunkView view;
+    view.nRows = entry.nRows;
+    view.firstEventId = entry.firstEventId;
+    view.lastEventId = entry.lastEventId;
+    
+    // Column blocks follow the chunk header in directory order
+    const char* block = fData + entry.offset + sizeof(ChunkHeader);
+    for (std::uint16_t i = 0; i < fHeader->nColumns; ++i) {
+        const ColumnDescriptor& column = fColumns[i];
+        switch (column.id) {
+            case COLUMN_EVENT_ID:   view.eventId = reinterpret_cast<const std::int64_t*>(block); break;
+            case COLUMN_DECAY_TYPE: view.decayType = reinterpret_cast<const std::uint8_t*>(block); break;
+            case COLUMN_PARTICLE:   view.particle = reinterpret_cast<const std::int32_t*>(block); break;
+            case COLUMN_ENERGY:     view.energy = reinterpret_cast<const double*>(block); break;
+            case COLUMN_X:          view.x = reinterpret_cast<const float*>(block); break;
+            case COLUMN_Y:          view.y = reinterpret_cast<const float*>(block); break;
+            case COLUMN_Z:          view.z = reinterpret_cast<const float*>(block); break;
+            case COLUMN_WEIGHT:     view.weight = reinterpret_cast<const double*>(block); break;
+            default: break;
+        }
+        block += Align8(std::size_t(entry.nRows)*column.width);
+    }
+    return view;
+}
+
+TextSummary EventFileReader::Summarize() const {
+    // Files are not sorted by event id (threads write independently), so
+    // distinct ids are tracked explicitly
+    std::unordered_map<std::int64_t, std::uint8_t> events;
+    TextSummary summary;
+    for (std::uint64_t c = 0; c < GetNumberOfChunks(); ++c) {
+        const ChunkView view = GetChunk(c);
+        for (std::uint32_t i = 0; i < view.nRows; ++i) {
+            const EventRecord record = view.GetRecord(i);
+            events.emplace(record.eventId, record.decayType);
+            summary.totalEnergy += record.energy;
+        }
+    }
+    summary.totalEvents = static_cast<std::int64_t>(events.size());
+    for (const auto& event : events) {
+        if (event.second == 1) summary.singleBetaCount++;
+        else if (event.second == 2) summary.doubleBetaCount++;
+    }
+    return summary;
+}
+
+void EventFileReader::WriteText(std::ostream& out) const {
+    WriteTextHeader(out);
+    
+    std::vector<char> buffer;
+    buffer.reserve(1 << 20);
+    char line[160];
+    for (std::uint64_t c = 0; c < GetNumberOfChunks(); ++c) {
+        const ChunkView view = GetChunk(c);
+        for (std::uint32_t i = 0; i < view.nRows; ++i) {
+            const std::size_t length = FormatTextLine(view.GetRecord(i), line, sizeof(line));
+            buffer.insert(buffer.end(), line, line + length);
+        }
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    
+    WriteTextSummary(out, Summarize());
+}
+
+} // namespace EventFile
@@ -0,0 +1,164 @@
+// src/EventFileWriter.cc
+#include "EventFileWriter.hh"
+#include "EventFileReader.hh"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace EventFile {
+
+namespace {
+    template <typename T, typename Get>
+    char* FillColumn(char* out, const EventRecord* rows, std::uint32_t nRows, Get get) {
+        for (std::uint32_t i = 0; i < nRows; ++i) {
+            const T value = get(rows[i]);
+            std::memcpy(out + i*sizeof(T), &value, sizeof(T));
+        }
+        return out + Align8(std::size_t(nRows)*sizeof(T));
+    }
+}
+
+std::shared_ptr<const EncodedChunk> EncodeChunk(const EventRecord* rows, std::uint32_t nRows) {
+    auto chunk = std::make_shared<EncodedChunk>();
+    chunk->nRows = nRows;
+    chunk->firstEventId = nRows ? rows[0].eventId : 0;
+    chunk->lastEventId = nRows ? rows[nRows - 1].eventId : 0;
+    
+    std::size_t size = sizeof(ChunkHeader);
+    for (const ColumnDescriptor& column : COLUMNS) {
+        size += Align8(std::size_t(nRows)*column.width);
+    }
+    chunk->bytes.assign(size, 0);
+    
+    ChunkHeader header;
+    std::memcpy(header.magic, CHUNK_MAGIC, sizeof(header.magic));
+    header.nRows = nRows;
+    header.firstEventId = chunk->firstEventId;
+    header.lastEventId = chunk->lastEventId;
+    std::memcpy(chunk->bytes.data(), &header, sizeof(header));
+    
+    char* out = chunk->bytes.data() + sizeof(ChunkHeader);
+    out = FillColumn<std::int64_t>(out, rows, nRows, [](const EventRecord& r) { return r.eventId; });
+    out = FillColumn<std::uint8_t>(out, rows, nRows, [](const EventRecord& r) { return r.decayType; });
+    out = FillColumn<std::int32_t>(out, rows, nRows, [](const EventRecord& r) { return r.particle; });
+    out = FillColumn<double>(out, rows, nRows, [](const EventRecord& r) { return r.energy; });
+    out = FillColumn<float>(out, rows, nRows, [](const EventRecord& r) { return r.x; });
+    out = FillColumn<float>(out, rows, nRows, [](const EventRecord& r) { return r.y; });
+    out = FillColumn<float>(out, rows, nRows, [](const EventRecord& r) { return r.z; });
+    FillColumn<double>(out, rows, nRows, [](const EventRecord& r) { return r.weight; });
+    return chunk;
+}
+
+//==============================================================================
+// EventFileWriter
+//==============================================================================
+
+EventFileWriter::EventFileWriter(const std::string& path, std::uint32_t chunkRows, bool append)
+    : fFile(nullptr), fPath(path), fChunkRows(chunkRows ? chunkRows : DEFAULT_CHUNK_ROWS),
+      fOffset(0), fRows(0) {
+    if (append) {
+        // New chunks go where the index starts
+        {
+            const EventFileReader reader(path);
+            for (std::uint64_t c = 0; c < reader.GetNumberOfChunks(); ++c) {
+                fIndex.push_back(reader.GetIndexEntry(c));
+                fRows += fIndex.back().nRows;
+            }
+            fOffset = reader.GetFileSize() - sizeof(FileTrailer) - fIndex.size()*sizeof(IndexEntry);
+        }
+        fFile = std::fopen(path.c_str(), "r+b");
+        if (!fFile || std::fseek(fFile, static_cast<long>(fOffset), SEEK_SET) != 0) {
+            if (fFile) std::fclose(fFile);
+            fFile = nullptr;
+            throw std::runtime_error("EventFileWriter: cannot append to " + path);
+        }
+        return;
+    }
+    
+    fFile = std::fopen(path.c_str(), "wb");
+    if (!fFile) {
+        throw std::runtime_error("EventFileWriter: cannot open " + path);
+    }
+    
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.nColumns = static_cast<std::uint16_t>(N_COLUMNS);
+    header.headerSize = static_cast<std::uint16_t>(sizeof(FileHeader) + sizeof(COLUMNS));
+    header.chunkRows = fChunkRows;
+    header.flags = 0;
+    Write(&header, sizeof(header));
+    Write(COLUMNS, sizeof(COLUMNS));
+}
+
+EventFileWriter::~EventFileWriter() {
+    if (fFile) {
+        try {
+            Close();
+        } catch (const std::exception&) {
+            // Destructors must not throw; the file is left without an index
+        }
+    }
+}
+
+void EventFileWriter::Write(const void* data, std::size_t size) {
+    if (std::fwrite(data, 1, size, fFile) != size) {
+        throw std::runtime_error("EventFileWriter: write failed on " + fPath);
+    }
+    fOffset += size;
+}
+
+void EventFileWriter::WriteChunk(const EncodedChunk& chunk) {
+    if (chunk.nRows == 0) return;
+    
+    IndexEntry entry;
+    entry.offset = fOffset;
+    entry.nRows = chunk.nRows;
+    entry.reserved = 0;
+    entry.firstEventId = chunk.firstEventId;
+    entry.lastEventId = chunk.lastEventId;
+    
+    Write(chunk.bytes.data(), chunk.bytes.size());
+    fIndex.push_back(entry);
+    fRows += chunk.nRows;
+}
+
+void EventFileWriter::Flush() {
+    if (std::fflush(fFile) != 0) {
+        throw std::runtime_error("EventFileWriter: write failed on " + fPath);
+    }
+}
+
+void EventFileWriter::Append(const EventRecord& record) {
+    fPending.push_back(record);
+    if (fPending.size() >= fChunkRows) FlushPending();
+}
+
+void EventFileWriter::FlushPending() {
+    if (fPending.empty()) return;
+    WriteChunk(*EncodeChunk(fPending.data(), static_cast<std::uint32_t>(fPending.size())));
+    fPending.clear();
+}
+
+void EventFileWriter::Close() {
+    if (!fFile) return;
+    
+    FlushPending();
+    
+    FileTrailer trailer;
+    trailer.indexOffset = fOffset;
+    trailer.nChunks = fIndex.size();
+    trailer.nRows = fRows;
+    std::memcpy(trailer.magic, TRAILER_MAGIC, sizeof(trailer.magic));
+    
+    if (!fIndex.empty()) Write(fIndex.data(), fIndex.size()*sizeof(IndexEntry));
+    Write(&trailer, sizeof(trailer));
+    
+    std::FILE* file = fFile;
+    fFile = nullptr;
+    if (std::fclose(file) != 0) {
+        throw std::runtime_error("EventFileWriter: close failed on " + fPath);
+    }
+}
+
+} // namespace EventFile
@@ -0,0 +1,231 @@
+// src/Histogram.cc
+#include "Histogram.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    std::size_t NumberOfCells(const Histogram::Axis& x, const Histogram::Axis& y) {
+        return (x.nBins + 2)*(y.nBins > 0 ? y.nBins + 2 : 1);
+    }
+    
+    double InverseWidth(const Histogram::Axis& axis) {
+        return axis.nBins > 0 && axis.high > axis.low ? axis.nBins/(axis.high - axis.low) : 0.0;
+    }
+    
+    bool SameAxis(const Histogram::Axis& a, const Histogram::Axis& b) {
+        return a.nBins == b.nBins && a.low == b.low && a.high == b.high;
+    }
+    
+    void CopyName(char* field, std::size_t size, const std::string& text) {
+        std::memset(field, 0, size);
+        std::memcpy(field, text.data(), std::min(text.size(), size - 1));
+    }
+    
+    struct FileCloser {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+    using File = std::unique_ptr<std::FILE, FileCloser>;
+}
+
+//==============================================================================
+// Histogram
+//==============================================================================
+
+Histogram::Histogram(const std::string& name, const std::string& title, const Axis& x,
+                     const Axis& y)
+    : fName(name), fTitle(title), fX(x), fY(y),
+      fInvWidthX(InverseWidth(x)), fInvWidthY(InverseWidth(y)), fEntries(0),
+      fSumW(NumberOfCells(x, y), 0.0), fSumW2(NumberOfCells(x, y), 0.0) {
+    if (x.nBins == 0 || !(x.high > x.low) || (y.nBins > 0 && !(y.high > y.low))) {
+        throw std::invalid_argument("Histogram " + name + ": empty axis");
+    }
+}
+
+bool Histogram::IsCompatible(const Histogram& other) const {
+    return SameAxis(fX, other.fX) && SameAxis(fY, other.fY);
+}
+
+bool Histogram::Merge(const Histogram& other) {
+    if (!IsCompatible(other)) return false;
+    for (std::size_t cell = 0; cell < fSumW.size(); ++cell) {
+        fSumW[cell] += other.fSumW[cell];
+        fSumW2[cell] += other.fSumW2[cell];
+    }
+    fEntries += other.fEntries;
+    return true;
+}
+
+void Histogram::Reset() {
+    std::fill(fSumW.begin(), fSumW.end(), 0.0);
+    std::fill(fSumW2.begin(), fSumW2.end(), 0.0);
+    fEntries = 0;
+}
+
+bool Histogram::SetContents(std::uint64_t entries, const std::vector<double>& sumW,
+                            const std::vector<double>& sumW2) {
+    if (sumW.size() != fSumW.size() || sumW2.size() != fSumW2.size()) return false;
+    fEntries = entries;
+    fSumW = sumW;
+    fSumW2 = sumW2;
+    return true;
+}
+
+double Histogram::GetIntegral() const {
+    double sum = 0.0;
+    const std::uint32_t ny = Is2D() ? fY.nBins : 1;
+    for (std::uint32_t iy = 0; iy < ny; ++iy) {
+        for (std::uint32_t ix = 0; ix < fX.nBins; ++ix) sum += fSumW[GetCell(ix, iy)];
+    }
+    return sum;
+}
+
+void Histogram::WriteText(std::ostream& out) const {
+    out << "# " << fName << ": " << fTitle << "\n";
+    out << "# entries " << fEntries << ", integral " << GetIntegral() << "\n";
+    out << (Is2D() ? "# x y sumW error\n" : "# x sumW error\n");
+    
+    const double widthX = (fX.high - fX.low)/fX.nBins;
+    const double widthY = Is2D() ? (fY.high - fY.low)/fY.nBins : 0.0;
+    const std::uint32_t ny = Is2D() ? fY.nBins : 1;
+    char line[128];
+    for (std::uint32_t iy = 0; iy < ny; ++iy) {
+        for (std::uint32_t ix = 0; ix < fX.nBins; ++ix) {
+            const std::size_t cell = GetCell(ix, iy);
+            const double x = fX.low + (ix + 0.5)*widthX;
+            if (Is2D()) {
+                std::snprintf(line, sizeof(line), "%g %g %g %g\n", x, fY.low + (iy + 0.5)*widthY,
+                              fSumW[cell], std::sqrt(fSumW2[cell]));
+            } else {
+                std::snprintf(line, sizeof(line), "%g %g %g\n", x, fSumW[cell], std::sqrt(fSumW2[cell]));
+            }
+            out << line;
+        }
+        if (Is2D()) out << "\n";
+    }
+}
+
+//==============================================================================
+// HistogramSet
+//==============================================================================
+
+std::size_t HistogramSet::Book(const std::string& name, const std::string& title,
+                               const Histogram::Axis& x, const Histogram::Axis& y) {
+    fHistograms.emplace_back(name, title, x, y);
+    return fHistograms.size() - 1;
+}
+
+const Histogram* HistogramSet::Find(const std::string& name) const {
+    for (const Histogram& histogram : fHistograms) {
+        if (histogram.GetName() == name) return &histogram;
+    }
+    return nullptr;
+}
+
+bool HistogramSet::Merge(const HistogramSet& other) {
+    bool complete = true;
+    for (std::size_t i = 0; i < other.fHistograms.size(); ++i) {
+        const Histogram& source = other.fHistograms[i];
+    
+        // Sets booked by the same code have the same order
+        Histogram* target = nullptr;
+        if (i < fHistograms.size() && fHistograms[i].GetName() == source.GetName()) {
+            target = &fHistograms[i];
+        } else {
+            for (Histogram& histogram : fHistograms) {
+                if (histogram.GetName() == source.GetName()) target = &histogram;
+            }
+        }
+        if (!target || !target->Merge(source)) complete = false;
+    }
+    return complete;
+}
+
+void HistogramSet::Reset() {
+    for (Histogram& histogram : fHistograms) histogram.Reset();
+}
+
+//==============================================================================
+// HistogramFile
+//==============================================================================
+
+namespace HistogramFile {
+
+void Write(const std::string& path, const HistogramSet& histograms) {
+    File file(std::fopen(path.c_str(), "wb"));
+    if (!file) throw std::runtime_error("HistogramFile: cannot create " + path);
+    
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.nHistograms = static_cast<std::uint32_t>(histograms.Size());
+    bool ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+    
+    for (std::size_t i = 0; ok && i < histograms.Size(); ++i) {
+        const Histogram& histogram = histograms[i];
+        HistogramHeader entry;
+        CopyName(entry.name, sizeof(entry.name), histogram.GetName());
+        CopyName(entry.title, sizeof(entry.title), histogram.GetTitle());
+        entry.nx = histogram.GetXAxis().nBins;
+        entry.ny = histogram.GetYAxis().nBins;
+        entry.xLow = histogram.GetXAxis().low;
+        entry.xHigh = histogram.GetXAxis().high;
+        entry.yLow = histogram.GetYAxis().low;
+        entry.yHigh = histogram.GetYAxis().high;
+        entry.entries = histogram.GetEntries();
+    
+        const std::size_t nCells = histogram.GetNumberOfCells();
+        ok = std::fwrite(&entry, sizeof(entry), 1, file.get()) == 1 &&
+             std::fwrite(histogram.GetSumW().data(), sizeof(double), nCells, file.get()) == nCells &&
+             std::fwrite(histogram.GetSumW2().data(), sizeof(double), nCells, file.get()) == nCells;
+    }
+    
+    if (!ok || std::fflush(file.get()) != 0) {
+        throw std::runtime_error("HistogramFile: write error on " + path);
+    }
+}
+
+HistogramSet Read(const std::string& path) {
+    File file(std::fopen(path.c_str(), "rb"));
+    if (!file) throw std::runtime_error("HistogramFile: cannot open " + path);
+    
+    FileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 ||
+        std::memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("HistogramFile: " + path + " is not a histogram file");
+    }
+    if (header.version > VERSION) {
+        throw std::runtime_error("HistogramFile: " + path + " has a newer format version");
+    }
+    
+    HistogramSet histograms;
+    std::vector<double> sumW;
+    std::vector<double> sumW2;
+    for (std::uint32_t i = 0; i < header.nHistograms; ++i) {
+        HistogramHeader entry;
+        if (std::fread(&entry, sizeof(entry), 1, file.get()) != 1) {
+            throw std::runtime_error("HistogramFile: " + path + " is truncated");
+        }
+        entry.name[sizeof(entry.name) - 1] = '\0';
+        entry.title[sizeof(entry.title) - 1] = '\0';
+    
+        const std::size_t index = histograms.Book(entry.name, entry.title,
+                                                  Histogram::Axis(entry.nx, entry.xLow, entry.xHigh),
+                                                  Histogram::Axis(entry.ny, entry.yLow, entry.yHigh));
+        const std::size_t nCells = histograms[index].GetNumberOfCells();
+        sumW.resize(nCells);
+        sumW2.resize(nCells);
+        if (std::fread(sumW.data(), sizeof(double), nCells, file.get()) != nCells ||
+            std::fread(sumW2.data(), sizeof(double), nCells, file.get()) != nCells) {
+            throw std::runtime_error("HistogramFile: " + path + " is truncated");
+        }
+        histograms[index].SetContents(entry.entries, sumW, sumW2);
+    }
+    return histograms;
+}
+
+} // namespace HistogramFile
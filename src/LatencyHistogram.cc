@@ -0,0 +1,40 @@
+// src/LatencyHistogram.cc
+#include "LatencyHistogram.hh"
+
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::Reset() {
+    fCounts.fill(0);
+    fCount = 0;
+    fSum = 0;
+    fMin = MAX_VALUE;
+    fMax = 0;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (int i = 0; i < N_BUCKETS; ++i) fCounts[i] += other.fCounts[i];
+    fCount += other.fCount;
+    fSum += other.fSum;
+    fMin = std::min(fMin, other.fMin);
+    fMax = std::max(fMax, other.fMax);
+}
+
+std::uint64_t LatencyHistogram::GetQuantile(double quantile) const {
+    if (fCount == 0) return 0;
+    const double clamped = std::min(1.0, std::max(0.0, quantile));
+    const std::uint64_t rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(clamped*fCount)));
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < N_BUCKETS; ++i) {
+        seen += fCounts[i];
+        if (seen >= rank) {
+            // Middle of the bucket, but never outside the recorded range
+            const std::uint64_t lowest = BucketLowest(i);
+            const std::uint64_t width = i + 1 < N_BUCKETS ? BucketLowest(i + 1) - lowest : 1;
+            return std::min(fMax, std::max(fMin, lowest + width/2));
+        }
+    }
+    return fMax;
+}
@@ -0,0 +1,190 @@
+// src/OutputMerge.cc
+#include "OutputMerge.hh"
+#include "EventFileReader.hh"
+#include "EventFileWriter.hh"
+#include "Histogram.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace OutputMerge {
+
+namespace {
+    bool Exists(const std::string& path) {
+        std::ifstream file(path);
+        return file.good();
+    }
+    
+    bool AllExist(const std::vector<std::string>& inputs, const char* extension) {
+        for (const std::string& input : inputs) {
+            if (!Exists(input + extension)) return false;
+        }
+        return !inputs.empty();
+    }
+    
+    std::vector<std::string> WithExtension(const std::vector<std::string>& names, const char* extension) {
+        std::vector<std::string> paths;
+        for (const std::string& name : names) paths.push_back(name + extension);
+        return paths;
+    }
+    
+    // A chunk of one input with its rows in event id order. Threads write
+    // whole buffers, so a chunk is not sorted on its own; the stable sort
+    // keeps the particles of an event in the order they were recorded.
+    struct SortedChunk {
+        std::size_t input = 0;
+        std::uint64_t chunk = 0;
+        std::int64_t minEventId = 0;
+        EventFile::ChunkView view;
+        std::vector<std::uint32_t> rows;     // Filled when the merge reaches the chunk
+        std::size_t next = 0;
+    
+        std::int64_t EventId(std::uint32_t row) const { return view.eventId ? view.eventId[row] : 0; }
+        std::int64_t Head() const { return EventId(rows[next]); }
+    
+        void Sort() {
+            rows.resize(view.nRows);
+            for (std::uint32_t row = 0; row < view.nRows; ++row) rows[row] = row;
+            std::stable_sort(rows.begin(), rows.end(),
+                             [this](std::uint32_t a, std::uint32_t b) { return EventId(a) < EventId(b); });
+        }
+    };
+    
+    // Records of equal event id keep the order of the inputs and of their
+    // chunks
+    bool Before(std::int64_t idA, const SortedChunk& a, std::int64_t idB, const SortedChunk& b) {
+        if (idA != idB) return idA < idB;
+        if (a.input != b.input) return a.input < b.input;
+        return a.chunk < b.chunk;
+    }
+}
+
+std::uint64_t MergeEventFiles(const std::vector<std::string>& inputs, const std::string& output) {
+    std::vector<std::unique_ptr<EventFile::EventFileReader>> readers;
+    for (const std::string& input : inputs) {
+        readers.emplace_back(new EventFile::EventFileReader(input));
+    }
+    
+    // A k-way merge over the sorted chunks of all inputs, whatever their
+    // id ranges. A chunk is sorted only once the merge reaches its smallest
+    // id, so memory follows the chunks whose ids overlap, not the inputs.
+    std::vector<SortedChunk> chunks;
+    for (std::size_t i = 0; i < readers.size(); ++i) {
+        for (std::uint64_t c = 0; c < readers[i]->GetNumberOfChunks(); ++c) {
+            SortedChunk chunk;
+            chunk.input = i;
+            chunk.chunk = c;
+            chunk.view = readers[i]->GetChunk(c);
+            if (chunk.view.nRows == 0) continue;
+            chunk.minEventId = chunk.EventId(0);
+            for (std::uint32_t row = 1; row < chunk.view.nRows; ++row) {
+                chunk.minEventId = std::min(chunk.minEventId, chunk.EventId(row));
+            }
+            chunks.push_back(std::move(chunk));
+        }
+    }
+    std::sort(chunks.begin(), chunks.end(), [](const SortedChunk& a, const SortedChunk& b) {
+        return Before(a.minEventId, a, b.minEventId, b);
+    });
+    
+    // Min-heap of the active chunks by their next record
+    auto later = [&chunks](std::size_t a, std::size_t b) {
+        return Before(chunks[b].Head(), chunks[b], chunks[a].Head(), chunks[a]);
+    };
+    std::vector<std::size_t> heap;
+    std::size_t pending = 0;
+    
+    EventFile::EventFileWriter writer(output);
+    while (pending < chunks.size() || !heap.empty()) {
+        // Start every chunk that may hold the next record
+        while (pending < chunks.size() &&
+               (heap.empty() || !Before(chunks[heap.front()].Head(), chunks[heap.front()],
+                                        chunks[pending].minEventId, chunks[pending]))) {
+            chunks[pending].Sort();
+            heap.push_back(pending++);
+            std::push_heap(heap.begin(), heap.end(), later);
+        }
+    
+        std::pop_heap(heap.begin(), heap.end(), later);
+        SortedChunk& chunk = chunks[heap.back()];
+        writer.Append(chunk.view.GetRecord(chunk.rows[chunk.next++]));
+        if (chunk.next < chunk.rows.size()) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            std::vector<std::uint32_t>().swap(chunk.rows);
+            heap.pop_back();
+        }
+    }
+    writer.Close();
+    return writer.GetNumberOfRows();
+}
+
+void MergeHistogramFiles(const std::vector<std::string>& inputs, const std::string& output) {
+    if (inputs.empty()) throw std::runtime_error("OutputMerge: no histogram files to merge");
+    
+    HistogramSet merged = HistogramFile::Read(inputs[0]);
+    for (std::size_t i = 1; i < inputs.size(); ++i) {
+        if (!merged.Merge(HistogramFile::Read(inputs[i]))) {
+            throw std::runtime_error("OutputMerge: the histograms of " + inputs[i] + " differ from " +
+                                     inputs[0]);
+        }
+    }
+    HistogramFile::Write(output, merged);
+}
+
+CounterSet MergeCounterFiles(const std::vector<std::string>& inputs, const std::string& output) {
+    CounterSet merged;
+    for (const std::string& input : inputs) merged.Merge(CounterFile::Read(input));
+    CounterFile::Write(output, merged);
+    return merged;
+}
+
+Result Merge(const std::vector<std::string>& inputs, const std::string& output, bool textEvents) {
+    Result result;
+    result.inputs = inputs.size();
+    
+    if (AllExist(inputs, EventFile::EXTENSION)) {
+        const std::vector<std::string> paths = WithExtension(inputs, EventFile::EXTENSION);
+        if (!textEvents) {
+            result.rows = MergeEventFiles(paths, output + EventFile::EXTENSION);
+        } else {
+            // Through a binary file, converted like BetaDecayEventDump --text
+            const std::string binary = output + EventFile::EXTENSION + ".tmp";
+            result.rows = MergeEventFiles(paths, binary);
+            {
+                EventFile::EventFileReader reader(binary);
+                std::ofstream text(output + ".txt", std::ios::binary);
+                if (text) reader.WriteText(text);
+                if (!text) {
+                    std::remove(binary.c_str());
+                    throw std::runtime_error("OutputMerge: write error on " + output + ".txt");
+                }
+            }
+            std::remove(binary.c_str());
+        }
+        result.events = true;
+    }
+    if (AllExist(inputs, HistogramFile::EXTENSION)) {
+        MergeHistogramFiles(WithExtension(inputs, HistogramFile::EXTENSION),
+                            output + HistogramFile::EXTENSION);
+        result.histograms = true;
+    }
+    if (AllExist(inputs, CounterFile::EXTENSION)) {
+        result.mergedCounters = MergeCounterFiles(WithExtension(inputs, CounterFile::EXTENSION),
+                                                  output + CounterFile::EXTENSION);
+        result.counters = true;
+    }
+    return result;
+}
+
+void Remove(const std::string& name) {
+    std::remove((name + EventFile::EXTENSION).c_str());
+    std::remove((name + HistogramFile::EXTENSION).c_str());
+    std::remove((name + CounterFile::EXTENSION).c_str());
+}
+
+} // namespace OutputMerge
@@ -0,0 +1,102 @@
+// src/ParameterSweep.cc
+#include "ParameterSweep.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace ParameterSweep {
+
+namespace {
+    std::vector<std::string> Cells(const std::string& line) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::vector<std::string> cells;
+        std::string cell;
+        while (fields >> cell) cells.push_back(cell);
+        return cells;
+    }
+    
+    std::string Spaced(std::string value) {
+        std::replace(value.begin(), value.end(), ',', ' ');
+        return value;
+    }
+    
+    // The UI command of a cell, empty for the name and events columns
+    G4String Command(const std::string& column, const std::string& value) {
+        if (column == "isotope") return "/betadecay/gun/isotope " + value;
+        if (column == "decayMode") return "/betadecay/gun/decayMode " + value;
+        if (column == "qValue") return "/betadecay/gun/qValue " + value + " MeV";
+        if (column == "position") return "/betadecay/gun/position " + Spaced(value) + " cm";
+        if (column == "distance") return "/betadecay/detector/distance " + value + " cm";
+        if (column == "seed") return "/betadecay/gun/seed " + value;
+        if (column[0] == '/') return column + " " + Spaced(value);
+        return "";
+    }
+}
+
+std::vector<Configuration> ReadTable(const std::string& path, G4long defaultEvents) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("ParameterSweep: cannot open " + path);
+    
+    const std::set<std::string> known = {
+        "name", "events", "isotope", "decayMode", "qValue", "position", "distance", "seed"
+    };
+    std::vector<std::string> columns;
+    std::vector<Configuration> configurations;
+    std::set<std::string> names;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        const std::vector<std::string> cells = Cells(line);
+        if (cells.empty()) continue;
+        const std::string where = path + ":" + std::to_string(lineNumber);
+    
+        if (columns.empty()) {
+            for (const std::string& column : cells) {
+                if (column[0] != '/' && known.count(column) == 0) {
+                    throw std::runtime_error("ParameterSweep: unknown column " + column + " at " + where);
+                }
+            }
+            columns = cells;
+            continue;
+        }
+        if (cells.size() != columns.size()) {
+            throw std::runtime_error("ParameterSweep: " + std::to_string(cells.size()) + " cells for " +
+                                     std::to_string(columns.size()) + " columns at " + where);
+        }
+    
+        Configuration configuration;
+        configuration.name = "config" + std::to_string(configurations.size());
+        configuration.events = defaultEvents;
+        for (std::size_t c = 0; c < cells.size(); ++c) {
+            if (cells[c] == "-") continue;
+            if (columns[c] == "name") {
+                configuration.name = cells[c];
+            } else if (columns[c] == "events") {
+                char* end = nullptr;
+                configuration.events = std::strtol(cells[c].c_str(), &end, 10);
+                if (*end != '\0' || configuration.events < 0) {
+                    throw std::runtime_error("ParameterSweep: bad event count " + cells[c] + " at " + where);
+                }
+            } else {
+                configuration.commands.push_back(Command(columns[c], cells[c]));
+            }
+        }
+        if (configuration.events < 0) {
+            throw std::runtime_error("ParameterSweep: no event count for " + configuration.name + " at " +
+                                     where + " (add an events column or give --events)");
+        }
+        if (!names.insert(configuration.name).second) {
+            throw std::runtime_error("ParameterSweep: duplicate name " + configuration.name + " at " + where);
+        }
+        configurations.push_back(configuration);
+    }
+    if (configurations.empty()) throw std::runtime_error("ParameterSweep: no configuration in " + path);
+    return configurations;
+}
+
+} // namespace ParameterSweep
@@ -0,0 +1,65 @@
+// src/PhaseProfile.cc
+#include "PhaseProfile.hh"
+
+#include <iomanip>
+#include <sstream>
+
+thread_local PhaseProfile* PhaseProfile::fActive = nullptr;
+
+PhaseProfile::PhaseProfile() : fSteppingSum(0) {}
+
+const char* PhaseProfile::PhaseName(Phase phase) {
+    switch (phase) {
+        case GENERATION:   return "generation";
+        case TRACKING:     return "tracking";
+        case STEPPING:     return "stepping";
+        case END_OF_EVENT: return "end of event";
+        case OUTPUT:       return "output";
+        case EVENT:        return "event";
+        case N_PHASES:     break;
+    }
+    return "unknown";
+}
+
+void PhaseProfile::EndEvent() {
+    Add(EVENT, Clock::now() - fEventStart);
+    fHistograms[STEPPING].Record(fSteppingSum);
+    fSteppingSum = 0;
+}
+
+void PhaseProfile::Merge(const PhaseProfile& other) {
+    for (int phase = 0; phase < N_PHASES; ++phase) {
+        fHistograms[phase].Merge(other.fHistograms[phase]);
+    }
+}
+
+void PhaseProfile::Reset() {
+    for (LatencyHistogram& histogram : fHistograms) histogram.Reset();
+    fSteppingSum = 0;
+}
+
+void PhaseProfile::Report(std::ostream& out) const {
+    const double eventTime = static_cast<double>(fHistograms[EVENT].GetSum());
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    // Formatted into a string first: out is usually G4cout
+    std::ostringstream table;
+    table << "Event phase timing (" << GetEventCount() << " events, microseconds per event)\n"
+          << "  " << std::left << std::setw(14) << "phase" << std::right
+          << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90"
+          << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max"
+          << std::setw(9) << "share" << "\n";
+    table << std::fixed;
+    for (int phase = 0; phase < N_PHASES; ++phase) {
+        const LatencyHistogram& histogram = fHistograms[phase];
+        table << "  " << std::left << std::setw(14) << PhaseName(Phase(phase)) << std::right
+              << std::setprecision(2) << std::setw(10) << histogram.GetMean()*1e-3;
+        for (double quantile : quantiles) {
+            table << std::setw(10) << histogram.GetQuantile(quantile)*1e-3;
+        }
+        table << std::setw(12) << histogram.GetMax()*1e-3 << std::setprecision(1)
+              << std::setw(8) << (eventTime > 0.0 ? 100.0*histogram.GetSum()/eventTime : 0.0)
+              << "%\n";
+    }
+    out << table.str();
+}
@@ -1,40 +1,156 @@
 // src/PhysicsList.cc
 #include "PhysicsList.hh"
+#include "G4EmStandardPhysics.hh"
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4EmLivermorePhysics.hh"
+#include "G4DecayPhysics.hh"
+#include "G4RadioactiveDecayPhysics.hh"
+#include "G4OpticalPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4ProductionCuts.hh"
 #include "G4ProductionCutsTable.hh"
-#include "G4EmParameters.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4Threading.hh"
 
-PhysicsList::PhysicsList() {
-    // Set verbosity for physics processes
-    G4int verbosity = 1;
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    enum class EmPhysics { STANDARD, OPTION4, LIVERMORE };
+    
+    struct Profile {
+        const char* name;
+        EmPhysics em;
+        G4double worldCut;
+        G4double sourceCut;
+        G4double detectorCut;
+        G4double lowestCutEnergy;
+    };
+    
+    const Profile PROFILES[] = {
+        {"fast",      EmPhysics::STANDARD,  10.0*cm, 1.0*mm,  1.0*mm,  990*eV},
+        {"standard",  EmPhysics::STANDARD,  0.7*mm,  0.7*mm,  0.7*mm,  990*eV},
+        {"precise",   EmPhysics::OPTION4,   1.0*mm,  10.0*um, 10.0*um, 250*eV},
+        {"livermore", EmPhysics::LIVERMORE, 1.0*mm,  10.0*um, 10.0*um, 250*eV}
+    };
+    
+    const Profile* FindProfile(const G4String& name) {
+        for (const Profile& profile : PROFILES) {
+            if (name == profile.name) return &profile;
+        }
+        return nullptr;
+    }
+    
+    // Cuts of a region built by DetectorConstruction, if it exists
+    void SetRegionCut(const G4String& name, G4double cut) {
+        G4Region* region = G4RegionStore::GetInstance()->GetRegion(name, false);
+        if (!region) return;
+        G4ProductionCuts* cuts = region->GetProductionCuts();
+        if (!cuts) {
+            cuts = new G4ProductionCuts();
+            region->SetProductionCuts(cuts);
+        }
+        cuts->SetProductionCut(cut);
+    }
+}
+
+PhysicsList::PhysicsList(const G4String& profileName, G4int verbose) {
+    const Profile* profile = FindProfile(profileName);
+    if (!profile) {
+        G4cerr << "WARNING: unknown physics profile " << profileName
+               << ", using standard" << G4endl;
+        profile = FindProfile("standard");
+    }
+    fProfileName = profile->name;
+    fWorldCut = profile->worldCut;
+    fSourceCut = profile->sourceCut;
+    fDetectorCut = profile->detectorCut;
+    fLowestCutEnergy = profile->lowestCutEnergy;
     
     // Register electromagnetic physics
-    RegisterPhysics(new G4EmStandardPhysics(verbosity));
+    switch (profile->em) {
+        case EmPhysics::STANDARD:  RegisterPhysics(new G4EmStandardPhysics(verbose)); break;
+        case EmPhysics::OPTION4:   RegisterPhysics(new G4EmStandardPhysics_option4(verbose)); break;
+        case EmPhysics::LIVERMORE: RegisterPhysics(new G4EmLivermorePhysics(verbose)); break;
+    }
     
     // Register decay physics (important for beta decay!)
-    RegisterPhysics(new G4DecayPhysics(verbosity));
+    RegisterPhysics(new G4DecayPhysics(verbose));
     
     // Register radioactive decay (for beta decay sources)
-    RegisterPhysics(new G4RadioactiveDecayPhysics(verbosity));
+    RegisterPhysics(new G4RadioactiveDecayPhysics(verbose));
+    
+    // Fast simulation of e-/e+ (the ElectronFastModel of the Detector
+    // region, off unless /betadecay/fastsim/enable)
+    G4FastSimulationPhysics* fastSimulation = new G4FastSimulationPhysics();
+    fastSimulation->ActivateFastSimulation("e-");
+    fastSimulation->ActivateFastSimulation("e+");
+    RegisterPhysics(fastSimulation);
     
     // Optional: optical physics for scintillation detectors
-    // RegisterPhysics(new G4OpticalPhysics(verbosity));
+    // RegisterPhysics(new G4OpticalPhysics(verbose));
     
     // Set physics list verbosity
-    SetVerboseLevel(verbosity);
+    SetVerboseLevel(verbose);
 }
 
 PhysicsList::~PhysicsList() {}
 
+G4bool PhysicsList::IsProfile(const G4String& name) {
+    return FindProfile(name) != nullptr;
+}
+
+G4String PhysicsList::ProfileNames() {
+    G4String names;
+    for (const Profile& profile : PROFILES) {
+        if (!names.empty()) names += " ";
+        names += profile.name;
+    }
+    return names;
+}
+
+G4String PhysicsList::CutsKey() {
+    std::ostringstream cuts;
+    cuts << std::setprecision(17);
+    for (const G4Region* region : *G4RegionStore::GetInstance()) {
+        cuts << region->GetName();
+        if (const G4ProductionCuts* production = region->GetProductionCuts()) {
+            for (G4int particle = 0; particle < 4; ++particle) {
+                cuts << " " << production->GetProductionCut(particle);
+            }
+        }
+        cuts << ";";
+    }
+    cuts << G4ProductionCutsTable::GetProductionCutsTable()->GetLowEdgeEnergy();
+    
+    // FNV-1a, which unlike std::hash is the same in every build
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char c : cuts.str()) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+    return key;
+}
+
 void PhysicsList::SetCuts() {
-    // Set cut values for particle tracking
-    // Default cut value for gamma, e-, e+, protons
-    G4double defaultCutValue = 0.7*mm;  // 0.7 mm cut
-    SetCutValue(defaultCutValue, "gamma");
-    SetCutValue(defaultCutValue, "e-");
-    SetCutValue(defaultCutValue, "e+");
-    SetCutValue(defaultCutValue, "proton");
-    
-    // Apply cuts to production thresholds
-    DumpCutValuesTable();
-}
\ No newline at end of file
+    // World (default region): gamma, e-, e+ and proton
+    SetDefaultCutValue(fWorldCut);
+    
+    // The scoring volumes get their own cuts
+    SetRegionCut("Source", fSourceCut);
+    SetRegionCut("Detector", fDetectorCut);
+    
+    G4ProductionCutsTable::GetProductionCutsTable()->SetEnergyRange(fLowestCutEnergy, 100*GeV);
+    
+    if (!G4Threading::IsMasterThread()) return;
+    G4cout << "Physics profile " << fProfileName << ": cuts world " << fWorldCut/mm
+           << " mm, source " << fSourceCut/mm << " mm, detector " << fDetectorCut/mm
+           << " mm" << G4endl;
+    if (verboseLevel > 1) DumpCutValuesTable();
+}
@@ -0,0 +1,147 @@
+// src/PrimaryFile.cc
+#include "PrimaryFile.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PrimaryFile {
+
+namespace {
+    std::mutex gReaderMutex;
+    std::map<std::string, std::weak_ptr<const PrimaryFileReader>> gReaders;
+}
+
+//==============================================================================
+// PrimaryFileWriter
+//==============================================================================
+
+PrimaryFileWriter::PrimaryFileWriter(const std::string& path)
+    : fFile(nullptr), fPath(path), fPartialPath(path + ".tmp" + std::to_string(::getpid())),
+      fNParticles(0), fOk(true) {
+    fFile = std::fopen(fPartialPath.c_str(), "wb");
+    if (!fFile) throw std::runtime_error("PrimaryFileWriter: cannot create " + fPartialPath);
+    
+    // Placeholder; the real header is written by Close()
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    fOk = std::fwrite(&header, sizeof(header), 1, fFile) == 1;
+}
+
+PrimaryFileWriter::~PrimaryFileWriter() {
+    if (!fFile) return;
+    try {
+        Close();
+    } catch (const std::runtime_error&) {
+        // Close() already removed the partial file
+    }
+}
+
+void PrimaryFileWriter::AddEvents(const EventEntry* events, std::size_t nEvents,
+                                  const ParticleEntry* particles, std::size_t nParticles) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fFile) throw std::runtime_error("PrimaryFileWriter: " + fPath + " is closed");
+    
+    fOk = fOk && std::fwrite(particles, sizeof(ParticleEntry), nParticles, fFile) == nParticles;
+    for (std::size_t i = 0; i < nEvents; ++i) {
+        fEvents.push_back(events[i]);
+        fEvents.back().firstParticle += fNParticles;
+    }
+    fNParticles += nParticles;
+}
+
+void PrimaryFileWriter::Close() {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fFile) return;
+    
+    std::sort(fEvents.begin(), fEvents.end(),
+              [](const EventEntry& a, const EventEntry& b) { return a.eventId < b.eventId; });
+    
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = VERSION;
+    header.nEvents = fEvents.size();
+    header.nParticles = fNParticles;
+    header.particlesOffset = sizeof(FileHeader);
+    header.eventsOffset = sizeof(FileHeader) + fNParticles*sizeof(ParticleEntry);
+    
+    bool ok = fOk && std::fwrite(fEvents.data(), sizeof(EventEntry), fEvents.size(), fFile) == fEvents.size();
+    ok = ok && std::fseek(fFile, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, fFile) == 1;
+    ok = (std::fclose(fFile) == 0) && ok;
+    fFile = nullptr;
+    ok = ok && std::rename(fPartialPath.c_str(), fPath.c_str()) == 0;
+    if (!ok) {
+        std::remove(fPartialPath.c_str());
+        throw std::runtime_error("PrimaryFileWriter: write error on " + fPath);
+    }
+}
+
+std::uint64_t PrimaryFileWriter::GetNumberOfEvents() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fEvents.size();
+}
+
+//==============================================================================
+// PrimaryFileReader
+//==============================================================================
+
+PrimaryFileReader::PrimaryFileReader(const std::string& path)
+    : fPath(path), fData(nullptr), fSize(0), fHeader(nullptr), fParticles(nullptr),
+      fEvents(nullptr) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("PrimaryFileReader: cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("PrimaryFileReader: " + path + " is too short");
+    }
+    fSize = static_cast<std::size_t>(info.st_size);
+    
+    void* mapping = ::mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("PrimaryFileReader: cannot map " + path);
+    }
+    fData = static_cast<const char*>(mapping);
+    
+    fHeader = reinterpret_cast<const FileHeader*>(fData);
+    // The counts are bounded by the file size first, so that the sizes
+    // below cannot wrap around
+    const bool countsOk = fHeader->nParticles <= fSize/sizeof(ParticleEntry) &&
+                          fHeader->nEvents <= fSize/sizeof(EventEntry);
+    if (std::memcmp(fHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        fHeader->version > VERSION || !countsOk || fHeader->particlesOffset != sizeof(FileHeader) ||
+        fHeader->eventsOffset != fHeader->particlesOffset + fHeader->nParticles*sizeof(ParticleEntry) ||
+        fHeader->eventsOffset + fHeader->nEvents*sizeof(EventEntry) != fSize) {
+        ::munmap(mapping, fSize);
+        throw std::runtime_error("PrimaryFileReader: " + path + " is not a complete primary file");
+    }
+    fParticles = reinterpret_cast<const ParticleEntry*>(fData + fHeader->particlesOffset);
+    fEvents = reinterpret_cast<const EventEntry*>(fData + fHeader->eventsOffset);
+}
+
+PrimaryFileReader::~PrimaryFileReader() {
+    if (fData) ::munmap(const_cast<char*>(fData), fSize);
+}
+
+std::shared_ptr<const PrimaryFileReader> PrimaryFileReader::Open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(gReaderMutex);
+    std::weak_ptr<const PrimaryFileReader>& entry = gReaders[path];
+    std::shared_ptr<const PrimaryFileReader> reader = entry.lock();
+    if (!reader) {
+        reader = std::make_shared<const PrimaryFileReader>(path);
+        entry = reader;
+    }
+    return reader;
+}
+
+} // namespace PrimaryFile
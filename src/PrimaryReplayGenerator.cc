@@ -0,0 +1,83 @@
+// src/PrimaryReplayGenerator.cc
+#include "PrimaryReplayGenerator.hh"
+#include "G4Event.hh"
+#include "G4IonTable.hh"
+#include "G4ParticleTable.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+    // Warnings are printed once per process, not once per worker
+    std::atomic<bool> gWrapWarned(false);
+    std::atomic<bool> gUnknownWarned(false);
+    std::atomic<bool> gCorruptWarned(false);
+}
+
+PrimaryReplayGenerator::PrimaryReplayGenerator(const G4String& fileName)
+    : fFile(PrimaryFile::PrimaryFileReader::Open(fileName)), fFirstEvent(0) {
+    if (fFile->GetNumberOfEvents() == 0) {
+        throw std::runtime_error("PrimaryReplayGenerator: " + fileName + " holds no events");
+    }
+}
+
+PrimaryReplayGenerator::~PrimaryReplayGenerator() {}
+
+void PrimaryReplayGenerator::GeneratePrimaryVertex(G4Event* event) {
+    GenerateRecord(event, fFirstEvent + event->GetEventID());
+}
+
+void PrimaryReplayGenerator::GenerateRecord(G4Event* event, G4long index) {
+    const std::uint64_t nEvents = fFile->GetNumberOfEvents();
+    std::uint64_t record = static_cast<std::uint64_t>(index > 0 ? index : 0);
+    if (record >= nEvents) {
+        if (!gWrapWarned.exchange(true)) {
+            G4cerr << "WARNING: " << fFile->GetPath() << " holds " << nEvents
+                   << " events; replay wraps around to its first record" << G4endl;
+        }
+        record %= nEvents;
+    }
+    
+    const PrimaryFile::EventEntry& entry = fFile->GetEvent(record);
+    const PrimaryFile::ParticleEntry* particles = fFile->GetParticles(entry);
+    if (!particles) {
+        if (!gCorruptWarned.exchange(true)) {
+            G4cerr << "ERROR: record " << record << " of " << fFile->GetPath()
+                   << " points outside the particle table; such events are left empty" << G4endl;
+        }
+        return;
+    }
+    
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(G4ThreeVector(entry.x, entry.y, entry.z)*mm, 0.);
+    vertex->SetWeight(entry.weight);
+    for (std::uint32_t i = 0; i < entry.nParticles; ++i) {
+        const PrimaryFile::ParticleEntry& particle = particles[i];
+        G4ParticleDefinition* definition = FindParticle(particle.pdgCode);
+        if (!definition) continue;
+        vertex->SetPrimary(new G4PrimaryParticle(definition, particle.px*MeV, particle.py*MeV,
+                                                 particle.pz*MeV));
+    }
+    event->AddPrimaryVertex(vertex);
+}
+
+G4ParticleDefinition* PrimaryReplayGenerator::FindParticle(G4int pdgCode) {
+    const auto it = fParticles.find(pdgCode);
+    if (it != fParticles.end()) return it->second;
+    
+    // Ions are 100ZZZAAAI
+    G4ParticleDefinition* definition = nullptr;
+    if (pdgCode > 1000000000) {
+        definition = G4IonTable::GetIonTable()->GetIon((pdgCode/10000)%1000, (pdgCode/10)%1000);
+    } else {
+        definition = G4ParticleTable::GetParticleTable()->FindParticle(pdgCode);
+    }
+    if (!definition && !gUnknownWarned.exchange(true)) {
+        G4cerr << "WARNING: unknown PDG code " << pdgCode << " in " << fFile->GetPath()
+               << "; such particles are skipped" << G4endl;
+    }
+    fParticles.emplace(pdgCode, definition);
+    return definition;
+}
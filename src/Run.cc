@@ -0,0 +1,213 @@
+// src/Run.cc
+#include "Run.hh"
+#include "G4SystemOfUnits.hh"
+#include <algorithm>
+#include <cmath>
+
+Run::Run(const HistogramSettings& histograms)
+    : G4Run(), fEventCount(0), fTotalEnergy(0.0),
+      fSingleBetaCount(0), fDoubleBetaCount(0), fDepositEvents(0), fWeightSum(0.0),
+      fFastSimTracks(0), fFastSimEnergy(0.0), fTelemetry(nullptr) {
+    fDeposits.Clear();
+    for (G4int volume = 0; volume < EnergyDeposit::N_VOLUMES; ++volume) {
+        fHitEvents[volume] = 0;
+        fHitWeight[volume] = 0.;
+        fHitWeightSquares[volume] = 0.;
+        fDepositSquares[volume] = 0.;
+    }
+    
+    const Histogram::Axis energy(std::max(1, histograms.bins), 0., histograms.energyMax);
+    const Histogram::Axis energy2D(std::max(1, histograms.bins/5), 0., histograms.energyMax);
+    fHistograms.Book("edep_detector", "Detector energy per event (MeV)", energy);
+    fHistograms.Book("edep_source", "Source energy per event (MeV)", energy);
+    fHistograms.Book("edep_single", "Detector energy, single beta events (MeV)", energy);
+    fHistograms.Book("edep_double", "Detector energy, double beta events (MeV)", energy);
+    fHistograms.Book("primary_energy", "Primary e-/e+ kinetic energy (MeV)", energy);
+    fHistograms.Book("bb_sum", "Summed e-/e+ energy, two or more leptons (MeV)", energy);
+    fHistograms.Book("bb_t1_t2", "First vs second e-/e+ energy (MeV)", energy2D, energy2D);
+    fHistograms.Book("response", "Summed e-/e+ energy vs detector energy (MeV)", energy2D, energy2D);
+}
+
+Run::~Run() {}
+
+void Run::RecordEvent(const G4Event* event) {
+    G4Run::RecordEvent(event);
+    if (fTelemetry) fTelemetry->AddEvent();
+}
+
+void Run::AddEventData(G4double energy, G4int decayType) {
+    fEventCount++;
+    fTotalEnergy += energy;
+    
+    if (decayType == 1) fSingleBetaCount++;
+    else if (decayType == 2) fDoubleBetaCount++;
+}
+
+void Run::AddDeposits(const EnergyDeposit::Table& deposits, G4double weight) {
+    fDeposits.Add(deposits, weight);
+    fDepositEvents++;
+    fWeightSum += weight;
+    for (G4int volume = 0; volume < EnergyDeposit::N_VOLUMES; ++volume) {
+        const G4double edep = deposits.Total(volume);
+        if (edep <= 0.) continue;
+        fHitEvents[volume]++;
+        fHitWeight[volume] += weight;
+        fHitWeightSquares[volume] += weight*weight;
+        fDepositSquares[volume] += weight*edep*edep;
+    }
+}
+
+G4double Run::GetEfficiency(G4int volume) const {
+    return fDepositEvents > 0 ? fHitWeight[volume]/fDepositEvents : 0.;
+}
+
+G4double Run::GetEfficiencyError(G4int volume) const {
+    // Standard error of the mean of weight*hit over the events
+    if (fDepositEvents < 2) return 0.;
+    const G4double mean = GetEfficiency(volume);
+    const G4double variance = fHitWeightSquares[volume]/fDepositEvents - mean*mean;
+    return std::sqrt(std::max(0., variance)/(fDepositEvents - 1));
+}
+
+void Run::FillHistograms(const EnergyDeposit::Table& deposits, G4int decayType,
+                         const std::vector<G4double>& leptonEnergies, G4double weight) {
+    G4double leptonSum = 0.;
+    for (G4double energy : leptonEnergies) {
+        fHistograms[H_PRIMARY_ENERGY].Fill(energy/MeV, weight);
+        leptonSum += energy/MeV;
+    }
+    if (leptonEnergies.size() >= 2) {
+        fHistograms[H_BB_SUM].Fill(leptonSum, weight);
+        fHistograms[H_BB_T1_T2].Fill(leptonEnergies[0]/MeV, leptonEnergies[1]/MeV, weight);
+    }
+    
+    const G4double detector = deposits.Total(EnergyDeposit::DETECTOR)/MeV;
+    if (detector > 0.) {
+        fHistograms[H_EDEP_DETECTOR].Fill(detector, weight);
+        fHistograms[decayType == 2 ? H_EDEP_DOUBLE : H_EDEP_SINGLE].Fill(detector, weight);
+        fHistograms[H_RESPONSE].Fill(leptonSum, detector, weight);
+    }
+    const G4double source = deposits.Total(EnergyDeposit::SOURCE)/MeV;
+    if (source > 0.) fHistograms[H_EDEP_SOURCE].Fill(source, weight);
+}
+
+void Run::AddCrystalDeposit(G4int crystal, G4double edep) {
+    if (crystal >= static_cast<G4int>(fCrystalEnergy.size())) {
+        fCrystalEnergy.resize(crystal + 1, 0.);
+        fCrystalHits.resize(crystal + 1, 0);
+    }
+    fCrystalEnergy[crystal] += edep;
+    fCrystalHits[crystal]++;
+}
+
+void Run::AttachWriter(EventFile::AsyncEventWriter* writer) {
+    fProducer.reset();
+    if (writer) fProducer = writer->CreateProducer();
+}
+
+void Run::DetachWriter() {
+    // The producer destructor flushes
+    fProducer.reset();
+}
+
+CounterSet Run::GetCounters() const {
+    CounterSet counters;
+    counters.Set("events", fEventCount);
+    counters.Set("single_beta", fSingleBetaCount);
+    counters.Set("double_beta", fDoubleBetaCount);
+    counters.Set("total_energy", fTotalEnergy/MeV);
+    counters.Set("deposit_events", fDepositEvents);
+    counters.Set("weight_sum", fWeightSum);
+    
+    std::vector<G4double> deposits;
+    for (const auto& row : fDeposits.value) {
+        for (G4double value : row) deposits.push_back(value/MeV);
+    }
+    counters.Set("deposits", deposits);
+    counters.Set("hit_events", std::vector<G4double>(fHitEvents, fHitEvents + EnergyDeposit::N_VOLUMES));
+    counters.Set("hit_weight", std::vector<G4double>(fHitWeight, fHitWeight + EnergyDeposit::N_VOLUMES));
+    counters.Set("hit_weight_squares",
+                 std::vector<G4double>(fHitWeightSquares, fHitWeightSquares + EnergyDeposit::N_VOLUMES));
+    std::vector<G4double> depositSquares;
+    for (G4double value : fDepositSquares) depositSquares.push_back(value/(MeV*MeV));
+    counters.Set("deposit_squares", depositSquares);
+    
+    std::vector<G4double> crystalEnergy;
+    for (G4double value : fCrystalEnergy) crystalEnergy.push_back(value/MeV);
+    counters.Set("crystal_energy", crystalEnergy);
+    counters.Set("crystal_hits", std::vector<G4double>(fCrystalHits.begin(), fCrystalHits.end()));
+    counters.Set("fast_sim_tracks", static_cast<G4double>(fFastSimTracks));
+    counters.Set("fast_sim_energy", fFastSimEnergy/MeV);
+    return counters;
+}
+
+G4bool Run::Restore(const CounterSet& counters, const HistogramSet& histograms) {
+    fEventCount += static_cast<G4int>(counters.Get("events"));
+    fSingleBetaCount += static_cast<G4int>(counters.Get("single_beta"));
+    fDoubleBetaCount += static_cast<G4int>(counters.Get("double_beta"));
+    fTotalEnergy += counters.Get("total_energy")*MeV;
+    fDepositEvents += static_cast<G4int>(counters.Get("deposit_events"));
+    fWeightSum += counters.Get("weight_sum");
+    // Every event records its deposits
+    numberOfEvent += static_cast<G4int>(counters.Get("deposit_events"));
+    
+    for (G4int volume = 0; volume < EnergyDeposit::N_VOLUMES; ++volume) {
+        for (G4int species = 0; species < EnergyDeposit::N_SPECIES; ++species) {
+            fDeposits.value[volume][species] +=
+                counters.Get("deposits", volume*EnergyDeposit::N_SPECIES + species)*MeV;
+        }
+        fHitEvents[volume] += static_cast<G4int>(counters.Get("hit_events", volume));
+        fHitWeight[volume] += counters.Get("hit_weight", volume);
+        fHitWeightSquares[volume] += counters.Get("hit_weight_squares", volume);
+        fDepositSquares[volume] += counters.Get("deposit_squares", volume)*MeV*MeV;
+    }
+    
+    const std::vector<G4double>* crystalEnergy = counters.Find("crystal_energy");
+    const std::size_t nCrystals = crystalEnergy ? crystalEnergy->size() : 0;
+    if (nCrystals > fCrystalEnergy.size()) {
+        fCrystalEnergy.resize(nCrystals, 0.);
+        fCrystalHits.resize(nCrystals, 0);
+    }
+    for (std::size_t crystal = 0; crystal < nCrystals; ++crystal) {
+        fCrystalEnergy[crystal] += (*crystalEnergy)[crystal]*MeV;
+        fCrystalHits[crystal] += static_cast<G4int>(counters.Get("crystal_hits", crystal));
+    }
+    fFastSimTracks += static_cast<G4long>(counters.Get("fast_sim_tracks"));
+    fFastSimEnergy += counters.Get("fast_sim_energy")*MeV;
+    
+    return fHistograms.Merge(histograms);
+}
+
+void Run::Merge(const G4Run* run) {
+    const Run* localRun = static_cast<const Run*>(run);
+    
+    fEventCount += localRun->fEventCount;
+    fTotalEnergy += localRun->fTotalEnergy;
+    fSingleBetaCount += localRun->fSingleBetaCount;
+    fDoubleBetaCount += localRun->fDoubleBetaCount;
+    fDeposits += localRun->fDeposits;
+    for (G4int volume = 0; volume < EnergyDeposit::N_VOLUMES; ++volume) {
+        fHitEvents[volume] += localRun->fHitEvents[volume];
+        fHitWeight[volume] += localRun->fHitWeight[volume];
+        fHitWeightSquares[volume] += localRun->fHitWeightSquares[volume];
+        fDepositSquares[volume] += localRun->fDepositSquares[volume];
+    }
+    fDepositEvents += localRun->fDepositEvents;
+    fWeightSum += localRun->fWeightSum;
+    fHistograms.Merge(localRun->fHistograms);
+    fProfile.Merge(localRun->fProfile);
+    fFastSimTracks += localRun->fFastSimTracks;
+    fFastSimEnergy += localRun->fFastSimEnergy;
+    
+    const std::size_t nCrystals = localRun->fCrystalEnergy.size();
+    if (nCrystals > fCrystalEnergy.size()) {
+        fCrystalEnergy.resize(nCrystals, 0.);
+        fCrystalHits.resize(nCrystals, 0);
+    }
+    for (std::size_t crystal = 0; crystal < nCrystals; ++crystal) {
+        fCrystalEnergy[crystal] += localRun->fCrystalEnergy[crystal];
+        fCrystalHits[crystal] += localRun->fCrystalHits[crystal];
+    }
+    
+    G4Run::Merge(run);
+}
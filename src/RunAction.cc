@@ -1,67 +1,401 @@
 // src/RunAction.cc
 #include "RunAction.hh"
+#include "RunActionMessenger.hh"
+#include "BetaDecay.hh"
+#include "DetectorConstruction.hh"
+#include "EventFileFormat.hh"
+#include "Telemetry.hh"
 #include "G4Run.hh"
+#include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 
-RunAction::RunAction() 
-    : totalEvents(0), totalEnergy(0.0),
-      singleBetaCount(0), doubleBetaCount(0) {}
+namespace {
+    // Owned by the master for the duration of a run. Workers attach to it in
+    // their BeginOfRunAction, which the kernel only calls after the master's.
+    std::unique_ptr<EventFile::AsyncEventWriter> gWriter;
+    
+    // Restarted by the master for every run; each thread counts its events
+    // on its own slot
+    Telemetry gTelemetry;
+    
+    G4int ThreadSlot() {
+        return std::max(0, G4Threading::G4GetThreadId());
+    }
+}
+
+RunAction::RunAction(BetaDecayPrimaryGenerator* generator)
+    : fRun(nullptr), fOutputFormat(OutputFormat::TEXT),
+      fOutputFileName("beta_decay_output"), fTelemetryInterval(10.0),
+      fProfiling(false), fHistogramsEnabled(true), fGenerator(generator),
+      fCheckpointInterval(0.), fResumeEvents(-1) {
+    fMessenger = new RunActionMessenger(this);
+}
+
+RunAction::~RunAction() {
+    delete fMessenger;
+}
+
+G4Run* RunAction::GenerateRun() {
+    fRun = new Run(fHistogramSettings);
+    return fRun;
+}
 
-RunAction::~RunAction() {}
+G4String RunAction::GetOutputFileName() const {
+    return fOutputFileName + (fOutputFormat == OutputFormat::BINARY ? EventFile::EXTENSION : ".txt");
+}
 
 void RunAction::BeginOfRunAction(const G4Run* run) {
-    G4cout << "### Run " << run->GetRunID() << " started." << G4endl;
-    
-    // Open output file
-    outputFile.open("beta_decay_output.txt");
-    if (!outputFile.is_open()) {
-        G4cerr << "ERROR: Could not open output file!" << G4endl;
-        return;
+    if (IsMaster()) {
+        G4cout << "### Run " << run->GetRunID() << " started." << G4endl;
+        if (fResume && fResume->runId != run->GetRunID()) {
+            G4cerr << "WARNING: resuming run " << fResume->runId << " as run " << run->GetRunID()
+                   << "; its primaries differ from those of the interrupted run" << G4endl;
+        }
+        OpenOutput();
+        
+        // The reporter is not a Geant4 thread, so it writes to std::cout
+        // directly rather than through the (thread-local) G4cout
+        const G4RunManager* runManager = G4RunManager::GetRunManager();
+        gTelemetry.Start(run->GetNumberOfEventToBeProcessed(),
+                         runManager ? runManager->GetNumberOfThreads() : 1,
+                         fTelemetryInterval, std::cout);
+        if (fCheckpointInterval > 0.) {
+            if (!fCheckpointing) fCheckpointing.reset(new RunCheckpointing());
+            fCheckpointing->Start(run, GetCheckpointFileName(), fCheckpointInterval, fResume.get(),
+                                  gWriter.get(), fOutputFormat == OutputFormat::BINARY);
+        }
     }
     
-    // Write header
-    outputFile << "# Beta Decay Simulation Output" << std::endl;
-    outputFile << "# Event | Particle | Energy (MeV) | DecayType | X | Y | Z" << std::endl;
-    outputFile << "# DecayType: 1=SingleBeta, 2=DoubleBeta" << std::endl;
-    outputFile << "########################################" << std::endl;
+    fRun->AttachWriter(gWriter.get());
+    fRun->SetTelemetry(gTelemetry.GetCounter(ThreadSlot()));
+    PhaseProfile::SetActive(fProfiling ? &fRun->GetProfile() : nullptr);
+    
+    // The master of a multithreaded run processes no events
+    fCheckpointClient.Begin(!IsMaster() || !G4Threading::IsMultithreadedApplication());
+}
+
+void RunAction::EndOfEvent(G4long eventID) {
+    fRun->MarkDone(eventID);
+    fCheckpointClient.EndOfEvent(fRun);
+}
+
+G4bool RunAction::Resume() {
+    const G4String fileName = GetCheckpointFileName();
+    std::unique_ptr<Checkpoint::State> state = RunCheckpointing::Load(fileName, GetOutputFileName());
+    if (!state) return false;
+    fResume = std::move(state);
+    fResumeEvents = fResume->events - static_cast<G4long>(fResume->done.Count());
     
-    // Reset counters
-    totalEvents = 0;
-    totalEnergy = 0.0;
-    singleBetaCount = 0;
-    doubleBetaCount = 0;
+    // Event n of the next run is the n-th id left
+    if (fGenerator) {
+        const G4long first = fGenerator->GetFirstEvent();
+        fGenerator->SetEventRanges(fResume->done.Complement(first, first + fResume->events));
+    }
+    if (IsMaster()) {
+        G4cout << "Resuming from " << fileName << ": " << fResume->done.Count() << " of "
+               << fResume->events << " events done" << G4endl;
+        if (fResumeEvents == 0) FinishResume();
+    }
+    return true;
+}
+
+G4bool RunAction::IsComplete() const {
+    return !Checkpoint::Exists(GetCheckpointFileName()) &&
+           Checkpoint::Exists(fOutputFileName + CounterFile::EXTENSION);
+}
+
+void RunAction::FinishResume() {
+    // Interrupted after the last event: the checkpoint holds everything
+    Run run(fHistogramSettings);
+    if (!run.Restore(fResume->counters, fResume->histograms)) {
+        G4cerr << "WARNING: the spectra of " << GetCheckpointFileName()
+               << " are binned differently (/betadecay/histo/); not all are saved" << G4endl;
+    }
+    OpenOutput();
+    CloseOutput(&run);
+    if (fHistogramsEnabled) WriteHistograms(&run);
+    WriteCounters(&run);
+    Checkpoint::Remove(GetCheckpointFileName());
+    fResume.reset();
 }
 
 void RunAction::EndOfRunAction(const G4Run* run) {
+    // Hand over whatever this thread still buffers. Workers end their run
+    // before the master's EndOfRunAction, so every record is queued below.
+    fRun->DetachWriter();
+    fRun->SetTelemetry(nullptr);
+    PhaseProfile::SetActive(nullptr);
+    
+    fCheckpointClient.End(fRun);
+    // The event ids of a resumed run apply to it only
+    if (fGenerator) fGenerator->SetEventRanges(Checkpoint::EventRanges());
+    
+    // Worker runs are merged into the master run by the kernel; only the
+    // master (or the single thread of a sequential run) reports and writes
+    if (!IsMaster()) {
+        fResume.reset();
+        return;
+    }
+    
+    gTelemetry.Stop();
+    // The outputs written below replace the checkpoints
+    const G4bool checkpointed = fCheckpointing && fCheckpointing->Stop();
+    if (fResume && !fRun->Restore(fResume->counters, fResume->histograms)) {
+        G4cerr << "WARNING: the spectra of " << GetCheckpointFileName()
+               << " are binned differently (/betadecay/histo/); not all are saved" << G4endl;
+    }
+    const Telemetry::Snapshot telemetry = gTelemetry.GetSnapshot();
+    
+    const Run* mergedRun = static_cast<const Run*>(run);
+    const G4int totalEvents = mergedRun->GetEventCount();
+    const G4double totalEnergy = mergedRun->GetTotalEnergy();
+    
     G4cout << "### Run " << run->GetRunID() << " ended." << G4endl;
     G4cout << "  Total events: " << totalEvents << G4endl;
-    G4cout << "  Single beta decays: " << singleBetaCount << G4endl;
-    G4cout << "  Double beta decays: " << doubleBetaCount << G4endl;
+    if (fResume) {
+        G4cout << "  Resumed: " << fResume->done.Count() << " events from the checkpoint" << G4endl;
+    }
+    if (checkpointed) {
+        G4cout << "  Checkpoints written: " << fCheckpointing->GetNumberOfCheckpoints() << G4endl;
+    }
+    G4cout << "  Throughput: " << telemetry.GetRate() << " events/s ("
+           << telemetry.seconds << " s)" << G4endl;
+    if (telemetry.threads > 1) {
+        G4cout << "  Events per thread: " << telemetry.minThreadEvents << " to "
+               << telemetry.maxThreadEvents << " (balance " << telemetry.GetBalance() << ")" << G4endl;
+    }
+    G4cout << "  Single beta decays: " << mergedRun->GetSingleBetaCount() << G4endl;
+    G4cout << "  Double beta decays: " << mergedRun->GetDoubleBetaCount() << G4endl;
     if (totalEvents > 0) {
-        G4cout << "  Average energy per event: " << totalEnergy/totalEvents << " MeV" << G4endl;
+        G4cout << "  Average energy per event: " << totalEnergy/totalEvents/MeV << " MeV" << G4endl;
     }
     
-    // Write summary to file
-    outputFile << "########################################" << std::endl;
-    outputFile << "# SUMMARY" << std::endl;
-    outputFile << "# Total events: " << totalEvents << std::endl;
-    outputFile << "# Single beta decays: " << singleBetaCount << std::endl;
-    outputFile << "# Double beta decays: " << doubleBetaCount << std::endl;
-    if (totalEvents > 0) {
-        outputFile << "# Average energy: " << totalEnergy/totalEvents << " MeV" << std::endl;
+    const EnergyDeposit::Table& deposits = mergedRun->GetDeposits();
+    if (mergedRun->GetWeightSum() != mergedRun->GetNumberOfEvent()) {
+        G4cout << "  Mean event weight (biased emission): "
+               << mergedRun->GetWeightSum()/std::max(1, mergedRun->GetNumberOfEvent()) << G4endl;
+    }
+    RunDigest digest;
+    digest.runID = run->GetRunID();
+    digest.rate = telemetry.GetRate();
+    const G4double detectorHits = mergedRun->GetHitWeight(EnergyDeposit::DETECTOR);
+    if (detectorHits > 0.) {
+        digest.hitFraction = mergedRun->GetEfficiency(EnergyDeposit::DETECTOR);
+        digest.mean = deposits.Total(EnergyDeposit::DETECTOR)/detectorHits;
+        const G4double meanSquare = mergedRun->GetDepositSquares(EnergyDeposit::DETECTOR)/detectorHits;
+        digest.rms = std::sqrt(std::max(0., meanSquare - digest.mean*digest.mean));
+        const G4int hitEvents = std::max(1, mergedRun->GetHitEventCount(EnergyDeposit::DETECTOR));
+        digest.hitFractionError = mergedRun->GetEfficiencyError(EnergyDeposit::DETECTOR);
+        digest.meanError = digest.rms/std::sqrt(G4double(hitEvents));
+        digest.rmsError = digest.meanError/std::sqrt(2.);
+        G4cout << "  Detector energy per hit event: " << digest.mean/keV << " keV, rms "
+               << digest.rms/keV << " keV" << G4endl;
+    }
+    
+    for (G4int volume = 0; volume < EnergyDeposit::N_VOLUMES; ++volume) {
+        G4cout << "  Energy deposit in " << EnergyDeposit::VolumeName(volume) << ": "
+               << deposits.Total(volume)/MeV << " MeV in "
+               << mergedRun->GetHitEventCount(volume) << " events (";
+        for (G4int species = 0; species < EnergyDeposit::N_SPECIES; ++species) {
+            G4cout << (species ? ", " : "") << EnergyDeposit::SpeciesName(species) << " "
+                   << deposits.value[volume][species]/MeV;
+        }
+        G4cout << " MeV)" << G4endl;
+        G4cout << "    efficiency " << mergedRun->GetEfficiency(volume) << " +- "
+               << mergedRun->GetEfficiencyError(volume) << G4endl;
     }
     
-    // Close file
-    outputFile.close();
+    // Crystal summary by copy-number index (ix*ny + iy)
+    const std::vector<G4double>& crystalEnergy = mergedRun->GetCrystalEnergy();
+    const DetectorConstruction* detector = static_cast<const DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    if (detector && !crystalEnergy.empty()) {
+        const G4int ny = detector->GetArray().ny;
+        G4int hitCrystals = 0;
+        std::size_t hottest = 0;
+        for (std::size_t crystal = 0; crystal < crystalEnergy.size(); ++crystal) {
+            if (mergedRun->GetCrystalHits()[crystal] > 0) hitCrystals++;
+            if (crystalEnergy[crystal] > crystalEnergy[hottest]) hottest = crystal;
+        }
+        G4cout << "  Crystals hit: " << hitCrystals << " of " << detector->GetNumberOfCrystals()
+               << "; most energy in crystal " << hottest << " (ix " << hottest/ny << ", iy "
+               << hottest%ny << "): " << crystalEnergy[hottest]/MeV << " MeV in "
+               << mergedRun->GetCrystalHits()[hottest] << " events" << G4endl;
+    }
+    
+    ReportFastSim(mergedRun, digest);
+    CloseOutput(mergedRun);
+    if (fHistogramsEnabled) WriteHistograms(mergedRun);
+    WriteCounters(mergedRun);
+    if (checkpointed || fResume) Checkpoint::Remove(GetCheckpointFileName());
+    fResume.reset();
+    fResumeEvents = -1;
     
-    G4cout << "Output saved to: beta_decay_output.txt" << G4endl;
+    if (fProfiling) {
+        fLastProfile.reset(new PhaseProfile(mergedRun->GetProfile()));
+        ReportProfile("");
+    }
 }
 
-void RunAction::AddEventData(G4double energy, G4String particle, G4int decayType) {
-    totalEvents++;
-    totalEnergy += energy;
+void RunAction::ReportFastSim(const Run* run, const RunDigest& digest) {
+    const DetectorConstruction* detector = static_cast<const DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    if (!detector) return;
+    const DetectorConstruction::FastSimSettings& settings = detector->GetFastSimSettings();
+    
+    if (settings.enabled) {
+        G4cout << "  Fast simulation: " << run->GetFastSimTracks() << " e-/e+ below "
+               << settings.threshold/keV << " keV absorbed locally, "
+               << run->GetFastSimEnergy()/MeV << " MeV" << G4endl;
+    }
+    
+    // Against the last run in the other mode; meaningful for equal event
+    // counts of the same primaries (/betadecay/gun/streamPerRun false)
+    fLastRun[settings.enabled ? 1 : 0] = digest;
+    const RunDigest& full = fLastRun[0];
+    const RunDigest& fast = fLastRun[1];
+    if (full.runID < 0 || fast.runID < 0) return;
+    
+    // Changes in %, with the runs' uncertainties added in quadrature: an
+    // upper bound, as runs of the same primaries are correlated
+    auto change = [](G4double value, G4double error, G4double reference, G4double referenceError) {
+        if (value <= 0. || reference <= 0.) return std::string("n/a");
+        const G4double ratio = value/reference;
+        const G4double sigma = ratio*std::hypot(error/value, referenceError/reference);
+        std::ostringstream text;
+        text << std::showpos << std::setprecision(3) << 100.*(ratio - 1.) << std::noshowpos << " +- "
+             << 100.*sigma << "%";
+        return text.str();
+    };
+    G4cout << "  Fast vs full simulation (runs " << fast.runID << " and " << full.runID
+           << "): speedup " << (full.rate > 0. ? fast.rate/full.rate : 0.) << ", detector hit fraction "
+           << change(fast.hitFraction, fast.hitFractionError, full.hitFraction, full.hitFractionError)
+           << ", mean deposit " << change(fast.mean, fast.meanError, full.mean, full.meanError)
+           << ", rms " << change(fast.rms, fast.rmsError, full.rms, full.rmsError) << G4endl;
+}
+
+void RunAction::SetHistogramEnergyMax(G4double energy) {
+    if (energy > 0.) fHistogramSettings.energyMax = energy/MeV;
+}
+
+G4double RunAction::GetHistogramEnergyMax() const {
+    return fHistogramSettings.energyMax*MeV;
+}
+
+void RunAction::WriteHistograms(const Run* run) const {
+    const G4String fileName = fOutputFileName + HistogramFile::EXTENSION;
+    try {
+        HistogramFile::Write(fileName, run->GetHistograms());
+        G4cout << "  Histograms saved to: " << fileName << " (" << run->GetHistograms().Size()
+               << " spectra, " << fHistogramSettings.bins << " bins to "
+               << fHistogramSettings.energyMax << " MeV)" << G4endl;
+    } catch (const std::exception& e) {
+        G4cerr << "ERROR: " << e.what() << G4endl;
+    }
+}
+
+void RunAction::WriteCounters(const Run* run) const {
+    const G4String fileName = fOutputFileName + CounterFile::EXTENSION;
+    try {
+        CounterFile::Write(fileName, run->GetCounters());
+    } catch (const std::exception& e) {
+        G4cerr << "ERROR: " << e.what() << G4endl;
+    }
+}
+
+void RunAction::ReportProfile(const G4String& fileName) const {
+    if (!fLastProfile) {
+        G4cout << "No profiled run yet: /betadecay/profile/enable, then /run/beamOn" << G4endl;
+        return;
+    }
+    if (fileName.empty()) {
+        fLastProfile->Report(G4cout);
+        return;
+    }
+    
+    std::ofstream out(fileName);
+    fLastProfile->Report(out);
+    if (out) G4cout << "Profile report written to " << fileName << G4endl;
+    else G4cerr << "ERROR: cannot write " << fileName << G4endl;
+}
+
+void RunAction::OpenOutput() {
+    const EventFile::AsyncEventWriter::Format format =
+        (fOutputFormat == OutputFormat::BINARY) ? EventFile::AsyncEventWriter::Format::Binary
+                                                : EventFile::AsyncEventWriter::Format::Text;
+    
+    // A resumed run continues the event file of its checkpoint
+    G4bool append = false;
+    if (fResume && !fResume->eventFile.empty()) {
+        try {
+            const std::uint64_t kept = Checkpoint::PrepareEventFile(GetCheckpointFileName(), *fResume);
+            G4cout << "  Continuing " << fResume->eventFile << " after " << kept << " records" << G4endl;
+            append = true;
+        } catch (const std::exception& e) {
+            G4cerr << "ERROR: " << e.what() << "; event records are not saved!" << G4endl;
+            gWriter.reset();
+            return;
+        }
+    }
+    try {
+        gWriter.reset(new EventFile::AsyncEventWriter(GetOutputFileName(), format, fWriterSettings,
+                                                      append));
+    } catch (const std::exception& e) {
+        G4cerr << "ERROR: " << e.what() << "; event records are not saved!" << G4endl;
+        gWriter.reset();
+    }
+}
+
+void RunAction::CloseOutput(const Run* run) {
+    if (!gWriter) return;
+    
+    EventFile::TextSummary summary;
+    summary.totalEvents = run->GetEventCount();
+    summary.singleBetaCount = run->GetSingleBetaCount();
+    summary.doubleBetaCount = run->GetDoubleBetaCount();
+    summary.totalEnergy = run->GetTotalEnergy()/MeV;
     
-    if (decayType == 1) singleBetaCount++;
-    else if (decayType == 2) doubleBetaCount++;
-}
\ No newline at end of file
+    try {
+        gWriter->Close(summary);
+        
+        const EventFile::AsyncEventWriter::Statistics stats = gWriter->GetStatistics();
+        G4cout << "Output saved to: " << gWriter->GetPath() << " ("
+               << stats.records << " records, " << stats.bytes << " bytes)" << G4endl;
+        if (stats.stalls > 0) {
+            G4cout << "  Writer backpressure: " << stats.stalls << " waits, "
+                   << stats.stallSeconds << " s (consider /betadecay/output/bufferSize"
+                   << " or /betadecay/output/buffersPerThread)" << G4endl;
+        }
+    } catch (const std::exception& e) {
+        G4cerr << "ERROR: " << e.what() << G4endl;
+    }
+    gWriter.reset();
+}
+
+void RunAction::AddEventData(G4double energy, G4String particle, G4int decayType) {
+    fRun->AddEventData(energy, decayType);
+}
+
+void RunAction::AddParticleData(G4long eventID, G4int pdgCode, G4double energy,
+                                G4int decayType, const G4ThreeVector& position,
+                                G4double weight) {
+    EventFile::EventRecord record;
+    record.eventId = eventID;
+    record.particle = pdgCode;
+    record.decayType = static_cast<std::uint8_t>(decayType);
+    record.energy = energy/MeV;
+    record.x = static_cast<float>(position.x()/mm);
+    record.y = static_cast<float>(position.y()/mm);
+    record.z = static_cast<float>(position.z()/mm);
+    record.weight = weight;
+    fRun->AddRecord(record);
+}
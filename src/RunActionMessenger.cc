@@ -0,0 +1,201 @@
+// src/RunActionMessenger.cc
+#include "RunActionMessenger.hh"
+#include "RunAction.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+RunActionMessenger::RunActionMessenger(RunAction* runAction)
+    : G4UImessenger(), fRunAction(runAction) {
+    fDirectory = new G4UIdirectory("/betadecay/output/");
+    fDirectory->SetGuidance("Run output control");
+    
+    fFormatCmd = new G4UIcmdWithAString("/betadecay/output/format", this);
+    fFormatCmd->SetGuidance("Output format for per-particle event records.");
+    fFormatCmd->SetGuidance("  text   : beta_decay_output.txt style text lines");
+    fFormatCmd->SetGuidance("  binary : chunked columnar file (.bdevt), read it with");
+    fFormatCmd->SetGuidance("           BetaDecayEventDump or the EventFileReader library");
+    fFormatCmd->SetParameterName("format", false);
+    fFormatCmd->SetCandidates("text binary");
+    fFormatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fFileCmd = new G4UIcmdWithAString("/betadecay/output/file", this);
+    fFileCmd->SetGuidance("Output file name without extension (.txt or .bdevt is added).");
+    fFileCmd->SetParameterName("fileName", false);
+    fFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBufferSizeCmd = new G4UIcmdWithAnInteger("/betadecay/output/bufferSize", this);
+    fBufferSizeCmd->SetGuidance("Records per output buffer (one binary chunk each).");
+    fBufferSizeCmd->SetGuidance("Each thread fills a buffer, then hands it to the writer thread.");
+    fBufferSizeCmd->SetParameterName("records", false);
+    fBufferSizeCmd->SetRange("records>0");
+    fBufferSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fBuffersCmd = new G4UIcmdWithAnInteger("/betadecay/output/buffersPerThread", this);
+    fBuffersCmd->SetGuidance("Output buffers per thread (at least 2). A thread only waits");
+    fBuffersCmd->SetGuidance("for the disk when all of its buffers are queued for writing.");
+    fBuffersCmd->SetParameterName("buffers", false);
+    fBuffersCmd->SetRange("buffers>=2");
+    fBuffersCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fTelemetryDirectory = new G4UIdirectory("/betadecay/telemetry/");
+    fTelemetryDirectory->SetGuidance("Run progress and throughput reporting");
+    
+    fIntervalCmd = new G4UIcmdWithADouble("/betadecay/telemetry/interval", this);
+    fIntervalCmd->SetGuidance("Wall-clock seconds between progress lines (events done,");
+    fIntervalCmd->SetGuidance("events/s, ETA, per-thread balance); 0 disables them.");
+    fIntervalCmd->SetGuidance("The run summary always reports throughput.");
+    fIntervalCmd->SetParameterName("seconds", false);
+    fIntervalCmd->SetRange("seconds>=0");
+    fIntervalCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fProfileDirectory = new G4UIdirectory("/betadecay/profile/");
+    fProfileDirectory->SetGuidance("Per-phase event timing (generation, tracking, stepping,");
+    fProfileDirectory->SetGuidance("end of event, output) in per-thread latency histograms");
+    
+    fProfileEnableCmd = new G4UIcmdWithABool("/betadecay/profile/enable", this);
+    fProfileEnableCmd->SetGuidance("Time the event phases of the following runs; the report");
+    fProfileEnableCmd->SetGuidance("is printed at the end of each profiled run.");
+    fProfileEnableCmd->SetParameterName("enable", true);
+    fProfileEnableCmd->SetDefaultValue(true);
+    fProfileEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fProfileReportCmd = new G4UIcmdWithAString("/betadecay/profile/report", this);
+    fProfileReportCmd->SetGuidance("Print the phase timing of the last profiled run, or write");
+    fProfileReportCmd->SetGuidance("it to the given file.");
+    fProfileReportCmd->SetParameterName("fileName", true);
+    fProfileReportCmd->SetDefaultValue("");
+    fProfileReportCmd->AvailableForStates(G4State_Idle);
+    fProfileReportCmd->SetToBeBroadcasted(false);
+    
+    fHistoDirectory = new G4UIdirectory("/betadecay/histo/");
+    fHistoDirectory->SetGuidance("Online spectra filled per thread and merged at the end of");
+    fHistoDirectory->SetGuidance("the run into <output file>.bdhist (see BetaDecayHistDump)");
+    
+    fHistoEnableCmd = new G4UIcmdWithABool("/betadecay/histo/enable", this);
+    fHistoEnableCmd->SetGuidance("Fill and save the spectra (default true).");
+    fHistoEnableCmd->SetParameterName("enable", true);
+    fHistoEnableCmd->SetDefaultValue(true);
+    fHistoEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fHistoBinsCmd = new G4UIcmdWithAnInteger("/betadecay/histo/bins", this);
+    fHistoBinsCmd->SetGuidance("Bins of the energy spectra from the next run (default 500);");
+    fHistoBinsCmd->SetGuidance("the 2D spectra get a fifth of them per axis.");
+    fHistoBinsCmd->SetParameterName("bins", false);
+    fHistoBinsCmd->SetRange("bins>0");
+    fHistoBinsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fHistoEnergyCmd = new G4UIcmdWithADoubleAndUnit("/betadecay/histo/energyMax", this);
+    fHistoEnergyCmd->SetGuidance("Upper edge of the energy axes from the next run (default 5 MeV).");
+    fHistoEnergyCmd->SetParameterName("energy", false);
+    fHistoEnergyCmd->SetRange("energy>0");
+    fHistoEnergyCmd->SetUnitCategory("Energy");
+    fHistoEnergyCmd->SetDefaultUnit("MeV");
+    fHistoEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fCheckpointDirectory = new G4UIdirectory("/betadecay/checkpoint/");
+    fCheckpointDirectory->SetGuidance("Periodic checkpoints of long runs in <output file>.bdckpt,");
+    fCheckpointDirectory->SetGuidance("removed when the run completes");
+    
+    fCheckpointIntervalCmd = new G4UIcmdWithADouble("/betadecay/checkpoint/interval", this);
+    fCheckpointIntervalCmd->SetGuidance("Wall-clock seconds between checkpoints of the following runs;");
+    fCheckpointIntervalCmd->SetGuidance("0 (default) disables them. The run goes on while one is taken.");
+    fCheckpointIntervalCmd->SetParameterName("seconds", false);
+    fCheckpointIntervalCmd->SetRange("seconds>=0");
+    fCheckpointIntervalCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    
+    fResumeCmd = new G4UIcmdWithoutParameter("/betadecay/checkpoint/resume", this);
+    fResumeCmd->SetGuidance("Load the checkpoint of the current output file: the next run");
+    fResumeCmd->SetGuidance("completes the interrupted one, continuing its outputs. Run it");
+    fResumeCmd->SetGuidance("with the events left (printed) and the settings of that run;");
+    fResumeCmd->SetGuidance("events are identical to an uninterrupted run with");
+    fResumeCmd->SetGuidance("/betadecay/gun/reseedTransport true.");
+    fResumeCmd->AvailableForStates(G4State_Idle);
+}
+
+RunActionMessenger::~RunActionMessenger() {
+    delete fResumeCmd;
+    delete fCheckpointIntervalCmd;
+    delete fCheckpointDirectory;
+    delete fHistoEnergyCmd;
+    delete fHistoBinsCmd;
+    delete fHistoEnableCmd;
+    delete fHistoDirectory;
+    delete fProfileReportCmd;
+    delete fProfileEnableCmd;
+    delete fProfileDirectory;
+    delete fIntervalCmd;
+    delete fTelemetryDirectory;
+    delete fBuffersCmd;
+    delete fBufferSizeCmd;
+    delete fFileCmd;
+    delete fFormatCmd;
+    delete fDirectory;
+}
+
+void RunActionMessenger::SetNewValue(G4UIcommand* command, G4String newValue) {
+    if (command == fFormatCmd) {
+        fRunAction->SetOutputFormat(newValue == "binary" ? OutputFormat::BINARY
+                                                         : OutputFormat::TEXT);
+    } else if (command == fFileCmd) {
+        fRunAction->SetOutputFileName(newValue);
+    } else if (command == fBufferSizeCmd) {
+        fRunAction->SetBufferRecords(fBufferSizeCmd->GetNewIntValue(newValue));
+    } else if (command == fBuffersCmd) {
+        fRunAction->SetBuffersPerThread(fBuffersCmd->GetNewIntValue(newValue));
+    } else if (command == fIntervalCmd) {
+        fRunAction->SetTelemetryInterval(fIntervalCmd->GetNewDoubleValue(newValue));
+    } else if (command == fProfileEnableCmd) {
+        fRunAction->SetProfiling(fProfileEnableCmd->GetNewBoolValue(newValue));
+    } else if (command == fProfileReportCmd) {
+        fRunAction->ReportProfile(newValue);
+    } else if (command == fHistoEnableCmd) {
+        fRunAction->SetHistogramsEnabled(fHistoEnableCmd->GetNewBoolValue(newValue));
+    } else if (command == fHistoBinsCmd) {
+        fRunAction->SetHistogramBins(fHistoBinsCmd->GetNewIntValue(newValue));
+    } else if (command == fHistoEnergyCmd) {
+        fRunAction->SetHistogramEnergyMax(fHistoEnergyCmd->GetNewDoubleValue(newValue));
+    } else if (command == fCheckpointIntervalCmd) {
+        fRunAction->SetCheckpointInterval(fCheckpointIntervalCmd->GetNewDoubleValue(newValue));
+    } else if (command == fResumeCmd) {
+        fRunAction->Resume();
+    }
+}
+
+G4String RunActionMessenger::GetCurrentValue(G4UIcommand* command) {
+    if (command == fFormatCmd) {
+        return fRunAction->GetOutputFormat() == OutputFormat::BINARY ? "binary" : "text";
+    }
+    if (command == fFileCmd) {
+        return fRunAction->GetOutputFileName();
+    }
+    if (command == fBufferSizeCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetBufferRecords());
+    }
+    if (command == fBuffersCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetBuffersPerThread());
+    }
+    if (command == fIntervalCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetTelemetryInterval());
+    }
+    if (command == fProfileEnableCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetProfiling());
+    }
+    if (command == fHistoEnableCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetHistogramsEnabled());
+    }
+    if (command == fHistoBinsCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetHistogramBins());
+    }
+    if (command == fHistoEnergyCmd) {
+        return fHistoEnergyCmd->ConvertToString(fRunAction->GetHistogramEnergyMax(), "MeV");
+    }
+    if (command == fCheckpointIntervalCmd) {
+        return G4UIcommand::ConvertToString(fRunAction->GetCheckpointInterval());
+    }
+    return "";
+}
@@ -0,0 +1,92 @@
+// src/RunCheckpointing.cc
+#include "RunCheckpointing.hh"
+#include "Run.hh"
+#include "G4Run.hh"
+#include "G4Threading.hh"
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace {
+    // Set by the master between Start() and Stop(); workers attach to it in
+    // their BeginOfRunAction, which the kernel only calls after the master's
+    RunCheckpointing* gStarted = nullptr;
+    
+    G4int ThreadSlot() {
+        return std::max(0, G4Threading::G4GetThreadId());
+    }
+}
+
+RunCheckpointing::~RunCheckpointing() {
+    Stop();
+}
+
+std::unique_ptr<Checkpoint::State> RunCheckpointing::Load(const G4String& path, const G4String& eventFile) {
+    std::unique_ptr<Checkpoint::State> state;
+    try {
+        state.reset(new Checkpoint::State(Checkpoint::Read(path)));
+    } catch (const std::exception& e) {
+        G4cerr << "ERROR: " << e.what() << "; nothing to resume" << G4endl;
+        return nullptr;
+    }
+    if (!state->eventFile.empty() && state->eventFile != eventFile) {
+        G4cerr << "ERROR: " << path << " continues " << state->eventFile
+               << "; resume with the output format of that run" << G4endl;
+        return nullptr;
+    }
+    return state;
+}
+
+void RunCheckpointing::Start(const G4Run* run, const G4String& path, G4double interval,
+                             const Checkpoint::State* resume, const EventFile::AsyncEventWriter* writer,
+                             G4bool binaryEvents) {
+    // What earlier jobs finished, and the run as a whole
+    Checkpoint::State base;
+    if (resume) base = *resume;
+    base.runId = run->GetRunID();
+    base.events = static_cast<std::int64_t>(base.done.Count()) + run->GetNumberOfEventToBeProcessed();
+    base.eventFile = writer ? writer->GetPath() : std::string();
+    base.binaryEvents = binaryEvents;
+    
+    fCoordinator.Start(path, base, interval, writer);
+    gStarted = this;
+    G4cout << "  Checkpoints every " << interval << " s to " << path << G4endl;
+}
+
+G4bool RunCheckpointing::Stop() {
+    if (gStarted == this) gStarted = nullptr;
+    const G4bool checkpointed = fCoordinator.IsActive();
+    fCoordinator.Stop();
+    if (checkpointed && !fCoordinator.GetError().empty()) {
+        G4cerr << "WARNING: checkpoint failed: " << fCoordinator.GetError() << G4endl;
+    }
+    return checkpointed;
+}
+
+Checkpoint::Coordinator::Snapshot RunCheckpointing::GetSnapshot(const Run* run) {
+    Checkpoint::Coordinator::Snapshot snapshot;
+    snapshot.counters = run->GetCounters();
+    snapshot.histograms = run->GetHistograms();
+    snapshot.done = run->GetDone();
+    return snapshot;
+}
+
+void RunCheckpointing::Client::Begin(G4bool processesEvents) {
+    fCheckpointing = processesEvents && gStarted && gStarted->fCoordinator.IsActive() ? gStarted : nullptr;
+    if (!fCheckpointing) return;
+    fCheckpointing->fCoordinator.Register(ThreadSlot());
+    fRequest = fCheckpointing->fCoordinator.GetRequest();
+}
+
+void RunCheckpointing::Client::Answer(Run* run) {
+    fRequest = fCheckpointing->fCoordinator.GetRequest();
+    run->FlushWriter();
+    fCheckpointing->fCoordinator.Submit(ThreadSlot(), fRequest, GetSnapshot(run), false);
+}
+
+void RunCheckpointing::Client::End(Run* run) {
+    // This thread's totals stand for it in the checkpoints still to come
+    if (!fCheckpointing) return;
+    fCheckpointing->fCoordinator.Submit(ThreadSlot(), fRequest, GetSnapshot(run), true);
+    fCheckpointing = nullptr;
+}
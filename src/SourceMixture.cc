@@ -0,0 +1,129 @@
+// src/SourceMixture.cc
+#include "SourceMixture.hh"
+#include "BetaSpectrumTable.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+std::size_t SourceMixture::AddIsotope(const std::string& name, double halfLife,
+                                      double initialActivity) {
+    Isotope isotope;
+    isotope.name = name;
+    isotope.halfLife = halfLife;
+    isotope.initialActivity = initialActivity > 0.0 ? initialActivity : 0.0;
+    isotope.activity = isotope.initialActivity;
+    fIsotopes.push_back(isotope);
+    Update();
+    return fIsotopes.size() - 1;
+}
+
+void SourceMixture::AddFeeding(std::size_t parent, std::size_t daughter, double fraction) {
+    if (parent >= daughter || daughter >= fIsotopes.size()) {
+        throw std::invalid_argument("SourceMixture: a daughter must be added after its parent");
+    }
+    fFeedings.push_back(Feeding{parent, daughter, fraction});
+    try {
+        Update();
+    } catch (const std::invalid_argument&) {
+        fFeedings.pop_back();
+        Update();
+        throw;
+    }
+}
+
+void SourceMixture::AddBranch(std::size_t isotope, const Branch& branch) {
+    if (isotope >= fIsotopes.size()) {
+        throw std::invalid_argument("SourceMixture: branch of an unknown isotope");
+    }
+    fBranches.push_back(branch);
+    fBranches.back().isotope = isotope;
+    Update();
+}
+
+void SourceMixture::Clear() {
+    fIsotopes.clear();
+    fFeedings.clear();
+    fBranches.clear();
+    Update();
+}
+
+void SourceMixture::SetAge(double age) {
+    fAge = age > 0.0 ? age : 0.0;
+    Update();
+}
+
+std::size_t SourceMixture::FindIsotope(const std::string& name) const {
+    for (std::size_t i = 0; i < fIsotopes.size(); ++i) {
+        if (fIsotopes[i].name == name) return i;
+    }
+    return fIsotopes.size();
+}
+
+double SourceMixture::GetTotalActivity() const {
+    double total = 0.0;
+    for (const Isotope& isotope : fIsotopes) total += isotope.activity;
+    return total;
+}
+
+double SourceMixture::GetBranchProbability(std::size_t i) const {
+    double total = 0.0;
+    for (double weight : fWeight) total += weight;
+    return total > 0.0 ? fWeight[i]/total : 0.0;
+}
+
+double SourceMixture::DecayConstant(std::size_t isotope) const {
+    const double halfLife = fIsotopes[isotope].halfLife;
+    return halfLife > 0.0 && std::isfinite(halfLife) ? std::log(2.0)/halfLife : 0.0;
+}
+
+void SourceMixture::Update() {
+    // Bateman coefficients in activity, row i over the exponentials of the
+    // isotopes j <= i (parents always precede their daughters)
+    const std::size_t n = fIsotopes.size();
+    std::vector<double> lambda(n);
+    for (std::size_t i = 0; i < n; ++i) lambda[i] = DecayConstant(i);
+
+    std::vector<double> a(n*n, 0.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        double sum = 0.0;
+        for (std::size_t j = 0; j < i; ++j) {
+            double feed = 0.0;
+            for (const Feeding& feeding : fFeedings) {
+                if (feeding.daughter == i) feed += feeding.fraction*a[feeding.parent*n + j];
+            }
+            if (feed == 0.0 || lambda[i] == 0.0) continue;
+            if (std::abs(lambda[i] - lambda[j]) <= 1.0e-12*std::max(lambda[i], lambda[j])) {
+                throw std::invalid_argument("SourceMixture: equal half-lives in the chain of " +
+                                            fIsotopes[i].name);
+            }
+            a[i*n + j] = lambda[i]*feed/(lambda[i] - lambda[j]);
+            sum += a[i*n + j];
+        }
+        a[i*n + i] = fIsotopes[i].initialActivity - sum;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        double activity = 0.0;
+        for (std::size_t j = 0; j <= i; ++j) {
+            if (a[i*n + j] != 0.0) activity += a[i*n + j]*std::exp(-lambda[j]*fAge);
+        }
+        fIsotopes[i].activity = activity > 0.0 ? activity : 0.0;
+    }
+
+    // Branch weights; all equal if the source has no activity
+    fWeight.resize(fBranches.size());
+    double total = 0.0;
+    for (std::size_t b = 0; b < fBranches.size(); ++b) {
+        fWeight[b] = fIsotopes[fBranches[b].isotope].activity*fBranches[b].ratio;
+        total += fWeight[b];
+    }
+    std::vector<double> weights = fWeight;
+    if (!(total > 0.0)) weights.assign(weights.size(), 1.0);
+    if (weights.empty()) {
+        fProbability.clear();
+        fAlias.clear();
+        return;
+    }
+    BetaSpectrumTable::BuildAliasTable(weights, fProbability, fAlias);
+}
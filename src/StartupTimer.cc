@@ -0,0 +1,52 @@
+// src/StartupTimer.cc
+#include "StartupTimer.hh"
+
+#include <iomanip>
+#include <sstream>
+
+StartupTimer::Clock::time_point StartupTimer::fStart = StartupTimer::Clock::now();
+std::vector<std::pair<std::string, double> > StartupTimer::fSteps;
+StartupTimer::Clock::time_point StartupTimer::fLastMark = StartupTimer::fStart;
+std::atomic<std::int64_t> StartupTimer::fFirstEventNs(-1);
+
+void StartupTimer::Start() {
+    fStart = fLastMark = Clock::now();
+    fSteps.clear();
+    fFirstEventNs.store(-1);
+}
+
+void StartupTimer::Mark(const std::string& step) {
+    const Clock::time_point now = Clock::now();
+    fSteps.emplace_back(step, Seconds(fLastMark, now));
+    fLastMark = now;
+}
+
+void StartupTimer::RecordFirstEvent() {
+    const std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - fStart).count();
+    std::int64_t none = -1;
+    fFirstEventNs.compare_exchange_strong(none, ns);
+}
+
+double StartupTimer::GetTimeToFirstEvent() {
+    const std::int64_t ns = fFirstEventNs.load();
+    return ns < 0 ? -1.0 : ns*1e-9;
+}
+
+void StartupTimer::Report(std::ostream& out) {
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3) << "Startup:";
+    for (const auto& step : fSteps) report << " " << step.first << " " << step.second << " s,";
+
+    const double firstEvent = GetTimeToFirstEvent();
+    if (firstEvent < 0.0) {
+        report << " no event processed\n";
+    } else {
+        const double sinceMark = firstEvent - Seconds(fStart, fLastMark);
+        if (!fSteps.empty() && sinceMark >= 0.0) {
+            report << " first event " << sinceMark << " s later,";
+        }
+        report << " time to first event " << firstEvent << " s\n";
+    }
+    out << report.str();
+}
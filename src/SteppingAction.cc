@@ -0,0 +1,44 @@
+// src/SteppingAction.cc
+#include "SteppingAction.hh"
+#include "EventAction.hh"
+#include "DetectorConstruction.hh"
+#include "PhaseProfile.hh"
+#include "G4Step.hh"
+#include "G4LogicalVolume.hh"
+#include "G4RunManager.hh"
+
+SteppingAction::SteppingAction(EventAction* eventAction)
+    : G4UserSteppingAction(), fEventAction(eventAction),
+      fDetector(nullptr), fGeometryVersion(-1),
+      fSourceVolume(nullptr), fDetectorVolume(nullptr) {}
+
+SteppingAction::~SteppingAction() {}
+
+void SteppingAction::UserSteppingAction(const G4Step* step) {
+    PhaseProfile::Scope timer(PhaseProfile::STEPPING);
+    
+    const G4double edep = step->GetTotalEnergyDeposit();
+    if (edep <= 0.) return;
+    
+    // The geometry is built after the user actions and rebuilt when the
+    // array changes, so look it up on first use and after every rebuild
+    if (!fDetector) {
+        fDetector = static_cast<const DetectorConstruction*>(
+            G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    }
+    if (fGeometryVersion != fDetector->GetGeometryVersion()) {
+        fGeometryVersion = fDetector->GetGeometryVersion();
+        fSourceVolume = fDetector->GetSourceVolume();
+        fDetectorVolume = fDetector->GetDetectorVolume();
+    }
+    
+    const G4VTouchable* touchable = step->GetPreStepPoint()->GetTouchable();
+    const G4LogicalVolume* volume = touchable->GetVolume()->GetLogicalVolume();
+    
+    if (volume == fDetectorVolume) {
+        fEventAction->AddDeposit(EnergyDeposit::DETECTOR, step->GetTrack()->GetDefinition(), edep);
+        fEventAction->AddCrystalDeposit(fDetector->GetCrystalIndex(touchable), edep);
+    } else if (volume == fSourceVolume) {
+        fEventAction->AddDeposit(EnergyDeposit::SOURCE, step->GetTrack()->GetDefinition(), edep);
+    }
+}
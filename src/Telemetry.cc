@@ -0,0 +1,90 @@
+// src/Telemetry.cc
+#include "Telemetry.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+Telemetry::Telemetry()
+    : fCounters(new Counter[1]), fNThreads(1), fExpectedEvents(0),
+      fStart(std::chrono::steady_clock::now()), fInterval(0.0), fOut(nullptr),
+      fStopping(false) {}
+
+Telemetry::~Telemetry() {
+    Stop();
+}
+
+void Telemetry::Start(std::uint64_t expectedEvents, int nThreads, double interval,
+                      std::ostream& out) {
+    Stop();
+
+    fNThreads = std::max(1, nThreads);
+    fCounters.reset(new Counter[fNThreads]);
+    fExpectedEvents = expectedEvents;
+    fStart = std::chrono::steady_clock::now();
+    fInterval = interval;
+    fOut = &out;
+    fStopping = false;
+
+    if (interval > 0.0) fReporter = std::thread(&Telemetry::Report, this);
+}
+
+void Telemetry::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fWake.notify_all();
+    if (fReporter.joinable()) fReporter.join();
+}
+
+Telemetry::Snapshot Telemetry::GetSnapshot() const {
+    Snapshot snapshot;
+    snapshot.expectedEvents = fExpectedEvents;
+    snapshot.threads = fNThreads;
+    snapshot.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - fStart).count();
+    snapshot.minThreadEvents = UINT64_MAX;
+    for (int i = 0; i < fNThreads; ++i) {
+        const std::uint64_t events = fCounters[i].events.load(std::memory_order_relaxed);
+        snapshot.events += events;
+        snapshot.minThreadEvents = std::min(snapshot.minThreadEvents, events);
+        snapshot.maxThreadEvents = std::max(snapshot.maxThreadEvents, events);
+    }
+    return snapshot;
+}
+
+void Telemetry::Report() {
+    const std::chrono::duration<double> interval(fInterval);
+    std::uint64_t lastEvents = 0;
+    double lastSeconds = 0.0;
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    while (!fWake.wait_for(lock, interval, [this] { return fStopping; })) {
+        const Snapshot snapshot = GetSnapshot();
+        const double dt = snapshot.seconds - lastSeconds;
+        const double rate = dt > 0.0 ? (snapshot.events - lastEvents)/dt : 0.0;
+        lastEvents = snapshot.events;
+        lastSeconds = snapshot.seconds;
+
+        // One write per line, so lines from other threads do not interleave
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "Progress: " << snapshot.events;
+        if (snapshot.expectedEvents > 0) {
+            line << "/" << snapshot.expectedEvents << " events ("
+                 << 100.0*snapshot.events/snapshot.expectedEvents << "%)";
+        } else {
+            line << " events";
+        }
+        line << ", " << std::setprecision(0) << rate << " events/s";
+        if (snapshot.expectedEvents > snapshot.events && snapshot.events > 0) {
+            line << ", ETA " << (snapshot.expectedEvents - snapshot.events)/snapshot.GetRate() << " s";
+        }
+        if (snapshot.threads > 1) {
+            line << ", per thread " << snapshot.minThreadEvents << "-" << snapshot.maxThreadEvents
+                 << " events (balance " << std::setprecision(2) << snapshot.GetBalance() << ")";
+        }
+        line << "\n";
+        *fOut << line.str() << std::flush;
+    }
+}
@@ -1,4 +1,39 @@
-// src/main.cpp (UPDATED VERSION)
+// src/main.cc
+//
+//   BetaDecaySimulation                      interactive session with visualization
+//   BetaDecaySimulation [options] [macro]    headless batch job
+//   BetaDecaySimulation --shards K -n N ...  N events split over K processes
+//   BetaDecaySimulation --sweep FILE ...     the configurations of a table
+//
+// A headless job never constructs the UI session or the visualization
+// manager, and never stores trajectories. The options are applied as UI
+// commands before the macro; --events runs /run/beamOn after it.
+//
+// With --shards the process forks K headless jobs before any Geant4 object
+// exists. Shard i runs the event ids [N*i/K, N*(i+1)/K) of the workload
+// (/betadecay/gun/firstEvent) with the common seed and the transport
+// reseeded from each event's stream. It writes <output>.shard<i>.* and logs
+// to <output>.shard<i>.log; the parent then merges the shard outputs into
+// <output>.* (OutputMerge) and removes them, so the result does not depend
+// on K.
+//
+// --checkpoint S saves the run every S seconds to <output>.bdckpt (see
+// Checkpoint.hh). After an interruption, the same command line with
+// --resume completes the run from there, continuing its outputs; a sharded
+// job resumes every shard. Both reseed the transport from each event's
+// stream, so the completed outputs hold the same events as an
+// uninterrupted job.
+//
+// --sweep FILE runs the configurations of a table (see ParameterSweep.hh)
+// one after the other on the initialized kernel, each to
+// <output>.<name>.*. --physics-cache DIR keeps the physics tables of a
+// headless job in DIR/<profile>-<cuts key> (PhysicsList::CutsKey), keyed
+// by the cuts in force after the macro: the first job stores them after
+// its runs and later jobs of the same Geant4 version and cuts retrieve
+// them instead of building them during their first run. A job stores into
+// a directory of its own and renames it into place, so concurrent jobs
+// (shards) never expose a partial store. The double beta spectrum tables
+// go to DIR/spectra (/betadecay/gun/tableCache).
 #include "G4RunManagerFactory.hh"
 #include "G4UImanager.hh"
 #include "G4VisExecutive.hh"
@@ -9,51 +44,424 @@
 #include "PhysicsList.hh"
 #include "ActionInitialization.hh"
 #include "BetaDecay.hh"
+#include "RunAction.hh"
+#include "StartupTimer.hh"
+#include "OutputMerge.hh"
+#include "Checkpoint.hh"
+#include "ParameterSweep.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    struct Options {
+        G4bool interactive = false;
+        G4bool help = false;
+        G4int threads = 0;            // 0: run manager default
+        G4long events = -1;           // -1: only what the macro runs
+        G4int shards = 0;             // 0: this process runs the events
+        G4int shard = -1;             // Index of this shard, -1 in an unsharded job
+        G4long firstEvent = 0;        // Global id of the shard's first event
+        G4double checkpoint = 0.;     // Seconds between checkpoints, 0: none
+        G4bool resume = false;
+        std::string sweep;            // Table of configurations to run
+        std::string physicsCache;     // Directory of stored physics tables
+        std::string seed;
+        std::string isotope;
+        std::string output;
+        std::string format;
+        std::string physics = "standard";
+        std::string macro;
+    };
+
+    void PrintUsage(const char* program) {
+        std::cerr
+            << "Usage: " << program << " [options] [macro]\n"
+            << "Without arguments an interactive session with visualization is started;\n"
+            << "otherwise the job runs headless (no UI session, no visualization).\n"
+            << "  -t, --threads N     worker threads\n"
+            << "  -n, --events N      events to run after the macro (/run/beamOn N)\n"
+            << "      --shards K      split the --events over K processes (threads per shard)\n"
+            << "      --checkpoint S  save a checkpoint every S seconds (/betadecay/checkpoint/)\n"
+            << "      --resume        complete the interrupted job of the same command line\n"
+            << "      --sweep FILE    run the configurations of a table, each to <output>.<name>\n"
+            << "      --physics-cache DIR  store the physics tables in DIR, or reuse them\n"
+            << "  -s, --seed S        primary generator seed (/betadecay/gun/seed)\n"
+            << "  -i, --isotope NAME  decay source, one of: " << BetaDecayUtils::IsotopeNames() << "\n"
+            << "  -o, --output PATH   output file without extension (/betadecay/output/file)\n"
+            << "  -f, --format FMT    output format, text or binary (/betadecay/output/format)\n"
+            << "  -p, --physics NAME  physics profile, one of: " << PhysicsList::ProfileNames() << "\n"
+            << "  -m, --macro FILE    macro to execute (also the first plain argument)\n"
+            << "      --interactive   apply the options, then start the interactive session\n"
+            << "  -h, --help          this text" << std::endl;
+    }
+
+    // False on a malformed command line
+    G4bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const G4bool hasValue = i + 1 < argc;
+            if (arg == "-h" || arg == "--help") options.help = true;
+            else if (arg == "--interactive") options.interactive = true;
+            else if ((arg == "-t" || arg == "--threads") && hasValue) options.threads = std::atoi(argv[++i]);
+            else if ((arg == "-n" || arg == "--events") && hasValue) options.events = std::atol(argv[++i]);
+            else if (arg == "--shards" && hasValue) options.shards = std::atoi(argv[++i]);
+            else if (arg == "--checkpoint" && hasValue) options.checkpoint = std::atof(argv[++i]);
+            else if (arg == "--resume") options.resume = true;
+            else if (arg == "--sweep" && hasValue) options.sweep = argv[++i];
+            else if (arg == "--physics-cache" && hasValue) options.physicsCache = argv[++i];
+            else if ((arg == "-s" || arg == "--seed") && hasValue) options.seed = argv[++i];
+            else if ((arg == "-i" || arg == "--isotope") && hasValue) options.isotope = argv[++i];
+            else if ((arg == "-o" || arg == "--output") && hasValue) options.output = argv[++i];
+            else if ((arg == "-f" || arg == "--format") && hasValue) options.format = argv[++i];
+            else if ((arg == "-p" || arg == "--physics") && hasValue) options.physics = argv[++i];
+            else if ((arg == "-m" || arg == "--macro") && hasValue) options.macro = argv[++i];
+            else if (!arg.empty() && arg[0] != '-' && options.macro.empty()) options.macro = arg;
+            else return false;
+        }
+
+        if (options.help) return true;
+        if (options.threads < 0 || options.events < -1 || options.shards < 0 || options.checkpoint < 0.) {
+            return false;
+        }
+        if (options.shards > 0 && (options.interactive || options.events < 0)) {
+            std::cerr << "--shards needs --events and a headless job" << std::endl;
+            return false;
+        }
+        if (options.resume && (options.interactive || options.events < 0)) {
+            std::cerr << "--resume needs --events and a headless job" << std::endl;
+            return false;
+        }
+        if (!options.sweep.empty() && (options.interactive || options.shards > 0 || options.resume)) {
+            std::cerr << "--sweep needs a headless job without --shards or --resume" << std::endl;
+            return false;
+        }
+        if (!options.format.empty() && options.format != "text" && options.format != "binary") {
+            return false;
+        }
+        if (!PhysicsList::IsProfile(options.physics)) {
+            std::cerr << "Unknown physics profile " << options.physics << std::endl;
+            return false;
+        }
+        Nucleus parent;
+        BetaDecayType type;
+        G4double qValue;
+        if (!options.isotope.empty() &&
+            !BetaDecayUtils::FindIsotope(options.isotope, parent, type, qValue)) {
+            std::cerr << "Unknown isotope " << options.isotope << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Stops at the first command that fails, like a macro
+    G4bool Apply(G4UImanager* uiManager, const std::vector<G4String>& commands) {
+        for (const G4String& command : commands) {
+            if (uiManager->ApplyCommand(command) != 0) {
+                G4cerr << "ERROR: command failed: " << command << G4endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Output name of the job; RunAction's default unless given
+    std::string OutputName(const Options& options) {
+        return options.output.empty() ? "beta_decay_output" : options.output;
+    }
+
+    // Completes the interrupted run of this job from its checkpoint, with
+    // the events it has left in place of --events
+    G4bool Resume(G4UImanager* uiManager, const G4RunManager* runManager) {
+        const RunAction* runAction = static_cast<const RunAction*>(runManager->GetUserRunAction());
+        if (!Checkpoint::Exists(runAction->GetCheckpointFileName())) {
+            if (runAction->IsComplete()) {
+                G4cout << "Nothing to resume: the run of " << runAction->GetOutputFileName()
+                       << " completed" << G4endl;
+                return true;
+            }
+            G4cerr << "ERROR: no checkpoint " << runAction->GetCheckpointFileName() << " to resume" << G4endl;
+            return false;
+        }
+        if (!Apply(uiManager, {"/betadecay/checkpoint/resume"}) || runAction->GetResumeEvents() < 0) {
+            return false;
+        }
+        const G4long events = runAction->GetResumeEvents();
+        return events == 0 || Apply(uiManager, {"/run/beamOn " + std::to_string(events)});
+    }
+
+    // Runs every configuration of the sweep table; stops at the first that
+    // fails
+    G4bool RunSweep(G4UImanager* uiManager, const Options& options) {
+        std::vector<ParameterSweep::Configuration> configurations;
+        try {
+            configurations = ParameterSweep::ReadTable(options.sweep, options.events);
+        } catch (const std::exception& e) {
+            G4cerr << "ERROR: " << e.what() << G4endl;
+            return false;
+        }
+
+        std::vector<G4double> seconds;
+        for (const ParameterSweep::Configuration& configuration : configurations) {
+            G4cout << "Sweep: configuration " << configuration.name << " (" << seconds.size() + 1 << " of "
+                   << configurations.size() << ")" << G4endl;
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<G4String> commands = configuration.commands;
+            commands.push_back("/betadecay/output/file " + OutputName(options) + "." + configuration.name);
+            commands.push_back("/run/beamOn " + std::to_string(configuration.events));
+            if (!Apply(uiManager, commands)) return false;
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        G4cout << "Sweep of " << configurations.size() << " configurations:" << G4endl;
+        for (std::size_t i = 0; i < configurations.size(); ++i) {
+            G4cout << "  " << OutputName(options) << "." << configurations[i].name << "  "
+                   << configurations[i].events << " events  " << seconds[i] << " s" << G4endl;
+        }
+        return true;
+    }
+
+    // Physics tables of the job's profile and current cuts, empty without
+    // --physics-cache
+    std::string PhysicsCacheDirectory(const Options& options) {
+        if (options.physicsCache.empty()) return "";
+        return options.physicsCache + "/" + options.physics + "-" + PhysicsList::CutsKey();
+    }
+
+    // Tables stored by another Geant4 version are not reused
+    G4bool HasPhysicsCache(const std::string& directory, const G4String& version) {
+        std::ifstream marker(directory + "/geant4.version");
+        std::string stored;
+        return marker && std::getline(marker, stored) && stored == version;
+    }
+
+    // A directory of files, as storePhysicsTable writes it
+    void RemoveDirectory(const std::string& directory) {
+        if (DIR* entries = ::opendir(directory.c_str())) {
+            while (const dirent* entry = ::readdir(entries)) {
+                if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+                std::remove((directory + "/" + entry->d_name).c_str());
+            }
+            ::closedir(entries);
+        }
+        ::rmdir(directory.c_str());
+    }
+
+    // Stores the tables built by the job's runs. They and the version
+    // marker go to a directory of this process, which then takes the name
+    // of the cache in one step; if another job got there first, its tables
+    // are kept and these are dropped.
+    void StorePhysicsCache(G4UImanager* uiManager, const std::string& directory, const G4String& version) {
+        const std::string temporary = directory + ".tmp" + std::to_string(::getpid());
+        ::mkdir(directory.substr(0, directory.rfind('/')).c_str(), 0755);
+        RemoveDirectory(temporary);
+        G4bool stored = ::mkdir(temporary.c_str(), 0755) == 0 &&
+                        Apply(uiManager, {"/run/particle/storePhysicsTable " + temporary});
+        if (stored) {
+            std::ofstream marker(temporary + "/geant4.version");
+            marker << version << "\n";
+            stored = static_cast<bool>(marker.flush());
+        }
+        if (stored && std::rename(temporary.c_str(), directory.c_str()) == 0) {
+            G4cout << "Physics tables stored in " << directory << G4endl;
+            return;
+        }
+        RemoveDirectory(temporary);
+        if (!stored) G4cerr << "WARNING: cannot store the physics tables in " << directory << G4endl;
+    }
+
+    std::string ShardName(const Options& options, G4int shard) {
+        return OutputName(options) + ".shard" + std::to_string(shard);
+    }
+
+    // Forks the shard processes. Returns -1 in a shard, with options set up
+    // for its event range; in the launcher waits for the shards, merges
+    // their outputs and returns the exit status of the job.
+    int LaunchShards(Options& options) {
+        const G4long total = options.events;
+        std::vector<pid_t> children;
+        std::cout.flush();
+        std::fflush(nullptr);
+        for (G4int i = 0; i < options.shards; ++i) {
+            const G4long first = total*i/options.shards;
+            const G4long last = total*(i + 1)/options.shards;
+            const pid_t pid = ::fork();
+            if (pid == 0) {
+                const std::string log = ShardName(options, i) + ".log";
+                if (!std::freopen(log.c_str(), "w", stdout) || !std::freopen(log.c_str(), "a", stderr)) {
+                    std::_Exit(1);
+                }
+                options.shard = i;
+                options.firstEvent = first;
+                options.events = last - first;
+                return -1;
+            }
+            if (pid < 0) {
+                std::cerr << "Cannot start shard " << i << std::endl;
+                break;
+            }
+            std::cout << "Shard " << i << ": events " << first << " to " << last - 1 << ", log "
+                      << ShardName(options, i) << ".log" << std::endl;
+            children.push_back(pid);
+        }
+
+        G4bool ok = static_cast<G4int>(children.size()) == options.shards;
+        for (G4int i = 0; i < static_cast<G4int>(children.size()); ++i) {
+            int status = 0;
+            const G4bool exited = ::waitpid(children[i], &status, 0) == children[i] && WIFEXITED(status);
+            if (!exited || WEXITSTATUS(status) != 0) {
+                std::cerr << "Shard " << i << " failed, see " << ShardName(options, i) << ".log" << std::endl;
+                ok = false;
+            }
+        }
+        if (!ok) return 1;
+
+        std::vector<std::string> names;
+        for (G4int i = 0; i < options.shards; ++i) names.push_back(ShardName(options, i));
+        try {
+            const OutputMerge::Result result =
+                OutputMerge::Merge(names, OutputName(options), options.format != "binary");
+            std::cout << "Merged " << result.inputs << " shards into " << OutputName(options) << ": "
+                      << result.rows << " event records, "
+                      << result.mergedCounters.Get("events") << " events" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "; the shard outputs are kept" << std::endl;
+            return 1;
+        }
+        for (const std::string& name : names) OutputMerge::Remove(name);
+        return 0;
+    }
+}
 
 int main(int argc, char** argv) {
-    // Detect interactive mode (if no arguments) and define UI session
+    StartupTimer::Start();
+
+    Options options;
+    options.interactive = (argc == 1);
+    if (!ParseOptions(argc, argv, options) || options.help) {
+        PrintUsage(argv[0]);
+        return options.help ? 0 : 1;
+    }
+    if (!options.interactive && options.macro.empty() && options.events < 0 && options.sweep.empty()) {
+        std::cerr << "Nothing to run: give a macro or --events" << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (options.shards > 0) {
+        const int status = LaunchShards(options);
+        if (status >= 0) return status;
+    }
+
+    // The interactive session must exist before the run manager so that
+    // G4cout goes to it from the start
     G4UIExecutive* ui = nullptr;
-    if (argc == 1) {
+    if (options.interactive) {
         ui = new G4UIExecutive(argc, argv);
     }
-    
+
     // Construct the run manager
     auto* runManager = G4RunManagerFactory::CreateRunManager();
-    
+    if (options.threads > 0) runManager->SetNumberOfThreads(options.threads);
+
     // Enable scoring manager (optional, for advanced scoring)
     G4ScoringManager::GetScoringManager();
-    
+
     // Set mandatory initialization classes
     runManager->SetUserInitialization(new DetectorConstruction());
-    runManager->SetUserInitialization(new PhysicsList());
+    runManager->SetUserInitialization(new PhysicsList(options.physics));
     runManager->SetUserInitialization(new ActionInitialization());
-    
-    // Initialize G4 kernel
-    runManager->Initialize();
-    
-    // Initialize visualization
-    G4VisManager* visManager = new G4VisExecutive();
-    visManager->Initialize();
-    
+    StartupTimer::Mark("run manager");
+
     // Get the pointer to the UI manager
     G4UImanager* UImanager = G4UImanager::GetUIpointer();
-    
-    // Process macro or start UI session
-    if (!ui) {
-        // batch mode: execute macro file
-        G4String command = "/control/execute ";
-        G4String fileName = argv[1];
-        UImanager->ApplyCommand(command + fileName);
-    } else {
-        // interactive mode
-        UImanager->ApplyCommand("/control/execute init_vis.mac");
-        ui->SessionStart();
-        delete ui;
-    }
-    
+
+    // Initialize G4 kernel
+    runManager->Initialize();
+    StartupTimer::Mark("initialization");
+
+    // Command-line settings, before the macro so that it can override them
+    std::vector<G4String> settings;
+    if (!options.interactive) settings.push_back("/tracking/storeTrajectory 0");
+    if (options.shard >= 0 || options.checkpoint > 0. || options.resume) {
+        settings.push_back("/betadecay/gun/reseedTransport true");
+    }
+    if (options.checkpoint > 0.) {
+        settings.push_back("/betadecay/checkpoint/interval " + std::to_string(options.checkpoint));
+    }
+    if (!options.seed.empty()) settings.push_back("/betadecay/gun/seed " + options.seed);
+    if (!options.isotope.empty()) settings.push_back("/betadecay/gun/isotope " + options.isotope);
+    if (!options.format.empty()) settings.push_back("/betadecay/output/format " + options.format);
+    if (!options.output.empty()) settings.push_back("/betadecay/output/file " + options.output);
+    if (!options.physicsCache.empty()) {
+        // Spectrum tables do not depend on the physics; shared by all profiles
+        const std::string spectra = options.physicsCache + "/spectra";
+        ::mkdir(options.physicsCache.c_str(), 0755);
+        ::mkdir(spectra.c_str(), 0755);
+        settings.push_back("/betadecay/gun/tableCache " + spectra);
+    }
+    G4bool ok = Apply(UImanager, settings);
+
+    G4VisManager* visManager = nullptr;
+    if (ok && options.interactive) {
+        // Initialize visualization
+        visManager = new G4VisExecutive();
+        visManager->Initialize();
+
+        if (!options.macro.empty()) ok = Apply(UImanager, {"/control/execute " + options.macro});
+        if (ok && options.events >= 0) {
+            ok = Apply(UImanager, {"/run/beamOn " + std::to_string(options.events)});
+        }
+        if (ok) {
+            UImanager->ApplyCommand("/control/execute init_vis.mac");
+            ui->SessionStart();
+        }
+    } else if (ok) {
+        // Headless batch job
+        if (!options.macro.empty()) ok = Apply(UImanager, {"/control/execute " + options.macro});
+        if (ok && options.shard >= 0) {
+            // After the macro: the launcher decides the range and the files
+            ok = Apply(UImanager, {"/betadecay/gun/firstEvent " + std::to_string(options.firstEvent),
+                                   "/betadecay/output/format binary",
+                                   "/betadecay/output/file " + ShardName(options, options.shard)});
+        }
+
+        // Stored physics tables for the cuts the macro left are read when
+        // the next run builds the tables
+        if (ok && !options.physicsCache.empty() &&
+            HasPhysicsCache(PhysicsCacheDirectory(options), runManager->GetVersionString())) {
+            ok = Apply(UImanager, {"/run/particle/retrievePhysicsTable " + PhysicsCacheDirectory(options)});
+        }
+        if (ok && options.resume) {
+            ok = Resume(UImanager, runManager);
+        } else if (ok && !options.sweep.empty()) {
+            ok = RunSweep(UImanager, options);
+        } else if (ok && options.events >= 0) {
+            ok = Apply(UImanager, {"/run/beamOn " + std::to_string(options.events)});
+        }
+        StartupTimer::Report(G4cout);
+        // Tables for the cuts of the last run (a sweep may change them)
+        const std::string physicsCache = PhysicsCacheDirectory(options);
+        if (!physicsCache.empty() && runManager->GetCurrentRun() &&
+            !HasPhysicsCache(physicsCache, runManager->GetVersionString())) {
+            StorePhysicsCache(UImanager, physicsCache, runManager->GetVersionString());
+        }
+    }
+
     // Job termination
+    delete ui;
     delete visManager;
     delete runManager;
-    
-    return 0;
-}
\ No newline at end of file
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+//==============================================================================
+// tests/CheckpointTest.cc - Checkpoint ranges, files and event file resume
+//
+//   CheckpointTest
+//
+// Run by ctest in the build directory, where it leaves no files. Exits
+// with 1 and prints the failed checks if any.
+#include "AsyncEventWriter.hh"
+#include "Checkpoint.hh"
+#include "EventFileReader.hh"
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    int gFailures = 0;
+    
+    void Check(bool condition, const char* what, int line) {
+        if (condition) return;
+        std::cerr << "CheckpointTest.cc:" << line << ": " << what << " failed" << std::endl;
+        ++gFailures;
+    }
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+    typedef Checkpoint::EventRanges::Range Range;
+    
+    EventFile::EventRecord Record(std::int64_t id) {
+        EventFile::EventRecord record = {};
+        record.eventId = id;
+        record.particle = 11;
+        record.decayType = 1;
+        record.energy = 0.001*id;
+        record.weight = 1.0;
+        return record;
+    }
+    
+    void TestEventRanges() {
+        Checkpoint::EventRanges ranges;
+        for (std::int64_t id : {5, 3, 4, 10}) ranges.Add(id);
+        CHECK(ranges.GetRanges().size() == 2);
+        CHECK(ranges.GetRanges()[0] == Range(3, 6));
+    
+        // [6, 9) touches [3, 6); 9 then joins both sides
+        ranges.Add(Range(6, 9));
+        CHECK(ranges.GetRanges().size() == 2);
+        ranges.Add(9);
+        CHECK(ranges.GetRanges().size() == 1);
+        CHECK(ranges.GetRanges()[0] == Range(3, 11));
+        ranges.Add(Range(7, 7));
+        CHECK(ranges.Count() == 8);
+        CHECK(!ranges.Contains(2) && ranges.Contains(3) && ranges.Contains(10) && !ranges.Contains(11));
+    
+        Checkpoint::EventRanges other;
+        other.Add(Range(20, 25));
+        other.Add(Range(0, 2));
+        ranges.Merge(other);
+        CHECK(ranges.GetRanges().size() == 3);
+        CHECK(ranges.GetRanges()[0] == Range(0, 2));
+        CHECK(ranges.Count() == 15);
+    
+        const Checkpoint::EventRanges missing = ranges.Complement(0, 30);
+        CHECK(missing.GetRanges().size() == 3);
+        CHECK(missing.GetRanges()[0] == Range(2, 3));
+        CHECK(missing.GetRanges()[2] == Range(25, 30));
+        CHECK(missing.Count() == 15);
+    
+        // Past Count() the ids continue after the last range
+        CHECK(missing.Select(0) == 2);
+        CHECK(missing.Select(1) == 11);
+        CHECK(missing.Select(14) == 29);
+        CHECK(missing.Select(15) == 30);
+        CHECK(missing.Select(20) == 35);
+        CHECK(Checkpoint::EventRanges().Select(4) == 4);
+    }
+    
+    void TestWriteRead() {
+        const std::string path = "CheckpointTest.roundtrip.bdckpt";
+        Checkpoint::State state;
+        state.runId = 3;
+        state.events = 1000;
+        state.done.Add(Range(0, 120));
+        state.done.Add(Range(500, 620));
+        state.eventFile = "events with spaces.bdevt";
+        state.binaryEvents = true;
+        state.eventPosition.offset = 4096;
+        EventFile::IndexEntry chunk = {};
+        chunk.offset = 64;
+        chunk.nRows = 240;
+        chunk.firstEventId = 0;
+        chunk.lastEventId = 619;
+        state.eventPosition.chunks.push_back(chunk);
+        state.counters.Set("events", 240);
+        state.counters.Set("energy", {1.5, 2.5});
+        state.histograms.Book("energy", "Energy", Histogram::Axis(10, 0.0, 1.0));
+        state.histograms[0].Fill(0.25, 2.0);
+        state.slot = 1;
+        state.resumes = 2;
+    
+        Checkpoint::Write(path, state);
+        CHECK(Checkpoint::Exists(path));
+        const Checkpoint::State read = Checkpoint::Read(path);
+        CHECK(read.runId == 3 && read.events == 1000);
+        CHECK(read.done.GetRanges() == state.done.GetRanges());
+        CHECK(read.eventFile == state.eventFile && read.binaryEvents);
+        CHECK(read.eventPosition.offset == 4096);
+        CHECK(read.eventPosition.chunks.size() == 1 && read.eventPosition.chunks[0].nRows == 240 &&
+              read.eventPosition.chunks[0].lastEventId == 619);
+        CHECK(read.counters.Get("events") == 240 && read.counters.Get("energy", 1) == 2.5);
+        CHECK(read.histograms.Size() == 1 && read.histograms[0].GetIntegral() == 2.0);
+        CHECK(read.slot == 1 && read.resumes == 2);
+    
+        Checkpoint::Remove(path);
+        CHECK(!Checkpoint::Exists(path));
+    }
+    
+    // A job killed in the middle of a chunk after its last checkpoint: the
+    // resume keeps the finished events before the checkpoint offset only
+    void TestResumeTruncatedBinary() {
+        const std::string path = "CheckpointTest.resume.bdckpt";
+        const std::string eventFile = "CheckpointTest.resume.bdevt";
+        EventFile::AsyncEventWriter::Settings settings;
+        settings.bufferRecords = 100;
+    
+        Checkpoint::State state;
+        state.events = 500;
+        state.eventFile = eventFile;
+        state.binaryEvents = true;
+        std::uint64_t killedAt = 0;
+        {
+            EventFile::AsyncEventWriter writer(eventFile, EventFile::AsyncEventWriter::Format::Binary, settings);
+            std::unique_ptr<EventFile::AsyncEventWriter::Producer> producer = writer.CreateProducer();
+            for (std::int64_t id = 0; id < 300; ++id) producer->Append(Record(id));
+            producer->Flush();
+            // Events 250-299 finished after the thread's snapshot
+            state.done.Add(Range(0, 250));
+            state.eventPosition = writer.GetPosition();
+            Checkpoint::Write(path, state);
+    
+            for (std::int64_t id = 300; id < 450; ++id) producer->Append(Record(id));
+            producer->Flush();
+            killedAt = writer.GetPosition().chunks[3].offset + 100;
+            producer.reset();
+            writer.Close();
+        }
+        CHECK(::truncate(eventFile.c_str(), static_cast<off_t>(killedAt)) == 0);
+    
+        Checkpoint::State resumed = Checkpoint::Read(path);
+        CHECK(resumed.eventPosition.chunks.size() == 3);
+        CHECK(Checkpoint::PrepareEventFile(path, resumed) == 250);
+        CHECK(resumed.resumes == 1);
+        const Checkpoint::State reread = Checkpoint::Read(path);
+        CHECK(reread.resumes == 1 && reread.eventPosition.offset == resumed.eventPosition.offset);
+        struct stat info;
+        CHECK(::stat((eventFile + ".resume0").c_str(), &info) != 0);
+    
+        // Run the missing events and continue the file
+        const Checkpoint::EventRanges missing = resumed.done.Complement(0, resumed.events);
+        {
+            EventFile::AsyncEventWriter writer(eventFile, EventFile::AsyncEventWriter::Format::Binary, settings,
+                                               true);
+            std::unique_ptr<EventFile::AsyncEventWriter::Producer> producer = writer.CreateProducer();
+            for (std::uint64_t n = 0; n < missing.Count(); ++n) producer->Append(Record(missing.Select(n)));
+            producer->Flush();
+            producer.reset();
+            writer.Close();
+        }
+        const EventFile::EventFileReader reader(eventFile);
+        CHECK(reader.GetNumberOfRows() == 500);
+        // Every event once, in id order
+        std::int64_t expected = 0;
+        bool ordered = true;
+        for (std::uint64_t c = 0; c < reader.GetNumberOfChunks(); ++c) {
+            const EventFile::ChunkView view = reader.GetChunk(c);
+            for (std::uint32_t row = 0; row < view.nRows; ++row) {
+                ordered = ordered && view.GetRecord(row).eventId == expected;
+                ++expected;
+            }
+        }
+        CHECK(ordered);
+        CHECK(expected == 500);
+    
+        Checkpoint::Remove(path);
+        std::remove(eventFile.c_str());
+    }
+}
+
+int main() {
+    try {
+        TestEventRanges();
+        TestWriteRead();
+        TestResumeTruncatedBinary();
+    } catch (const std::exception& e) {
+        std::cerr << "CheckpointTest: " << e.what() << std::endl;
+        return 1;
+    }
+    if (gFailures > 0) {
+        std::cerr << "CheckpointTest: " << gFailures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "CheckpointTest: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,79 @@
+// tools/BetaDecayEventDump.cc - Inspect or convert binary event files
+//
+//   BetaDecayEventDump <file.bdevt>                   summary and chunk index
+//   BetaDecayEventDump <file.bdevt> --text <out.txt>  convert to text output
+//   BetaDecayEventDump <file.bdevt> --text -          text to stdout
+#include "EventFileReader.hh"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program << " <file" << EventFile::EXTENSION
+                  << "> [--text <output.txt|->] [--chunks]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    
+    const char* input = argv[1];
+    const char* textOutput = nullptr;
+    bool listChunks = false;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--text") == 0 && i + 1 < argc) {
+            textOutput = argv[++i];
+        } else if (std::strcmp(argv[i], "--chunks") == 0) {
+            listChunks = true;
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    try {
+        EventFile::EventFileReader reader(input);
+        
+        if (textOutput) {
+            if (std::strcmp(textOutput, "-") == 0) {
+                reader.WriteText(std::cout);
+            } else {
+                std::ofstream out(textOutput, std::ios::binary);
+                if (!out) throw std::runtime_error(std::string("cannot create ") + textOutput);
+                reader.WriteText(out);
+            }
+            return 0;
+        }
+        
+        const EventFile::TextSummary summary = reader.Summarize();
+        std::cout << input << ": format version " << reader.GetVersion() << ", "
+                  << reader.GetFileSize() << " bytes\n"
+                  << "  Chunks: " << reader.GetNumberOfChunks() << "\n"
+                  << "  Rows: " << reader.GetNumberOfRows() << "\n"
+                  << "  Events: " << summary.totalEvents << "\n"
+                  << "  Single beta decays: " << summary.singleBetaCount << "\n"
+                  << "  Double beta decays: " << summary.doubleBetaCount << "\n";
+        if (summary.totalEvents > 0) {
+            std::cout << "  Average energy: " << summary.totalEnergy/summary.totalEvents << " MeV\n";
+        }
+        
+        if (listChunks) {
+            for (std::uint64_t c = 0; c < reader.GetNumberOfChunks(); ++c) {
+                const EventFile::IndexEntry& entry = reader.GetIndexEntry(c);
+                std::cout << "  chunk " << c << ": offset " << entry.offset
+                          << ", rows " << entry.nRows
+                          << ", events " << entry.firstEventId << ".." << entry.lastEventId << "\n";
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "BetaDecayEventDump: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+// tools/BetaDecayGenerator.cc - Transport-free decay generation on all cores
+//
+//   BetaDecayGenerator [--type beta-|beta+|EC|2nu2beta-|2nu2beta+|0nu2beta-]
+//                      [--Z z] [--A a] [--Q q] [--events n] [--threads n]
+//                      [--seed s] [--bins n] [--show n]
+//                      [--primaries file.bdprim] [--source x y z]
+//
+// Defaults to C-14 beta- decay. Prints the throughput, the energy balance
+// and the histogram of the summed electron/positron kinetic energy. Output
+// for a given seed does not depend on --threads; --show n prints the first
+// n events of the run.
+//
+// --primaries also writes the events as a primary file for
+// /betadecay/gun/replay: the electrons, positrons and photons of each
+// decay (neutrinos and the recoil leave no signal) in one vertex at
+// --source (mm, default the origin), weight 1.
+#include "BetaDecayConsole.h"
+#include "PrimaryFile.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program
+                  << " [--type beta-|beta+|EC|2nu2beta-|2nu2beta+|0nu2beta-]"
+                  << " [--Z z] [--A a] [--Q MeV] [--events n] [--threads n]"
+                  << " [--seed s] [--bins n] [--show n]"
+                  << " [--primaries file" << PrimaryFile::EXTENSION << "] [--source x y z]" << std::endl;
+    }
+
+    bool ParseType(const std::string& name, BetaDecayType& type) {
+        if (name == "beta-") type = BetaDecayType::BETA_MINUS;
+        else if (name == "beta+") type = BetaDecayType::BETA_PLUS;
+        else if (name == "EC") type = BetaDecayType::ELECTRON_CAPTURE;
+        else if (name == "2nu2beta-") type = BetaDecayType::DOUBLE_BETA_MINUS;
+        else if (name == "2nu2beta+") type = BetaDecayType::DOUBLE_BETA_PLUS;
+        else if (name == "0nu2beta-") type = BetaDecayType::DOUBLE_BETA_MINUS_0NU;
+        else return false;
+        return true;
+    }
+
+    // Per-worker accumulators, padded so workers do not share cache lines
+    struct alignas(64) Tally {
+        std::vector<unsigned long long> histogram;
+        unsigned long long events = 0;
+        double maxImbalance = 0.0;      // |sum T - Q| in MeV
+        double maxMomentum = 0.0;       // |sum p| in MeV/c
+
+        // Primary file records of the current batch
+        std::vector<PrimaryFile::EventEntry> primaryEvents;
+        std::vector<PrimaryFile::ParticleEntry> primaryParticles;
+    };
+
+    bool IsDoubleBeta(BetaDecayType type) {
+        return type == BetaDecayType::DOUBLE_BETA_MINUS || type == BetaDecayType::DOUBLE_BETA_PLUS ||
+               type == BetaDecayType::DOUBLE_BETA_MINUS_0NU;
+    }
+
+    // Appends the batch's events to the tally's primary records
+    void AddPrimaries(const DecayEventBatch& batch, std::uint8_t decayType, const double source[3],
+                      Tally& tally) {
+        for (const DecayEventBatch::EventView event : batch) {
+            PrimaryFile::EventEntry entry = {};
+            entry.eventId = event.GetEventId();
+            entry.firstParticle = tally.primaryParticles.size();
+            entry.decayType = decayType;
+            entry.x = source[0];
+            entry.y = source[1];
+            entry.z = source[2];
+            entry.weight = 1.0;
+            for (std::size_t i = 0; i < event.GetNumberOfParticles(); ++i) {
+                const DecayEventBatch::ParticleView particle = event.GetParticle(i);
+                const DecayEventBatch::ParticleType type = particle.GetType();
+                if (type != DecayEventBatch::ParticleType::Electron &&
+                    type != DecayEventBatch::ParticleType::Positron &&
+                    type != DecayEventBatch::ParticleType::Gamma) {
+                    continue;
+                }
+                PrimaryFile::ParticleEntry record = {};
+                record.pdgCode = DecayEventBatch::GetPDGCode(type);
+                record.px = particle.GetPx();
+                record.py = particle.GetPy();
+                record.pz = particle.GetPz();
+                tally.primaryParticles.push_back(record);
+                entry.nParticles++;
+            }
+            tally.primaryEvents.push_back(entry);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    BetaDecayType type = BetaDecayType::BETA_MINUS;
+    int Z = 6, A = 14;
+    double qValue = 0.156476;
+    long long numEvents = 1000000;
+    int numThreads = 0;
+    unsigned long long seed = 12345;
+    int nBins = 50;
+    int show = 0;
+    std::string primaryPath;
+    double source[3] = {0.0, 0.0, 0.0};
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--type" && hasValue) {
+            if (!ParseType(argv[++i], type)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--Z" && hasValue) Z = std::atoi(argv[++i]);
+        else if (arg == "--A" && hasValue) A = std::atoi(argv[++i]);
+        else if (arg == "--Q" && hasValue) qValue = std::atof(argv[++i]);
+        else if (arg == "--events" && hasValue) numEvents = std::atoll(argv[++i]);
+        else if (arg == "--threads" && hasValue) numThreads = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--bins" && hasValue) nBins = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--show" && hasValue) show = std::atoi(argv[++i]);
+        else if (arg == "--primaries" && hasValue) primaryPath = argv[++i];
+        else if (arg == "--source" && i + 3 < argc) {
+            for (double& coordinate : source) coordinate = std::atof(argv[++i]);
+        }
+        else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const Nucleus parent(Z, A);
+    BetaDecaySimulator simulator;
+    simulator.setSeed(seed);
+    simulator.setNumberOfThreads(numThreads);
+
+    std::cout << "Parent: ";
+    parent.display();
+    std::cout << "Q = " << qValue << " MeV, " << numEvents << " events on "
+              << simulator.getNumberOfThreads() << " threads" << std::endl;
+
+    // Events are keyed by id, so the first events of the run can be shown
+    // by regenerating them on their own
+    DecayEventBatch shown;
+    for (int i = 0; i < show; ++i) {
+        shown.Clear();
+        if (simulator.generate(parent, type, qValue, i, shown)) {
+            simulator.toDecayEvent(shown[0], parent).display();
+        }
+    }
+
+    std::vector<Tally> tallies(simulator.getNumberOfThreads());
+    for (Tally& tally : tallies) tally.histogram.assign(nBins, 0);
+
+    std::unique_ptr<PrimaryFile::PrimaryFileWriter> primaries;
+    if (!primaryPath.empty()) {
+        try {
+            primaries.reset(new PrimaryFile::PrimaryFileWriter(primaryPath));
+        } catch (const std::runtime_error& e) {
+            std::cerr << "BetaDecayGenerator: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    const std::uint8_t decayType = IsDoubleBeta(type) ? 2 : 1;
+
+    const auto start = std::chrono::steady_clock::now();
+    simulator.runDecays(parent, type, qValue, numEvents,
+        [&](int worker, const DecayEventBatch& batch) {
+            Tally& tally = tallies[worker];
+            const double* px = batch.GetPx();
+            const double* py = batch.GetPy();
+            const double* pz = batch.GetPz();
+            for (const DecayEventBatch::EventView event : batch) {
+                tally.events++;
+                double p[3] = {0.0, 0.0, 0.0};
+                for (std::size_t i = event.GetFirstParticle(); i < event.GetLastParticle(); ++i) {
+                    p[0] += px[i];
+                    p[1] += py[i];
+                    p[2] += pz[i];
+                }
+                const double visible = event.GetVisibleEnergy();
+                const int bin = std::min(static_cast<int>(visible/qValue*nBins), nBins - 1);
+                tally.histogram[bin]++;
+                tally.maxImbalance = std::max(tally.maxImbalance,
+                                              std::abs(event.GetTotalEnergy() - event.GetQValue()));
+                tally.maxMomentum = std::max(tally.maxMomentum,
+                                             std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]));
+            }
+            if (primaries) {
+                tally.primaryEvents.clear();
+                tally.primaryParticles.clear();
+                AddPrimaries(batch, decayType, source, tally);
+                primaries->AddEvents(tally.primaryEvents.data(), tally.primaryEvents.size(),
+                                     tally.primaryParticles.data(), tally.primaryParticles.size());
+            }
+        });
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Tally total;
+    total.histogram.assign(nBins, 0);
+    for (const Tally& tally : tallies) {
+        total.events += tally.events;
+        total.maxImbalance = std::max(total.maxImbalance, tally.maxImbalance);
+        total.maxMomentum = std::max(total.maxMomentum, tally.maxMomentum);
+        for (int i = 0; i < nBins; ++i) total.histogram[i] += tally.histogram[i];
+    }
+
+    std::cout << total.events << " events in " << seconds << " s ("
+              << (seconds > 0.0 ? total.events/seconds : 0.0) << " events/s, "
+              << (seconds > 0.0 ? total.events/seconds*3600.0 : 0.0) << " events/hour)" << std::endl;
+    // Decays that are not allowed for this Q produce no events
+    const long long failed = numEvents - static_cast<long long>(total.events);
+    if (failed > 0) {
+        std::cout << failed << " events failed (decay not allowed for this Q)" << std::endl;
+    }
+    std::cout << "Max |sum T - Q| = " << total.maxImbalance << " MeV, max |sum p| = "
+              << total.maxMomentum << " MeV/c" << std::endl;
+
+    if (primaries) {
+        try {
+            primaries->Close();
+        } catch (const std::runtime_error& e) {
+            std::cerr << "BetaDecayGenerator: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << primaries->GetNumberOfEvents() << " primary events written to "
+                  << primaryPath << std::endl;
+    }
+
+    std::cout << "# T_visible (MeV)  count" << std::endl;
+    for (int i = 0; i < nBins; ++i) {
+        std::cout << std::setw(12) << (i + 0.5)*qValue/nBins << "  " << total.histogram[i] << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+// tools/BetaDecayHistDump.cc - Inspect histogram files
+//
+//   BetaDecayHistDump <file.bdhist>                  list the histograms
+//   BetaDecayHistDump <file.bdhist> --text <name>    bins of one histogram
+//   BetaDecayHistDump <file.bdhist> --text all       bins of all of them
+//
+// The text columns (bin centre(s), sum of weights, error) plot directly with
+// gnuplot; 2D histograms are written as blocks separated by blank lines.
+#include "Histogram.hh"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program << " <file" << HistogramFile::EXTENSION
+                  << "> [--text <name|all>]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 && !(argc == 4 && std::strcmp(argv[2], "--text") == 0)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    
+    try {
+        const HistogramSet histograms = HistogramFile::Read(argv[1]);
+    
+        if (argc == 4) {
+            const std::string name = argv[3];
+            bool found = false;
+            for (std::size_t i = 0; i < histograms.Size(); ++i) {
+                if (name != "all" && histograms[i].GetName() != name) continue;
+                if (found) std::cout << "\n\n";
+                histograms[i].WriteText(std::cout);
+                found = true;
+            }
+            if (!found) throw std::runtime_error("no histogram " + name + " in " + argv[1]);
+            return 0;
+        }
+    
+        std::cout << argv[1] << ": " << histograms.Size() << " histograms\n";
+        for (std::size_t i = 0; i < histograms.Size(); ++i) {
+            const Histogram& histogram = histograms[i];
+            const Histogram::Axis& x = histogram.GetXAxis();
+            std::cout << "  " << histogram.GetName() << " (" << histogram.GetTitle() << "): "
+                      << x.nBins << " bins [" << x.low << ", " << x.high << ")";
+            if (histogram.Is2D()) {
+                const Histogram::Axis& y = histogram.GetYAxis();
+                std::cout << " x " << y.nBins << " bins [" << y.low << ", " << y.high << ")";
+            }
+            std::cout << ", " << histogram.GetEntries() << " entries, integral "
+                      << histogram.GetIntegral() << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "BetaDecayHistDump: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
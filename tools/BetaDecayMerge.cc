@@ -0,0 +1,74 @@
+// tools/BetaDecayMerge.cc - Combine the output of separate jobs
+//
+//   BetaDecayMerge [--text] -o <output> <input> [<input> ...]
+//
+// Inputs and output are names without extension (/betadecay/output/file).
+// The binary event files (.bdevt), histogram files (.bdhist) and counter
+// files (.bdsum) that every input has are merged into <output>.*; --text
+// writes the merged events in the text format (<output>.txt). See
+// OutputMerge.hh.
+#include "OutputMerge.hh"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--text] -o <output> <input> [<input> ...]\n"
+                  << "Names are given without extension." << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string output;
+    bool text = false;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (std::strcmp(argv[i], "--text") == 0) {
+            text = true;
+        } else if (argv[i][0] != '-') {
+            inputs.push_back(argv[i]);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (output.empty() || inputs.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    
+    try {
+        const OutputMerge::Result result = OutputMerge::Merge(inputs, output, text);
+        if (!result.events && !result.histograms && !result.counters) {
+            throw std::runtime_error("the inputs have no output files in common");
+        }
+    
+        std::cout << "Merged " << result.inputs << " inputs into " << output << ":";
+        if (result.events) std::cout << " events (" << result.rows << " records)";
+        if (result.histograms) std::cout << " histograms";
+        if (result.counters) std::cout << " counters";
+        std::cout << "\n";
+    
+        if (result.counters) {
+            const CounterSet& counters = result.mergedCounters;
+            const double events = counters.Get("events");
+            std::cout << "  Total events: " << events << "\n"
+                      << "  Single beta decays: " << counters.Get("single_beta") << "\n"
+                      << "  Double beta decays: " << counters.Get("double_beta") << "\n";
+            if (events > 0) {
+                std::cout << "  Average energy per event: " << counters.Get("total_energy")/events
+                          << " MeV\n";
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "BetaDecayMerge: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}